@@ -1,27 +1,96 @@
 #pragma once
 
+#include "vreg_async.hpp"
 #include "vreg_base.hpp"
 #include "vreg_builder.hpp"
+#include "vreg_cache.hpp"
+#include "vreg_can.hpp"
+#include "vreg_dirty.hpp"
+#include "vreg_endpoint.hpp"
+#include "vreg_field.hpp"
+#include "vreg_flat.hpp"
 #include "vreg_impl.hpp"
+#include "vreg_monitor.hpp"
+#include "vreg_names.hpp"
+#include "vreg_queue.hpp"
+#include "vreg_scheduler.hpp"
+#include "vreg_shadow.hpp"
+#include "vreg_shard.hpp"
+#include "vreg_snapshot.hpp"
+#include "vreg_static.hpp"
+#include "vreg_stats.hpp"
+#include "vreg_table.hpp"
+#include "vreg_trace.hpp"
 namespace vreg {
 
 // shared
-using base::size_opt, base::addr_t;
-using base::VRegBase;
-using base::writer, base::reader;
+using base::size_opt, base::view_opt, base::addr_t;
+using base::VRegBase, base::VRegThunk;
+using base::VMountBase, base::VMountVisitor;
+using base::VBitmap, base::range_result;
+using base::writer, base::reader, base::async_writer, base::async_reader;
 
 // vreg
 using impl::VReg, impl::VRegWO, impl::VRegRO,impl::VRegReserved;
 using impl::VRegBinder;
 using impl::VRegConst;
+using impl::VField, impl::VFields, impl::VRegField;
 
 //
 
 // vrange
 using impl::VMap;
 using impl::VRange;
+using impl::VFlatMap;
+using impl::VTable;
+using impl::VNameIndex;
+
+// async
+using base::VTask;
+using impl::VExecutor, impl::VRegAsync, impl::VDelayMount;
+
+// cache
+using impl::VCacheMount, impl::VCachePolicy;
+
+// can
+using impl::VCanFrame, impl::VCanSignal, impl::VCanRoute, impl::VCanGateway, impl::VCanLoopback;
+#ifdef VREG_SOCKETCAN
+using impl::VCanSocket;
+#endif
+
+// dirty tracking
+using impl::VDirtyMount;
+
+// endpoint
+using impl::VEndpoint, impl::readAs, impl::writeAs;
+
+// monitor
+using impl::VMonitorProtocol, impl::VMonitorParser, impl::VMonitor;
+
+// scheduler
+using impl::VFrame, impl::VScheduler;
+
+// shadow
+using impl::VShadowBank, impl::VShadowMount, impl::VCommitReg;
+
+// snapshot
+using impl::VSnapshot;
+
+// stats
+using impl::VAccessStats, impl::VLatencyHistogram, impl::VStatsTable, impl::VStatsMount, impl::VStatsReg;
+using impl::withStats;
+
+// trace
+using impl::VTraceRecord, impl::VTraceFile, impl::VTraceMount, impl::VTraceReplay;
+
+// queue
+using impl::VOp, impl::VRequest, impl::VCompletion, impl::VRequestQueue;
+using impl::VShardServer;
 
 // builders
 using builder::VRangeBuilder, builder::VRegBuilder;
 
+// static
+using statics::StaticVMap, statics::StaticVRange, statics::mountAt;
+
 } // namespace vreg
\ No newline at end of file
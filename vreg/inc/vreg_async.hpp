@@ -0,0 +1,173 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <thread>
+
+namespace vreg::impl {
+using base::VMountBasePtr, base::awaitable_of;
+
+// NOTE: single threaded executor for VTask. many accesses to remote registers stay in flight at once,
+// each suspended on its own round trip, and the thread sleeps only when nothing is ready.
+// devices complete requests by post()ing the suspended handle (from this thread) or by sleep().
+class VExecutor {
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    struct Timer {
+        clock::time_point at;
+        uint64_t seq; // keeps timers of the same time in order
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer &other) const { return at != other.at ? at > other.at : seq > other.seq; }
+    };
+
+    std::deque<std::coroutine_handle<>> ready_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+    std::vector<VTask<>> tasks_; // spawned, owned until finished
+    uint64_t seq_ = 0;
+
+public:
+    class SleepAwaiter {
+        VExecutor &executor_;
+        clock::time_point at_;
+
+    public:
+        SleepAwaiter(VExecutor &executor, clock::time_point at) : executor_(executor), at_(at) {}
+        bool await_ready() const { return at_ <= clock::now(); }
+        void await_suspend(std::coroutine_handle<> handle) { executor_.timers_.push({at_, executor_.seq_++, handle}); }
+        void await_resume() const {}
+    };
+    class YieldAwaiter {
+        VExecutor &executor_;
+
+    public:
+        explicit YieldAwaiter(VExecutor &executor) : executor_(executor) {}
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor_.post(handle); }
+        void await_resume() const {}
+    };
+
+    VExecutor() = default;
+    VExecutor(const VExecutor &) = delete;
+
+    void spawn(VTask<> task) {
+        ready_.push_back(task.handle());
+        tasks_.push_back(std::move(task));
+    }
+    void post(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    SleepAwaiter sleepUntil(clock::time_point at) { return SleepAwaiter(*this, at); }
+    SleepAwaiter sleep(clock::duration duration) { return SleepAwaiter(*this, clock::now() + duration); }
+    YieldAwaiter yield() { return YieldAwaiter(*this); }
+
+    // spawned tasks not finished yet
+    size_t pending() const {
+        return std::ranges::count_if(tasks_, [](const VTask<> &task) { return !task.done(); });
+    }
+
+    // suspended in sleep(), e.g. requests in flight on a VDelayMount
+    size_t sleeping() const { return timers_.size(); }
+
+    // resumes everything ready, or waits for the earliest timer. false when there is nothing left to do.
+    bool step() {
+        if (ready_.empty()) {
+            if (timers_.empty())
+                return false;
+            std::this_thread::sleep_until(timers_.top().at);
+            const clock::time_point now = clock::now();
+            while (!timers_.empty() && timers_.top().at <= now) {
+                ready_.push_back(timers_.top().handle);
+                timers_.pop();
+            }
+        }
+        // handles posted while resuming wait for the next step
+        for (size_t n = ready_.size(); n > 0; n--) {
+            const std::coroutine_handle<> handle = ready_.front();
+            ready_.pop_front();
+            handle.resume();
+        }
+        return true;
+    }
+    // until all spawned tasks finished
+    void run() {
+        while (step()) {
+        }
+        std::erase_if(tasks_, [](const VTask<> &task) { return task.done(); });
+    }
+    // runs the executor until task finished, e.g. from synchronous code
+    template <class T> T block(VTask<T> task) {
+        ready_.push_back(task.handle());
+        while (!task.done() && step()) {
+        }
+        assert(task.done());
+        return task.result();
+    }
+};
+
+namespace detail {
+template <class A> VTask<size_opt> awaitSize(A awaitable) { co_return co_await std::move(awaitable); }
+template <class F, class... Args> VTask<size_opt> invokeAsync(F &f, Args... args) {
+    if constexpr (std::same_as<std::invoke_result_t<F &, Args...>, VTask<size_opt>>) {
+        return f(args...);
+    } else {
+        return awaitSize(f(args...));
+    }
+}
+} // namespace detail
+
+// NOTE: register whose accessors are coroutines (e.g. a request to a remote node).
+// synchronous read/write fail, it is accessed through readAtAsync/writeAtAsync on an executor.
+template <async_writer W, async_reader R> struct VRegAsync : public VRegBase {
+    W writer_;
+    R reader_;
+    VRegAsync(W &&writer, R &&reader, std::string_view name, std::string_view desc = "")
+        : VRegBase(name, desc), writer_(std::move(writer)), reader_(std::move(reader)) {}
+    virtual VTask<size_opt> writeAsync(std::span<const std::byte> bytes,
+                                       std::endian endian = std::endian::native) override {
+        return detail::invokeAsync(writer_, bytes, endian);
+    }
+    virtual VTask<size_opt> readAsync(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        return detail::invokeAsync(reader_, bytes, endian);
+    }
+};
+
+// NOTE: local stand-in for a remote device. every async access completes after latency on the executor,
+// synchronous accesses block the thread for the same time. use it to measure pipelining without hardware.
+class VDelayMount : public VMountBase {
+    VMountBasePtr target_;
+    VExecutor &executor_;
+    VExecutor::clock::duration latency_;
+
+public:
+    VDelayMount(VMountBasePtr target, VExecutor &executor, VExecutor::clock::duration latency)
+        : VMountBase(target->name_, target->desc_), target_(std::move(target)), executor_(executor),
+          latency_(latency) {}
+
+    VMountBase &target() const { return *target_; }
+    virtual size_t size() const override { return target_->size(); }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        std::this_thread::sleep_for(latency_);
+        return target_->writeAt(addr, bytes, endian);
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        std::this_thread::sleep_for(latency_);
+        return target_->readAt(addr, bytes, endian);
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        co_await executor_.sleep(latency_);
+        co_return target_->writeAt(addr, bytes, endian);
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        co_await executor_.sleep(latency_);
+        co_return target_->readAt(addr, bytes, endian);
+    }
+};
+
+}; // namespace vreg::impl
@@ -1,10 +1,14 @@
 #pragma once
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <endian.h>
+#include "vreg_task.hpp"
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <span>
 #include <string>
@@ -13,8 +17,16 @@
 namespace vreg::base {
 
 using size_opt = std::optional<size_t>;
+using view_opt = std::optional<std::span<const std::byte>>;
 using addr_t = uint32_t;
 
+#ifdef VREG_STATIC_NAMES
+// NOTE: names are not copied, they must outlive the mounts (string literals or vregex::intern_pool)
+using name_t = std::string_view;
+#else
+using name_t = std::string;
+#endif
+
 template <class W>
 concept writer_at = requires(W &writer, addr_t addr, std::span<const std::byte> bytes, std::endian endian) {
     { writer(addr, bytes, endian) } -> std::same_as<size_opt>;
@@ -35,9 +47,88 @@ concept reader = requires(R &reader, std::span<std::byte> bytes, std::endian end
     { reader(bytes, endian) } -> std::same_as<size_opt>;
 };
 
+// NOTE: an awaitable (VTask or a hand written awaiter) whose co_await yields T
+template <class A, class T>
+concept awaitable_of = requires(A awaitable) {
+    { awaitable.await_ready() } -> std::convertible_to<bool>;
+    { awaitable.await_resume() } -> std::convertible_to<T>;
+} || requires(A awaitable) {
+    { awaitable.operator co_await().await_resume() } -> std::convertible_to<T>;
+};
+
+template <class W>
+concept async_writer = requires(W &writer, std::span<const std::byte> bytes, std::endian endian) {
+    { writer(bytes, endian) } -> awaitable_of<size_opt>;
+};
+
+template <class R>
+concept async_reader = requires(R &reader, std::span<std::byte> bytes, std::endian endian) {
+    { reader(bytes, endian) } -> awaitable_of<size_opt>;
+};
+
+// NOTE: non-owning bit view for per-register results of bulk access (bit set = success).
+// an empty view discards the results.
+class VBitmap {
+    std::span<uint64_t> words_;
+    size_t offset_ = 0; // in bits
+
+public:
+    static constexpr size_t words(size_t bits) { return (bits + 63) / 64; }
+    constexpr VBitmap() = default;
+    constexpr VBitmap(std::span<uint64_t> words, size_t offset = 0) : words_(words), offset_(offset) {}
+
+    constexpr bool empty() const { return words_.empty(); }
+    constexpr size_t capacity() const { return words_.size() * 64 - offset_; }
+    constexpr VBitmap sub(size_t offset) const { return empty() ? VBitmap() : VBitmap(words_, offset_ + offset); }
+
+    constexpr void set(size_t index, bool value = true) {
+        if (empty())
+            return;
+        const size_t bit = offset_ + index;
+        assert(bit < words_.size() * 64);
+        const uint64_t mask = uint64_t(1) << (bit % 64);
+        words_[bit / 64] = value ? (words_[bit / 64] | mask) : (words_[bit / 64] & ~mask);
+    }
+    constexpr bool test(size_t index) const {
+        const size_t bit = offset_ + index;
+        return !empty() && (words_[bit / 64] >> (bit % 64) & 1);
+    }
+    constexpr void clear(size_t index, size_t count) {
+        for (size_t i = index; i < index + count; i++) {
+            set(i, false);
+        }
+    }
+    // set bits in [0, count)
+    constexpr size_t count(size_t count) const {
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            n += test(i);
+        }
+        return n;
+    }
+};
+
+// result of bulk access
+struct range_result {
+    size_t count; // visited registers (reads) or written registers before a failure (writes)
+    size_t bytes; // produced or consumed bytes
+};
+
+struct VMountBase;
+struct VRegBase;
+
+// NOTE: walks a mount tree. registers are leaves, mounts without known structure are opaque.
+struct VMountVisitor {
+    virtual ~VMountVisitor() = default;
+    virtual void enter(addr_t base, VMountBase &mount) { (void)base, (void)mount; }
+    virtual void leave(addr_t base, VMountBase &mount) { (void)base, (void)mount; }
+    virtual void reg(addr_t addr, VRegBase &reg) = 0;
+    virtual void mount(addr_t base, VMountBase &mount) = 0;
+};
+
 struct VMountBase {
-    const std::string name_; // for auto documentation
-    const std::string desc_; // for auto documentation
+    const name_t name_; // for auto documentation
+    const name_t desc_; // for auto documentation
     VMountBase(std::string_view name, std::string_view desc) : name_(name), desc_(desc) {}
     VMountBase(const VMountBase &) = default;
     virtual ~VMountBase() = default;
@@ -47,6 +138,63 @@ struct VMountBase {
     size_t mask() const { return std::bit_ceil(size()) - 1; }
     size_t maskWidth() const { return std::bit_width(size()); }
     bool has(size_t addr) const { return addr < size(); }
+    virtual void accept(addr_t base, VMountVisitor &visitor) { visitor.mount(base, *this); }
+
+    // NOTE: native endian bytes of the register at addr without copying, when it has backing storage.
+    // otherwise they are read into scratch (an empty scratch makes it view only).
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) {
+        const size_opt result = readAt(addr, scratch);
+        return result ? view_opt(scratch.first(*result)) : std::nullopt;
+    }
+
+    // NOTE: coroutine variants. the bytes must stay valid until the task finishes.
+    // by default they complete the synchronous access when awaited, mounts of remote registers override them.
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) {
+        co_return writeAt(addr, bytes, endian);
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) {
+        co_return readAt(addr, bytes, endian);
+    }
+
+    // NOTE: bulk access over [addr, addr + count), packed back to back in bytes.
+    // failed reads consume no bytes and continue, writes stop at the first failure.
+    virtual range_result readRange(addr_t addr, size_t count, std::span<std::byte> bytes, VBitmap status = {},
+                                   std::endian endian = std::endian::native) {
+        size_t used = 0;
+        for (size_t i = 0; i < count; i++) {
+            const size_opt result = readAt(addr + i, bytes.subspan(used), endian);
+            status.set(i, result.has_value());
+            used += result.value_or(0);
+        }
+        return {count, used};
+    }
+    virtual range_result writeRange(addr_t addr, size_t count, std::span<const std::byte> bytes, VBitmap status = {},
+                                    std::endian endian = std::endian::native) {
+        size_t used = 0;
+        for (size_t i = 0; i < count; i++) {
+            const size_opt result = writeAt(addr + i, bytes.subspan(used), endian);
+            status.set(i, result.has_value());
+            if (!result) {
+                status.clear(i + 1, count - i - 1);
+                return {i, used};
+            }
+            used += *result;
+        }
+        return {count, used};
+    }
+};
+
+// NOTE: a register reduced to plain function pointers, for tables that dispatch without the vtable.
+// registers backed by memory pass their storage as the context, others pass themselves.
+struct VRegThunk {
+    using read_fn = size_opt (*)(void *context, std::span<std::byte> bytes, std::endian endian);
+    using write_fn = size_opt (*)(void *context, std::span<const std::byte> bytes, std::endian endian);
+    read_fn read;
+    write_fn write; // nullptr when read only
+    void *context;
+    uint32_t size = 0; // bytes of the storage at context, 0 without storage
 };
 
 struct VRegBase : public VMountBase {
@@ -70,6 +218,39 @@ struct VRegBase : public VMountBase {
     virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes, std::endian endian = std::endian::native) {
         return (addr == 0) ? read(bytes, endian) : std::nullopt;
     };
+    virtual VTask<size_opt> writeAsync(std::span<const std::byte> bytes, std::endian endian = std::endian::native) {
+        co_return write(bytes, endian);
+    }
+    virtual VTask<size_opt> readAsync(std::span<std::byte> bytes, std::endian endian = std::endian::native) {
+        co_return read(bytes, endian);
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        return (addr == 0) ? writeAsync(bytes, endian) : readyTask(size_opt());
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        return (addr == 0) ? readAsync(bytes, endian) : readyTask(size_opt());
+    }
+    virtual view_opt view(std::span<std::byte> scratch = {}) {
+        const size_opt result = read(scratch);
+        return result ? view_opt(scratch.first(*result)) : std::nullopt;
+    }
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        return (addr == 0) ? view(scratch) : std::nullopt;
+    }
+    // NOTE: bytes of the value, known without reading the register. 0 when only a read tells (callbacks).
+    virtual size_t valueSize() { return thunk().size; }
+    virtual VRegThunk thunk() {
+        return {[](void *reg, std::span<std::byte> bytes, std::endian endian) {
+                    return static_cast<VRegBase *>(reg)->read(bytes, endian);
+                },
+                [](void *reg, std::span<const std::byte> bytes, std::endian endian) {
+                    return static_cast<VRegBase *>(reg)->write(bytes, endian);
+                },
+                this};
+    }
+    virtual void accept(addr_t base, VMountVisitor &visitor) override { visitor.reg(base, *this); }
 };
 
 using VRegBasePtr = std::shared_ptr<VRegBase>;
@@ -1,65 +1,87 @@
 #pragma once
+#include "vreg_field.hpp"
 #include "vreg_impl.hpp"
+#include "vreg_table.hpp"
 
 namespace vreg::builder {
 using base::VRegBase, base::VRegBasePtr;
 using base::writer, base::reader;
-using impl::VMap, impl::VRange;
+using impl::VMap, impl::VRange, impl::VTable;
 using impl::VReg, impl::VRegRO, impl::VRegWO, impl::VRegReserved;
 using impl::VRegBinder, impl::VRegBinderRO;
 using impl::VRegConst;
+using impl::VRegField;
 using std::move;
+// NOTE: registers are placed in the arena when one is set, otherwise on the heap.
+// the arena must outlive the registers.
 class VRegBuilder {
     std::string_view name_, desc_;
+    std::pmr::memory_resource *arena_ = nullptr;
+
+    template <class T, class... Args> VRegBasePtr make(Args &&...args) {
+        if (arena_)
+            return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(arena_), std::forward<Args>(args)...);
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
 
 public:
     VRegBuilder(std::string_view name, std::string_view desc = "") : name_(name), desc_(desc) {}
     VRegBuilder &setName(std::string_view name) { return name_ = name, *this; }
     VRegBuilder &setDesc(std::string_view desc) { return desc_ = desc, *this; }
+    VRegBuilder &setArena(std::pmr::memory_resource *arena) { return arena_ = arena, *this; }
 
     // VReg
     template <writer W, reader R> VRegBasePtr buildRW(W &&writer, R &&reader) {
-        return std::make_shared<VReg<W, R>>(std::move(writer), std::move(reader), name_, desc_);
+        return make<VReg<W, R>>(std::move(writer), std::move(reader), name_, desc_);
     }
     template <writer W> VRegBasePtr buildWO(W &&writer) {
         auto wo = VRegWO(move(writer), name_, desc_);
-        return std::make_shared<decltype(wo)>(move(wo));
+        return make<decltype(wo)>(move(wo));
     }
     template <reader R> VRegBasePtr buildRO(R &&reader) {
         auto ro = VRegRO(move(reader), name_, desc_);
-        return std::make_shared<decltype(ro)>(move(ro));
+        return make<decltype(ro)>(move(ro));
     }
     VRegBasePtr buildReserved() {
         auto reg = VRegReserved(name_, desc_);
-        return std::make_shared<decltype(reg)>(move(reg));
+        return make<decltype(reg)>(move(reg));
     }
 
     // VRegBinder
-    template <class T>VRegBasePtr buildBinder(T& binder){
-        return std::make_shared<VRegBinder<T>>(binder, name_, desc_);
-    }
-    template <class T>VRegBasePtr buildBinderRO(T& binder){
+    template <class T> VRegBasePtr buildBinder(T &binder) { return make<VRegBinder<T>>(binder, name_, desc_); }
+    template <class T> VRegBasePtr buildBinderRO(T &binder) {
         auto vreg = VRegBinderRO(binder, name_, desc_);
-        return std::make_shared<VRegBinder<T>>(move(vreg));
+        return make<decltype(vreg)>(move(vreg));
     }
     // VRegConst
-    template <class T>VRegBasePtr buildConst(const T&value){
-        return std::make_shared<VRegConst<T>>(value, name_, desc_);
+    template <class T> VRegBasePtr buildConst(const T &value) { return make<VRegConst<T>>(value, name_, desc_); }
+    // VRegField, e.g. buildField<VField<4, 3, true>>(status)
+    template <class F, std::integral I> VRegBasePtr buildField(I &binder) {
+        return make<VRegField<I, F>>(binder, name_, desc_);
+    }
+    template <class F, std::integral I> VRegBasePtr buildFieldRO(const I &binder) {
+        return make<VRegField<const I, F>>(binder, name_, desc_);
     }
 };
 
 class VRangeBuilder {
     std::string_view name_, desc_;
-    std::vector<std::shared_ptr<VRegBase>> range_;
+    std::pmr::vector<std::shared_ptr<VRegBase>> range_;
 
 public:
     VRangeBuilder(std::string_view name, std::string_view desc = "") : name_(name), desc_(desc) {}
+    // NOTE: places the register table of the range in the arena
+    VRangeBuilder(std::pmr::memory_resource *arena, std::string_view name, std::string_view desc = "")
+        : name_(name), desc_(desc), range_(arena) {}
     VRangeBuilder &setName(std::string_view name) { return name_ = name, *this; }
     VRangeBuilder &setDesc(std::string_view desc) { return desc_ = desc, *this; }
+    VRangeBuilder &reserve(size_t n) { return range_.reserve(n), *this; }
 
     // VRegBase(General)
-    VRangeBuilder &add(std::shared_ptr<VRegBase>&& vreg) { return range_.emplace_back(vreg), *this; }
+    VRangeBuilder &add(std::shared_ptr<VRegBase> &&vreg) { return range_.emplace_back(vreg), *this; }
     VRange build() { return VRange(std::move(range_), name_, desc_); }
+    // same registers as a structure of arrays
+    VTable buildTable() { return VTable(std::move(range_), name_, desc_); }
 };
 
 } // namespace vreg::builder
\ No newline at end of file
@@ -0,0 +1,240 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include <chrono>
+
+namespace vreg::impl {
+using base::VMountBasePtr;
+
+struct VCachePolicy {
+    enum class Write : uint8_t {
+        through, // forwarded at once, the cached value is dropped
+        back,    // kept in the cache until flush(), repeated writes coalesce
+    };
+    std::chrono::nanoseconds ttl{0}; // read cache lifetime, 0 reads through
+    Write write = Write::through;
+};
+
+// NOTE: caching decorator for mounts with slow registers (e.g. sensors behind I2C/SPI).
+// values live in one slab of SlotSize bytes per register, larger registers pass through.
+// only native endian accesses are cached, others flush the register and go through (they fail while it can not).
+// the read cache is only filled by reads, writes may not read back (write-only or write-1-to-clear registers).
+// write-back needs the register size, so the first write of a never read register goes through.
+// not thread safe, like the mounts it wraps.
+template <class Clock = std::chrono::steady_clock, size_t SlotSize = 8> class VCacheMount : public VMountBase {
+public:
+    using time_point = typename Clock::time_point;
+    using Policy = VCachePolicy;
+    static constexpr size_t slot_size = SlotSize;
+
+private:
+    struct Entry {
+        addr_t addr;
+        uint8_t size = 0; // known register size, 0 until read or written through
+        bool valid = false, dirty = false;
+        Policy policy;
+        time_point expires{};
+    };
+
+    VMountBasePtr target_;
+    std::vector<Entry> entries_; // sorted by address
+    VAddrIndex index_;
+    std::vector<std::byte> slab_;
+    size_t hits_ = 0, misses_ = 0;
+
+    Entry *locate(addr_t addr) {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos ? &entries_[index] : nullptr;
+    }
+    std::span<std::byte> slot(const Entry &entry) {
+        return std::span(slab_).subspan((&entry - entries_.data()) * SlotSize, entry.size);
+    }
+    void fill(Entry &entry, std::span<const std::byte> bytes, time_point now) {
+        entry.size = uint8_t(bytes.size());
+        entry.valid = true;
+        entry.expires = now + entry.policy.ttl;
+        std::ranges::copy(bytes, slot(entry).begin());
+    }
+    bool flush(Entry &entry) {
+        if (!entry.dirty)
+            return true;
+        entry.dirty = target_->writeAt(entry.addr, slot(entry)) != entry.size; // kept for a retry on failure
+        return !entry.dirty;
+    }
+    // the slot may be written again while the write-back is in flight, then it stays dirty
+    VTask<bool> flushAsync(Entry &entry) {
+        if (!entry.dirty)
+            co_return true;
+        std::array<std::byte, SlotSize> value;
+        const auto written = std::span(value).first(entry.size);
+        std::ranges::copy(slot(entry), written.begin());
+        const bool ok = co_await target_->writeAtAsync(entry.addr, written) == written.size();
+        if (ok && std::ranges::equal(slot(entry), written)) {
+            entry.dirty = false;
+        }
+        co_return ok;
+    }
+    bool hit(const Entry &entry, time_point now) const { return entry.valid && (entry.dirty || now < entry.expires); }
+    size_opt serve(const Entry &entry, std::span<std::byte> bytes) {
+        if (bytes.size() < entry.size)
+            return std::nullopt;
+        hits_++;
+        std::ranges::copy(slot(entry), bytes.begin());
+        return entry.size;
+    }
+    // after a read from the target, a write-back that landed meanwhile is kept
+    void learn(Entry &entry, std::span<const std::byte> bytes, time_point now) {
+        if (bytes.size() > SlotSize || entry.dirty)
+            return;
+        entry.size = uint8_t(bytes.size());
+        if (entry.policy.ttl.count() > 0) {
+            fill(entry, bytes, now);
+        }
+    }
+
+public:
+    explicit VCacheMount(VMountBasePtr target, Policy policy = {})
+        : VMountBase(target->name_, target->desc_), target_(std::move(target)) {
+        std::vector<VAddrIndex::Span> spans;
+        for (const addr_t addr : leafAddrs(*target_)) {
+            entries_.push_back({addr, 0, false, false, policy, {}});
+            spans.push_back({addr, addr_t(addr + 1)});
+        }
+        index_ = VAddrIndex(spans);
+        slab_.resize(entries_.size() * SlotSize);
+    }
+    VCacheMount(const VCacheMount &) = delete;
+    virtual ~VCacheMount() { flush(); }
+
+    VMountBase &target() const { return *target_; }
+    virtual size_t size() const override { return target_->size(); }
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+
+    // for [begin, end), registers whose write-back fails keep their pending value
+    void setPolicy(addr_t begin, addr_t end, Policy policy) {
+        for (auto &entry : entries_) {
+            if (begin <= entry.addr && entry.addr < end) {
+                entry.policy = policy;
+                entry.valid = !flush(entry);
+            }
+        }
+    }
+    void setPolicy(addr_t addr, Policy policy) { setPolicy(addr, addr + 1, policy); }
+
+    // writes back the dirty registers, returns the number of failed writes (they stay dirty)
+    size_t flush() {
+        size_t failed = 0;
+        for (auto &entry : entries_) {
+            failed += !flush(entry);
+        }
+        return failed;
+    }
+    bool flush(addr_t addr) {
+        Entry *entry = locate(addr);
+        return !entry || flush(*entry);
+    }
+    // drops cached reads, pending writes are kept
+    void invalidate() {
+        for (auto &entry : entries_) {
+            entry.valid = entry.dirty;
+        }
+    }
+    void invalidate(addr_t addr) {
+        if (Entry *entry = locate(addr)) {
+            entry->valid = entry->dirty;
+        }
+    }
+
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        Entry *entry = locate(addr);
+        if (!entry)
+            return target_->readAt(addr, bytes, endian);
+        if (endian != std::endian::native) {
+            if (!flush(*entry))
+                return std::nullopt;
+            entry->valid = false;
+            return target_->readAt(addr, bytes, endian);
+        }
+        const time_point now = Clock::now();
+        if (hit(*entry, now))
+            return serve(*entry, bytes);
+        misses_++;
+        const size_opt result = target_->readAt(addr, bytes, endian);
+        if (result) {
+            learn(*entry, bytes.first(*result), now);
+        }
+        return result;
+    }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        Entry *entry = locate(addr);
+        if (!entry)
+            return target_->writeAt(addr, bytes, endian);
+        if (endian != std::endian::native) {
+            if (!flush(*entry))
+                return std::nullopt; // the pending value would overwrite this write on the next flush
+            entry->valid = false;
+            return target_->writeAt(addr, bytes, endian);
+        }
+        if (entry->policy.write == Policy::Write::back && entry->size > 0 && bytes.size() >= entry->size) {
+            fill(*entry, bytes.first(entry->size), Clock::now());
+            entry->dirty = true;
+            return entry->size;
+        }
+        if (!flush(*entry))
+            return std::nullopt;
+        const size_opt result = target_->writeAt(addr, bytes, endian);
+        entry->valid = false; // refilled by the next read, the register may read back something else
+        if (result && *result <= SlotSize) {
+            entry->size = uint8_t(*result);
+        }
+        return result;
+    }
+
+    // NOTE: the same over the async accesses of the target, hits and write-backs complete at once
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        Entry *entry = locate(addr);
+        if (!entry)
+            co_return co_await target_->readAtAsync(addr, bytes, endian);
+        if (endian != std::endian::native) {
+            if (!co_await flushAsync(*entry))
+                co_return std::nullopt;
+            entry->valid = false;
+            co_return co_await target_->readAtAsync(addr, bytes, endian);
+        }
+        const time_point now = Clock::now();
+        if (hit(*entry, now))
+            co_return serve(*entry, bytes);
+        misses_++;
+        const size_opt result = co_await target_->readAtAsync(addr, bytes, endian);
+        if (result) {
+            learn(*entry, bytes.first(*result), now);
+        }
+        co_return result;
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        Entry *entry = locate(addr);
+        if (!entry)
+            co_return co_await target_->writeAtAsync(addr, bytes, endian);
+        if (endian == std::endian::native && entry->policy.write == Policy::Write::back && entry->size > 0 &&
+            bytes.size() >= entry->size) {
+            fill(*entry, bytes.first(entry->size), Clock::now());
+            entry->dirty = true;
+            co_return entry->size;
+        }
+        if (!co_await flushAsync(*entry))
+            co_return std::nullopt;
+        const size_opt result = co_await target_->writeAtAsync(addr, bytes, endian);
+        entry->valid = entry->dirty;
+        if (result && *result <= SlotSize && !entry->dirty) {
+            entry->size = uint8_t(*result);
+        }
+        co_return result;
+    }
+};
+
+}; // namespace vreg::impl
@@ -0,0 +1,299 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include "vreg_index.hpp"
+#include "vregex_ring.hpp"
+#ifdef VREG_SOCKETCAN
+#include <cerrno>
+#include <cstring>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace vreg::impl {
+
+// NOTE: a CAN or CAN FD frame, laid out as struct canfd_frame of SocketCAN
+struct VCanFrame {
+    static constexpr uint32_t extended = 0x80000000; // 29-bit id
+    static constexpr uint32_t remote = 0x40000000;
+    static constexpr uint32_t error = 0x20000000;
+    static constexpr uint8_t fd = 0x04; // in flags
+    static constexpr size_t max_length = 64;
+
+    uint32_t id; // with the flags above
+    uint8_t length;
+    uint8_t flags;
+    uint8_t reserved[2];
+    alignas(8) std::array<std::byte, max_length> data;
+
+    std::span<const std::byte> payload() const { return std::span(data).first(std::min<size_t>(length, max_length)); }
+    // smallest payload length a frame can carry, CAN FD goes up in steps above 8
+    static constexpr uint8_t fitLength(size_t n) {
+        constexpr uint8_t lengths[] = {8, 12, 16, 20, 24, 32, 48, 64};
+        if (n <= 8)
+            return uint8_t(n);
+        for (const uint8_t length : lengths) {
+            if (n <= length)
+                return length;
+        }
+        return 0;
+    }
+};
+static_assert(sizeof(VCanFrame) == 72);
+
+// bytes [offset, offset + size) of the payload are the register at addr
+struct VCanSignal {
+    addr_t addr;
+    uint16_t offset;
+    uint16_t size;
+};
+struct VCanRoute {
+    uint32_t id; // with VCanFrame::extended for 29-bit ids
+    std::vector<VCanSignal> signals;
+};
+
+// NOTE: maps CAN ids to registers, several per payload. received frames are decoded in batches to writeAt,
+// transmitted ones are packed by readAt. the routes are compiled once: signals of consecutive addresses that sit
+// back to back in the payload become one writeRange/readRange, ids are looked up by a VAddrIndex.
+// bit level signals are read by mapping the bytes holding them to an integer register and splitting it with
+// VField/VFields (or VRegField registers on the same integer).
+class VCanGateway {
+public:
+    struct Counters {
+        size_t frames = 0;    // fully applied
+        size_t unknown = 0;   // no route, remote and error frames
+        size_t truncated = 0; // payload shorter than the route
+        size_t failed = 0;    // some register refused the write
+        size_t rejected = 0;  // routes with a signal past the payload, dropped at construction
+    };
+
+private:
+    struct Op {
+        addr_t addr;
+        uint16_t offset, size;
+        uint32_t count; // registers
+    };
+    struct Route {
+        uint32_t first_op, ops;
+        uint8_t length; // payload bytes used
+    };
+
+    VMountBase &mount_;
+    std::endian endian_;
+    VAddrIndex index_; // id -> routes_
+    std::vector<uint32_t> ids_;
+    std::vector<Route> routes_;
+    std::vector<Op> ops_;
+    Counters counters_;
+
+    static constexpr uint32_t key_mask = VCanFrame::extended | 0x1fffffff;
+
+    const Route *find(uint32_t id) const {
+        if (id & (VCanFrame::remote | VCanFrame::error))
+            return nullptr;
+        const uint32_t index = index_.find(id & key_mask);
+        return index != VAddrIndex::npos ? &routes_[index] : nullptr;
+    }
+    std::span<const Op> opsOf(const Route &route) const { return std::span(ops_).subspan(route.first_op, route.ops); }
+
+public:
+    // NOTE: signals of registers with storage of the signal size merge into one bulk access, the sizes come
+    // from leafStorage so no register is read here. payloads are in the given byte order (little endian for
+    // Intel, big for Motorola layouts). the first valid route of an id is kept, routes with a signal beyond
+    // max_length bytes are dropped and counted as rejected.
+    VCanGateway(VMountBase &mount, std::span<const VCanRoute> routes, std::endian endian = std::endian::little)
+        : mount_(mount), endian_(endian) {
+        std::vector<const VCanRoute *> sorted;
+        for (const auto &route : routes) {
+            sorted.push_back(&route);
+        }
+        std::ranges::stable_sort(sorted, {}, [](const VCanRoute *r) { return r->id & key_mask; });
+        std::vector<VAddrIndex::Span> spans;
+        const std::vector<VLeafStorage> storage = leafStorage(mount_);
+        auto storageSize = [&](addr_t addr) -> size_t {
+            const auto it = std::ranges::lower_bound(storage, addr, {}, &VLeafStorage::addr);
+            return it != storage.end() && it->addr == addr ? it->size : 0;
+        };
+        for (const VCanRoute *route : sorted) {
+            const uint32_t id = route->id & key_mask;
+            if (!ids_.empty() && ids_.back() == id)
+                continue;
+            if (!std::ranges::all_of(route->signals, [](const VCanSignal &signal) {
+                    return size_t(signal.offset) + signal.size <= VCanFrame::max_length;
+                })) {
+                counters_.rejected++;
+                continue;
+            }
+            Route compiled{uint32_t(ops_.size()), 0, 0};
+            bool mergeable = false; // the last op ends with a register of the signal size
+            for (const auto &signal : route->signals) {
+                const bool exact = storageSize(signal.addr) == signal.size;
+                Op *last = compiled.ops > 0 ? &ops_.back() : nullptr;
+                if (last && mergeable && exact && last->addr + last->count == signal.addr &&
+                    last->offset + last->size == signal.offset) {
+                    last->count++, last->size += signal.size;
+                } else {
+                    ops_.push_back({signal.addr, signal.offset, signal.size, 1});
+                    compiled.ops++;
+                }
+                mergeable = exact;
+                compiled.length = std::max<uint8_t>(compiled.length, uint8_t(signal.offset + signal.size));
+            }
+            ids_.push_back(id);
+            routes_.push_back(compiled);
+            spans.push_back({id, id + 1});
+        }
+        index_ = VAddrIndex(spans);
+    }
+    VCanGateway(const VCanGateway &) = delete;
+
+    size_t routes() const { return routes_.size(); }
+    const Counters &counters() const { return counters_; }
+
+    // received frames to registers, returns the fully applied frames
+    size_t decode(std::span<const VCanFrame> frames) {
+        size_t applied = 0;
+        for (const auto &frame : frames) {
+            const Route *route = find(frame.id);
+            if (!route) {
+                counters_.unknown++;
+                continue;
+            }
+            if (frame.length < route->length) {
+                counters_.truncated++;
+                continue;
+            }
+            bool ok = true;
+            for (const auto &op : opsOf(*route)) {
+                const auto bytes = std::span(frame.data).subspan(op.offset, op.size);
+                if (op.count == 1) {
+                    ok &= mount_.writeAt(op.addr, bytes, endian_).has_value();
+                } else {
+                    ok &= mount_.writeRange(op.addr, op.count, bytes, {}, endian_).count == op.count;
+                }
+            }
+            applied += ok;
+            ok ? counters_.frames++ : counters_.failed++;
+        }
+        return applied;
+    }
+    bool decode(const VCanFrame &frame) { return decode(std::span(&frame, 1)) == 1; }
+
+    // registers of a route to a frame, unused payload bytes are zero. false for unknown ids and failed reads
+    bool encode(uint32_t id, VCanFrame &frame) {
+        const Route *route = find(id);
+        if (!route)
+            return false;
+        frame.id = id;
+        frame.length = VCanFrame::fitLength(route->length);
+        frame.flags = frame.length > 8 ? VCanFrame::fd : 0;
+        frame.reserved[0] = frame.reserved[1] = 0;
+        frame.data.fill(std::byte(0));
+        bool ok = true;
+        for (const auto &op : opsOf(*route)) {
+            const auto bytes = std::span(frame.data).subspan(op.offset, op.size);
+            if (op.count == 1) {
+                ok &= mount_.readAt(op.addr, bytes, endian_) == op.size;
+            } else {
+                ok &= mount_.readRange(op.addr, op.count, bytes, {}, endian_).bytes == op.size;
+            }
+        }
+        return ok;
+    }
+    // returns the frames packed, in order until the first failure
+    size_t encode(std::span<const uint32_t> ids, std::span<VCanFrame> frames) {
+        const size_t n = std::min(ids.size(), frames.size());
+        for (size_t i = 0; i < n; i++) {
+            if (!encode(ids[i], frames[i]))
+                return i;
+        }
+        return n;
+    }
+
+    // NOTE: decodes everything the transport has received, batch frames at a time. returns the received frames.
+    template <class Transport, size_t Batch = 32> size_t pump(Transport &transport) {
+        std::array<VCanFrame, Batch> frames;
+        size_t total = 0;
+        while (const size_t n = transport.receive(frames)) {
+            decode(std::span(frames).first(n));
+            total += n;
+        }
+        return total;
+    }
+};
+
+// NOTE: in-process stand-in for a bus, any thread sends and one thread receives. no allocation.
+template <size_t N = 1024> class VCanLoopback {
+    vregex::mpsc_ring<VCanFrame, N> ring_;
+
+public:
+    // returns the frames queued, the rest are dropped like on a full controller
+    size_t send(std::span<const VCanFrame> frames) {
+        size_t sent = 0;
+        while (sent < frames.size() && ring_.push(frames[sent])) {
+            sent++;
+        }
+        return sent;
+    }
+    bool send(const VCanFrame &frame) { return ring_.push(frame); }
+    size_t receive(std::span<VCanFrame> frames) { return ring_.pop(frames); }
+};
+
+#ifdef VREG_SOCKETCAN
+// NOTE: raw SocketCAN socket with CAN FD enabled, non blocking. a failed open leaves it closed (fd() < 0).
+class VCanSocket {
+    int fd_ = -1;
+
+public:
+    explicit VCanSocket(const char *interface) {
+        fd_ = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW);
+        if (fd_ < 0)
+            return;
+        const int enable = 1;
+        sockaddr_can addr{};
+        addr.can_family = AF_CAN;
+        addr.can_ifindex = int(if_nametoindex(interface));
+        if (addr.can_ifindex == 0 || setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) < 0 ||
+            bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            close(std::exchange(fd_, -1));
+        }
+    }
+    VCanSocket(const VCanSocket &) = delete;
+    ~VCanSocket() {
+        if (fd_ >= 0)
+            close(fd_);
+    }
+    int fd() const { return fd_; }
+
+    size_t send(std::span<const VCanFrame> frames) {
+        size_t sent = 0;
+        for (const auto &frame : frames) {
+            const size_t mtu = frame.length > 8 || (frame.flags & VCanFrame::fd) ? CANFD_MTU : CAN_MTU;
+            if (fd_ < 0 || write(fd_, &frame, mtu) != ssize_t(mtu))
+                break;
+            sent++;
+        }
+        return sent;
+    }
+    bool send(const VCanFrame &frame) { return send(std::span(&frame, 1)) == 1; }
+    // one recvmmsg for the whole batch, returns 0 when nothing is pending
+    size_t receive(std::span<VCanFrame> frames) {
+        constexpr size_t batch = 64;
+        std::array<mmsghdr, batch> messages{};
+        std::array<iovec, batch> vectors;
+        const size_t n = std::min(frames.size(), batch);
+        for (size_t i = 0; i < n; i++) {
+            vectors[i] = {&frames[i], sizeof(VCanFrame)};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int received = fd_ < 0 ? -1 : recvmmsg(fd_, messages.data(), unsigned(n), 0, nullptr);
+        return received > 0 ? size_t(received) : 0;
+    }
+};
+static_assert(sizeof(VCanFrame) == sizeof(canfd_frame));
+#endif
+
+}; // namespace vreg::impl
@@ -0,0 +1,243 @@
+#pragma once
+#include "vreg_impl.hpp"
+
+namespace vreg::impl {
+using base::VMountBasePtr;
+
+// NOTE: dirty tracking decorator for incremental sync.
+// a bit per register address is set on successful writeAt and by poll() when a bound value changed behind it.
+// collectDirty() packs only the changed registers, so sync cost follows the change rate instead of the map size.
+// addresses are enumerated through the visitor, sparse maps cost per register, not per address.
+// sizes come from leafSizes, nothing is read at construction. registers without a known size (callbacks, opaque
+// mounts) are read once into a scratch buffer when collected, write only ones are dropped then.
+// poll() compares only registers with storage (their thunk has a size), callbacks are never read by it.
+class VDirtyMount : public VMountBase {
+public:
+    // record: [addr u32 little endian][len u16 little endian][len bytes of data]
+    static constexpr size_t header_size = sizeof(uint32_t) + sizeof(uint16_t);
+    static constexpr size_t max_register_size = std::numeric_limits<uint16_t>::max();
+
+private:
+    static constexpr uint32_t npos = VAddrIndex::npos;
+    struct Entry {
+        addr_t addr;
+        uint32_t watch = npos; // in watches_
+        uint32_t size;         // known size, 0 when only a read tells
+    };
+    // a register whose value lives in memory, compared in place by poll()
+    struct Watch {
+        uint32_t index;  // in entries_
+        uint32_t offset; // in shadow_
+        uint32_t size;
+        const std::byte *storage;
+    };
+
+    VMountBasePtr target_;
+    std::vector<Entry> entries_; // sorted by address
+    VAddrIndex index_;
+    std::vector<Watch> watches_;
+    std::vector<std::byte> shadow_; // watched values as last polled or collected, native endian
+    std::vector<uint64_t> dirty_;
+    // registers without a known size are read here, a value that did not fit is held for the next collectDirty
+    std::vector<std::byte> scratch_;
+    uint32_t held_ = npos;
+    size_t held_size_ = 0;
+
+    void set(size_t index) { dirty_[index / 64] |= uint64_t(1) << (index % 64); }
+    void reset(size_t index) { dirty_[index / 64] &= ~(uint64_t(1) << (index % 64)); }
+    std::span<std::byte> shadow(const Watch &watch) { return std::span(shadow_).subspan(watch.offset, watch.size); }
+
+    void watch() {
+        size_t e = 0;
+        for (const VLeafStorage &leaf : leafStorage(*target_)) {
+            while (e < entries_.size() && entries_[e].addr < leaf.addr) {
+                e++;
+            }
+            if (e == entries_.size() || entries_[e].addr != leaf.addr || entries_[e].size != leaf.size)
+                continue;
+            entries_[e].watch = uint32_t(watches_.size());
+            watches_.push_back({uint32_t(e), uint32_t(shadow_.size()), leaf.size, leaf.data});
+            shadow_.insert(shadow_.end(), leaf.data, leaf.data + leaf.size);
+        }
+    }
+    // header of the record whose value is already in place at result.bytes + header_size
+    static void record(std::span<std::byte> buffer, range_result &result, addr_t addr, size_t size) {
+        std::byte *out = buffer.data() + result.bytes;
+        const uint32_t a = std::endian::native == std::endian::little ? addr : vregex::byteswap(addr);
+        const uint16_t s = std::endian::native == std::endian::little ? uint16_t(size)
+                                                                       : vregex::byteswap(uint16_t(size));
+        memcpy(out, &a, sizeof(a));
+        memcpy(out + sizeof(a), &s, sizeof(s));
+        result.bytes += header_size + size;
+        result.count++;
+    }
+
+public:
+    explicit VDirtyMount(VMountBasePtr target) : VMountBase(target->name_, target->desc_), target_(std::move(target)) {
+        std::vector<VAddrIndex::Span> spans;
+        bool unsized = false;
+        for (const VLeafSize &leaf : leafSizes(*target_)) {
+            // larger values do not fit a record, their read into the scratch buffer fails
+            entries_.push_back({leaf.addr, npos, leaf.size <= max_register_size ? leaf.size : 0});
+            spans.push_back({leaf.addr, addr_t(leaf.addr + 1)});
+            unsized |= entries_.back().size == 0;
+        }
+        index_ = VAddrIndex(spans);
+        dirty_.assign(VBitmap::words(entries_.size()), 0);
+        if (unsized) {
+            scratch_.resize(max_register_size);
+        }
+        watch();
+    }
+
+    VMountBase &target() const { return *target_; }
+    virtual size_t size() const override { return target_->size(); }
+    size_t registers() const { return entries_.size(); }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        const size_opt result = target_->writeAt(addr, bytes, endian);
+        if (result) {
+            markDirty(addr);
+        }
+        return result;
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        return target_->readAt(addr, bytes, endian);
+    }
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        return target_->viewAt(addr, scratch);
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        const size_opt result = co_await target_->writeAtAsync(addr, bytes, endian);
+        if (result) {
+            markDirty(addr);
+        }
+        co_return result;
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        return target_->readAtAsync(addr, bytes, endian);
+    }
+
+    void markDirty(addr_t addr) {
+        const uint32_t index = index_.find(addr);
+        if (index != VAddrIndex::npos) {
+            set(index);
+        }
+    }
+    void markAll() {
+        for (size_t i = 0; i < entries_.size(); i++) {
+            set(i);
+        }
+    }
+    void clearDirty() {
+        std::ranges::fill(dirty_, 0);
+        held_ = npos;
+    }
+    bool dirty(addr_t addr) const {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos && (dirty_[index / 64] >> (index % 64) & 1);
+    }
+    size_t dirtyCount() const {
+        size_t n = held_ != npos;
+        for (const uint64_t word : dirty_) {
+            n += std::popcount(word);
+        }
+        return n;
+    }
+
+    // NOTE: change detection for values modified behind the mount (e.g. bound variables).
+    // compares the storage of the watched registers with the shadow, returns the number of newly found changes.
+    size_t poll() {
+        size_t changed = 0;
+        for (const Watch &watch : watches_) {
+            const size_t i = watch.index;
+            const auto last = shadow(watch);
+            if (memcmp(last.data(), watch.storage, last.size()) == 0)
+                continue;
+            memcpy(last.data(), watch.storage, last.size());
+            if (!(dirty_[i / 64] >> (i % 64) & 1)) {
+                set(i);
+                changed++;
+            }
+        }
+        return changed;
+    }
+    // registers poll() compares
+    size_t watched() const { return watches_.size(); }
+
+    // NOTE: packs the dirty registers by ascending address and clears their bits. every register is read once,
+    // with the requested endian, and the value sent is the one poll() compares against afterwards.
+    // registers that do not fit stay dirty for the next call, they are not read. a register of unknown size that
+    // turns out too large after its read is held and sent first by the next call. count is the number of records.
+    range_result collectDirty(std::span<std::byte> buffer, std::endian endian = std::endian::native) {
+        range_result result{0, 0};
+        if (held_ != npos) {
+            if (buffer.size() < header_size + held_size_)
+                return result;
+            std::ranges::copy(std::span(scratch_).first(held_size_), buffer.begin() + header_size);
+            record(buffer, result, entries_[held_].addr, held_size_);
+            held_ = npos;
+        }
+        for (size_t w = 0; w < dirty_.size(); w++) {
+            for (uint64_t bits = dirty_[w]; bits; bits &= bits - 1) {
+                const size_t i = w * 64 + std::countr_zero(bits);
+                const Entry &entry = entries_[i];
+                const size_t space = buffer.size() - result.bytes;
+                if (space < header_size + entry.size)
+                    return result;
+                const auto out = buffer.subspan(result.bytes + header_size);
+                if (entry.size > 0) {
+                    if (target_->readAt(entry.addr, out.first(entry.size), endian) == entry.size) {
+                        if (entry.watch != npos) {
+                            const Watch &watch = watches_[entry.watch];
+                            memcpy(shadow(watch).data(), watch.storage, watch.size);
+                        }
+                        record(buffer, result, entry.addr, entry.size);
+                    }
+                    reset(i);
+                    continue;
+                }
+                const size_opt read = target_->readAt(entry.addr, scratch_, endian);
+                reset(i);
+                if (!read)
+                    continue; // write only, nothing to send
+                if (space < header_size + *read) {
+                    held_ = uint32_t(i), held_size_ = *read;
+                    return result;
+                }
+                std::ranges::copy(std::span(scratch_).first(*read), out.begin());
+                record(buffer, result, entry.addr, *read);
+            }
+        }
+        return result;
+    }
+
+    // NOTE: applies records made by collectDirty (e.g. on the host mirror), stops at a malformed record.
+    // count is the number of applied records, bytes the consumed bytes.
+    static range_result applyDelta(VMountBase &mount, std::span<const std::byte> delta,
+                                   std::endian endian = std::endian::native) {
+        range_result result{0, 0};
+        while (delta.size() - result.bytes >= header_size) {
+            const std::byte *in = delta.data() + result.bytes;
+            uint32_t addr;
+            uint16_t size;
+            memcpy(&addr, in, sizeof(addr));
+            memcpy(&size, in + sizeof(addr), sizeof(size));
+            addr = std::endian::native == std::endian::little ? addr : vregex::byteswap(addr);
+            size = std::endian::native == std::endian::little ? size : vregex::byteswap(size);
+            if (delta.size() - result.bytes - header_size < size)
+                break;
+            if (mount.writeAt(addr, std::span(in + header_size, size), endian)) {
+                result.count++;
+            }
+            result.bytes += header_size + size;
+        }
+        return result;
+    }
+};
+
+}; // namespace vreg::impl
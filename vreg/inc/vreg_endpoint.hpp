@@ -0,0 +1,61 @@
+#pragma once
+#include "vreg_impl.hpp"
+
+namespace vreg::impl {
+
+// NOTE: wire bytes in byte order E of a register holding a T. the register is viewed in native order (in place
+// when it has storage) and the conversion is fixed at compile time, no endian argument travels down the tree.
+// reading a register of another size fails, writing one passes sizeof(T) bytes and returns what it took.
+template <std::endian E, vregex::endian_swappable T>
+size_opt readAs(VMountBase &mount, addr_t addr, std::span<std::byte> bytes) {
+    if (bytes.size() < sizeof(T))
+        return std::nullopt;
+    alignas(T) std::array<std::byte, sizeof(T)> scratch;
+    const view_opt view = mount.viewAt(addr, scratch);
+    if (!view || view->size() != sizeof(T))
+        return std::nullopt;
+    if constexpr (E == std::endian::native) {
+        memcpy(bytes.data(), view->data(), sizeof(T));
+    } else {
+        T value;
+        memcpy(&value, view->data(), sizeof(T));
+        vregex::byteswap_to(bytes.data(), value);
+    }
+    return sizeof(T);
+}
+template <std::endian E, vregex::endian_swappable T>
+size_opt writeAs(VMountBase &mount, addr_t addr, std::span<const std::byte> bytes) {
+    if (bytes.size() < sizeof(T))
+        return std::nullopt;
+    T value;
+    if constexpr (E == std::endian::native) {
+        memcpy(&value, bytes.data(), sizeof(T));
+    } else {
+        vregex::byteswap_from(value, bytes.data());
+    }
+    return mount.writeAt(addr, std::as_bytes(std::span(&value, 1)));
+}
+
+// NOTE: one end of a link whose byte order is fixed, e.g. VEndpoint<std::endian::big> for a Motorola CAN bus.
+// readAs/writeAs<T> take the conversion out of the registers, readAt/writeAt serve registers of any type.
+template <std::endian E> class VEndpoint {
+    VMountBase &mount_;
+
+public:
+    static constexpr std::endian endian = E;
+
+    explicit VEndpoint(VMountBase &mount) : mount_(mount) {}
+    VMountBase &mount() const { return mount_; }
+
+    size_opt readAt(addr_t addr, std::span<std::byte> bytes) { return mount_.readAt(addr, bytes, E); }
+    size_opt writeAt(addr_t addr, std::span<const std::byte> bytes) { return mount_.writeAt(addr, bytes, E); }
+
+    template <vregex::endian_swappable T> size_opt readAs(addr_t addr, std::span<std::byte> bytes) {
+        return impl::readAs<E, T>(mount_, addr, bytes);
+    }
+    template <vregex::endian_swappable T> size_opt writeAs(addr_t addr, std::span<const std::byte> bytes) {
+        return impl::writeAs<E, T>(mount_, addr, bytes);
+    }
+};
+
+}; // namespace vreg::impl
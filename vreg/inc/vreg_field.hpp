@@ -0,0 +1,106 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include <tuple>
+
+namespace vreg::impl {
+
+namespace detail {
+template <size_t Width, bool Signed> constexpr auto fieldValue() {
+    if constexpr (Width <= 8) {
+        return std::conditional_t<Signed, int8_t, uint8_t>{};
+    } else if constexpr (Width <= 16) {
+        return std::conditional_t<Signed, int16_t, uint16_t>{};
+    } else if constexpr (Width <= 32) {
+        return std::conditional_t<Signed, int32_t, uint32_t>{};
+    } else {
+        return std::conditional_t<Signed, int64_t, uint64_t>{};
+    }
+}
+} // namespace detail
+
+// NOTE: bits [Offset, Offset + Width) of an integer register. extract and insert are branch free,
+// signed fields are sign extended by an arithmetic shift.
+template <size_t Offset, size_t Width, bool Signed = false> struct VField {
+    static_assert(Width > 0 && Offset + Width <= 64, "field out of 64 bits");
+    static constexpr size_t offset = Offset, width = Width;
+    static constexpr bool is_signed = Signed;
+    static constexpr uint64_t mask = Width == 64 ? ~uint64_t(0) : (uint64_t(1) << Width) - 1;
+    // smallest integer holding the field
+    using value_type = decltype(detail::fieldValue<Width, Signed>());
+
+    template <std::integral I> static constexpr value_type extract(I raw) {
+        static_assert(Offset + Width <= sizeof(I) * 8, "field out of register");
+        const uint64_t bits = uint64_t(std::make_unsigned_t<I>(raw)) >> Offset & mask;
+        if constexpr (Signed) {
+            return value_type(int64_t(bits << (64 - Width)) >> (64 - Width));
+        } else {
+            return value_type(bits);
+        }
+    }
+    template <std::integral I> static constexpr I insert(I raw, value_type value) {
+        static_assert(Offset + Width <= sizeof(I) * 8, "field out of register");
+        using U = std::make_unsigned_t<I>;
+        return I((U(raw) & ~U(mask << Offset)) | U((uint64_t(value) & mask) << Offset));
+    }
+};
+
+// NOTE: all fields of one register at once, e.g. the signals of a CAN frame
+template <class... Fs> struct VFields {
+    using values = std::tuple<typename Fs::value_type...>;
+
+    template <std::integral I> static constexpr values decode(I raw) { return values{Fs::extract(raw)...}; }
+    template <std::integral I> static constexpr I encode(I raw, const typename Fs::value_type &...values) {
+        ((raw = Fs::insert(raw, values)), ...);
+        return raw;
+    }
+    // a frame of I in the given byte order
+    template <std::integral I>
+    static std::optional<values> decode(std::span<const std::byte> frame, std::endian endian = std::endian::native) {
+        if (frame.size() < sizeof(I))
+            return std::nullopt;
+        I raw;
+        memcpy(&raw, frame.data(), sizeof(I));
+        return decode(endian == std::endian::native ? raw : vregex::byteswap(raw));
+    }
+    // many registers in one pass
+    template <std::integral I> static void decode(std::span<const I> raws, std::span<values> out) {
+        assert(out.size() >= raws.size());
+        for (size_t i = 0; i < raws.size(); i++) {
+            out[i] = decode(raws[i]);
+        }
+    }
+};
+
+// NOTE: one field of a bound integer, read and written as F::value_type.
+// writes are read-modify-write of the bound integer, a const integer makes it read only.
+template <std::integral I, class F> struct VRegField : public VRegBase {
+    using value_type = typename F::value_type;
+    I &binder_;
+
+    constexpr VRegField(I &binder, std::string_view name, std::string_view desc = "")
+        : VRegBase(name, desc), binder_(binder) {}
+    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) override {
+        if constexpr (std::is_const_v<I>) {
+            (void)bytes, (void)endian;
+            return std::nullopt;
+        } else {
+            if (bytes.size() < sizeof(value_type))
+                return std::nullopt;
+            value_type value;
+            memcpy(&value, bytes.data(), sizeof(value));
+            binder_ = F::insert(binder_, endian == std::endian::native ? value : vregex::byteswap(value));
+            return sizeof(value_type);
+        }
+    }
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        if (bytes.size() < sizeof(value_type))
+            return std::nullopt;
+        const value_type value = F::extract(binder_);
+        const value_type out = endian == std::endian::native ? value : vregex::byteswap(value);
+        memcpy(bytes.data(), &out, sizeof(out));
+        return sizeof(value_type);
+    }
+    virtual size_t valueSize() override { return sizeof(value_type); }
+};
+
+}; // namespace vreg::impl
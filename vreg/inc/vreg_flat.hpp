@@ -0,0 +1,114 @@
+#pragma once
+#include "vreg_impl.hpp"
+
+namespace vreg::impl {
+using base::VMountBasePtr;
+
+// NOTE: a mount tree compiled into one flat table.
+// every register address resolves in one index lookup to its VRegBase*, whatever the nesting depth.
+// mounts with unknown structure stay opaque and are called with their local address.
+class VFlatMap : public VMountBase {
+    struct Slot {
+        VRegBase *reg;     // leaf register, or nullptr
+        VMountBase *mount; // opaque mount
+        addr_t base;
+    };
+
+    class Compiler : public VMountVisitor {
+    public:
+        std::vector<VAddrIndex::Span> spans_;
+        std::vector<Slot> slots_;
+        size_t depth_ = 0, max_depth_ = 0;
+
+        virtual void enter(addr_t base, VMountBase &mount) override {
+            (void)base, (void)mount;
+            max_depth_ = std::max(max_depth_, ++depth_);
+        }
+        virtual void leave(addr_t base, VMountBase &mount) override { (void)base, (void)mount, depth_--; }
+        virtual void reg(addr_t addr, VRegBase &reg) override { push(addr, 1, {&reg, &reg, addr}); }
+        virtual void mount(addr_t base, VMountBase &mount) override {
+            push(base, mount.size(), {nullptr, &mount, base});
+        }
+
+    private:
+        void push(addr_t begin, size_t size, const Slot &slot) {
+            if (size == 0)
+                return;
+            spans_.push_back({begin, addr_t(begin + size)});
+            slots_.push_back(slot);
+        }
+    };
+
+    VMountBasePtr root_; // keeps the tree alive when owned
+    std::vector<Slot> slots_;
+    VAddrIndex index_;
+    size_t size_, depth_;
+
+    const Slot *locate(addr_t addr) const {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos ? &slots_[index] : nullptr;
+    }
+
+public:
+    // NOTE: the tree must outlive the flat map
+    explicit VFlatMap(VMountBase &root) : VMountBase(root.name_, root.desc_), size_(root.size()) {
+        Compiler compiler;
+        root.accept(0, compiler);
+        // visiting order is sorted by address
+        slots_ = std::move(compiler.slots_);
+        index_ = VAddrIndex(compiler.spans_);
+        depth_ = compiler.max_depth_;
+    }
+    explicit VFlatMap(VMountBasePtr root) : VFlatMap(*root) { root_ = std::move(root); }
+
+    virtual size_t size() const override { return size_; }
+    size_t leaves() const { return slots_.size(); }
+    size_t depth() const { return depth_; }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        const Slot *slot = locate(addr);
+        if (!slot)
+            return std::nullopt;
+        return slot->reg ? slot->reg->write(bytes, endian) : slot->mount->writeAt(addr - slot->base, bytes, endian);
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        const Slot *slot = locate(addr);
+        if (!slot)
+            return std::nullopt;
+        return slot->reg ? slot->reg->read(bytes, endian) : slot->mount->readAt(addr - slot->base, bytes, endian);
+    }
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        const Slot *slot = locate(addr);
+        if (!slot)
+            return std::nullopt;
+        return slot->reg ? slot->reg->view(scratch) : slot->mount->viewAt(addr - slot->base, scratch);
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        const Slot *slot = locate(addr);
+        if (!slot)
+            return readyTask(size_opt());
+        return slot->reg ? slot->reg->writeAsync(bytes, endian)
+                         : slot->mount->writeAtAsync(addr - slot->base, bytes, endian);
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        const Slot *slot = locate(addr);
+        if (!slot)
+            return readyTask(size_opt());
+        return slot->reg ? slot->reg->readAsync(bytes, endian)
+                         : slot->mount->readAtAsync(addr - slot->base, bytes, endian);
+    }
+
+    virtual void accept(addr_t base, VMountVisitor &visitor) override {
+        visitor.enter(base, *this);
+        for (const auto &slot : slots_) {
+            slot.mount->accept(base + slot.base, visitor);
+        }
+        visitor.leave(base, *this);
+    }
+};
+
+}; // namespace vreg::impl
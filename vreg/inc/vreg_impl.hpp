@@ -1,11 +1,15 @@
 #pragma once
 #include "vreg_base.hpp"
+#include "vreg_index.hpp"
 #include "vregex.hpp"
+#include "vregex_bswap.hpp"
 
 namespace vreg::impl {
-using base::size_opt, base::addr_t;
+using base::size_opt, base::view_opt, base::addr_t;
 using base::VRegBase, base::VRegBasePtr, base::VMountBase, base::VMountBase;
-using base::writer, base::reader;
+using base::writer, base::reader, base::async_writer, base::async_reader;
+using base::VTask, base::readyTask, base::VRegThunk;
+using base::VMountVisitor, base::VBitmap, base::range_result;
 
 template <writer W, reader R> struct VReg : public VRegBase {
     const W writer_;
@@ -48,24 +52,86 @@ static inline auto VRegReserved(std::string_view name = "(reserved)", std::strin
     return VReg(std::move(writer), std::move(reader), name, desc);
 }
 
+namespace detail {
+// the binder conversions on plain storage, see VRegBinder
+template <class T> size_opt loadStorage(void *context, std::span<std::byte> bytes, std::endian endian) {
+    if (bytes.size() < sizeof(T))
+        return std::nullopt;
+    if constexpr (vregex::endian_swappable<T>) {
+        if (endian != std::endian::native) {
+            vregex::byteswap_to(bytes.data(), *static_cast<const T *>(context));
+            return sizeof(T);
+        }
+    } else {
+        (void)endian;
+    }
+    memcpy(bytes.data(), context, sizeof(T));
+    return sizeof(T);
+}
+template <class T> size_opt storeStorage(void *context, std::span<const std::byte> bytes, std::endian endian) {
+    if (bytes.size() < sizeof(T))
+        return std::nullopt;
+    if constexpr (vregex::endian_swappable<T>) {
+        if (endian != std::endian::native) {
+            vregex::byteswap_from(*static_cast<T *>(context), bytes.data());
+            return sizeof(T);
+        }
+    } else {
+        (void)endian;
+    }
+    memcpy(context, bytes.data(), sizeof(T));
+    return sizeof(T);
+}
+} // namespace detail
+
+template <class T> VRegThunk storageThunk(T &value) {
+    using U = std::remove_const_t<T>;
+    VRegThunk::write_fn write = nullptr;
+    if constexpr (!std::is_const_v<T>) {
+        write = &detail::storeStorage<U>;
+    }
+    return {&detail::loadStorage<U>, write, (void *)&value, uint32_t(sizeof(T))};
+}
+
+// NOTE: arrays, floats and structs described by vregex::endian_fields are converted element by element,
+// other types are copied as they are.
 template <class T> struct VRegBinder : public VRegBase {
     T &binder_;
     constexpr VRegBinder(T &binder, std::string_view name, std::string_view desc = "")
         : VRegBase(name, desc), binder_(binder) {}
-    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) const override {
-        (void)endian;
+    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) override {
         if (bytes.size() < sizeof(T))
             return std::nullopt;
+        if constexpr (vregex::endian_swappable<T>) {
+            if (endian != std::endian::native) {
+                vregex::byteswap_from(binder_, bytes.data());
+                return sizeof(T);
+            }
+        } else {
+            (void)endian;
+        }
         memcpy(&binder_, bytes.data(), sizeof(T));
         return sizeof(T);
     }
-    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) const override {
-        (void)endian;
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
         if (bytes.size() < sizeof(T))
             return std::nullopt;
+        if constexpr (vregex::endian_swappable<T>) {
+            if (endian != std::endian::native) {
+                vregex::byteswap_to(bytes.data(), binder_);
+                return sizeof(T);
+            }
+        } else {
+            (void)endian;
+        }
         memcpy(bytes.data(), &binder_, sizeof(T));
         return sizeof(T);
     }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        (void)scratch;
+        return std::as_bytes(std::span(&binder_, 1));
+    }
+    virtual VRegThunk thunk() override { return storageThunk(binder_); }
 };
 
 template <std::integral I> struct VRegBinder<I> : public VRegBase {
@@ -96,22 +162,40 @@ template <std::integral I> struct VRegBinder<I> : public VRegBase {
             memcpy(bytes.data(), &binder_, sizeof(I));
             return sizeof(I);
         }
-        const I tmp = vregex::byteswap(tmp);
+        const I tmp = vregex::byteswap(binder_);
         memcpy(bytes.data(), &tmp, sizeof(I));
         return sizeof(I);
     }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        (void)scratch;
+        return std::as_bytes(std::span(&binder_, 1));
+    }
+    virtual VRegThunk thunk() override { return storageThunk(binder_); }
 };
 
 template <class T> struct VRegBinder<const T> : public VRegBase {
     const T &binder_;
     constexpr VRegBinder(const T &binder, std::string_view name, std::string_view desc = "")
         : VRegBase(name, desc), binder_(binder) {}
-    virtual size_opt read(std::span<std::byte> bytes) override {
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
         if (bytes.size() < sizeof(T))
             return std::nullopt;
+        if constexpr (vregex::endian_swappable<T>) {
+            if (endian != std::endian::native) {
+                vregex::byteswap_to(bytes.data(), binder_);
+                return sizeof(T);
+            }
+        } else {
+            (void)endian;
+        }
         memcpy(bytes.data(), &binder_, sizeof(T));
         return sizeof(T);
     }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        (void)scratch;
+        return std::as_bytes(std::span(&binder_, 1));
+    }
+    virtual VRegThunk thunk() override { return storageThunk(binder_); }
 };
 
 template <std::integral I> struct VRegBinder<const I> : public VRegBase {
@@ -127,10 +211,95 @@ template <std::integral I> struct VRegBinder<const I> : public VRegBase {
             memcpy(bytes.data(), &binder_, sizeof(I));
             return sizeof(I);
         }
-        const I tmp = vregex::byteswap(tmp);
+        const I tmp = vregex::byteswap(binder_);
         memcpy(bytes.data(), &tmp, sizeof(I));
         return sizeof(I);
     }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        (void)scratch;
+        return std::as_bytes(std::span(&binder_, 1));
+    }
+    virtual VRegThunk thunk() override { return storageThunk(binder_); }
+};
+
+// NOTE: concurrent binders. the bound value may be read and written from other threads at any time.
+template <std::integral I> struct VRegBinder<std::atomic<I>> : public VRegBase {
+    static_assert(std::atomic<I>::is_always_lock_free, "use vregex::seqlock for this size");
+    std::atomic<I> &binder_;
+
+    constexpr VRegBinder(std::atomic<I> &binder, std::string_view name, std::string_view desc = "")
+        : VRegBase(name, desc), binder_(binder) {}
+    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) override {
+        if (bytes.size() < sizeof(I))
+            return std::nullopt;
+        I tmp;
+        memcpy(&tmp, bytes.data(), sizeof(I));
+        binder_.store(endian == std::endian::native ? tmp : vregex::byteswap(tmp), std::memory_order_release);
+        return sizeof(I);
+    }
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        if (bytes.size() < sizeof(I))
+            return std::nullopt;
+        const I tmp = binder_.load(std::memory_order_acquire);
+        const I out = endian == std::endian::native ? tmp : vregex::byteswap(tmp);
+        memcpy(bytes.data(), &out, sizeof(I));
+        return sizeof(I);
+    }
+    virtual size_t valueSize() override { return sizeof(I); }
+};
+
+template <std::integral I> struct VRegBinder<const std::atomic<I>> : public VRegBase {
+    static_assert(std::atomic<I>::is_always_lock_free, "use vregex::seqlock for this size");
+    const std::atomic<I> &binder_;
+
+    constexpr VRegBinder(const std::atomic<I> &binder, std::string_view name, std::string_view desc = "")
+        : VRegBase(name, desc), binder_(binder) {}
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        if (bytes.size() < sizeof(I))
+            return std::nullopt;
+        const I tmp = binder_.load(std::memory_order_acquire);
+        const I out = endian == std::endian::native ? tmp : vregex::byteswap(tmp);
+        memcpy(bytes.data(), &out, sizeof(I));
+        return sizeof(I);
+    }
+    virtual size_t valueSize() override { return sizeof(I); }
+};
+
+template <class T> struct VRegBinder<vregex::seqlock<T>> : public VRegBase {
+    vregex::seqlock<T> &binder_;
+
+    constexpr VRegBinder(vregex::seqlock<T> &binder, std::string_view name, std::string_view desc = "")
+        : VRegBase(name, desc), binder_(binder) {}
+    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) override {
+        if (bytes.size() < sizeof(T))
+            return std::nullopt;
+        T tmp;
+        memcpy(&tmp, bytes.data(), sizeof(T));
+        if constexpr (vregex::endian_swappable<T>) {
+            if (endian != std::endian::native) {
+                vregex::byteswap_inplace(tmp);
+            }
+        } else {
+            (void)endian;
+        }
+        binder_.store(tmp);
+        return sizeof(T);
+    }
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        if (bytes.size() < sizeof(T))
+            return std::nullopt;
+        T tmp = binder_.load();
+        if constexpr (vregex::endian_swappable<T>) {
+            if (endian != std::endian::native) {
+                vregex::byteswap_inplace(tmp);
+            }
+        } else {
+            (void)endian;
+        }
+        memcpy(bytes.data(), &tmp, sizeof(T));
+        return sizeof(T);
+    }
+    virtual size_t valueSize() override { return sizeof(T); }
 };
 
 template <class T> static inline auto VRegBinderRO(T &binder, std::string_view name, std::string_view desc = "") {
@@ -144,9 +313,22 @@ template <class T> struct VRegConst : public VRegBase {
     virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
         if (bytes.size() < sizeof(T))
             return std::nullopt;
+        if constexpr (vregex::endian_swappable<T>) {
+            if (endian != std::endian::native) {
+                vregex::byteswap_to(bytes.data(), value_);
+                return sizeof(T);
+            }
+        } else {
+            (void)endian;
+        }
         memcpy(bytes.data(), &value_, sizeof(T));
         return sizeof(T);
     }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        (void)scratch;
+        return std::as_bytes(std::span(&value_, 1));
+    }
+    virtual VRegThunk thunk() override { return storageThunk(value_); }
 };
 
 template <std::integral T> struct VRegConst<T> : public VRegBase {
@@ -160,19 +342,27 @@ template <std::integral T> struct VRegConst<T> : public VRegBase {
             memcpy(bytes.data(), &value_, sizeof(T));
             return sizeof(T);
         }
-        const T tmp = vregex::byteswap(tmp);
+        const T tmp = vregex::byteswap(value_);
 
         memcpy(bytes.data(), &tmp, sizeof(T));
         return sizeof(T);
     }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        (void)scratch;
+        return std::as_bytes(std::span(&value_, 1));
+    }
+    virtual VRegThunk thunk() override { return storageThunk(value_); }
 };
 
 class VRange : public VMountBase {
-    std::vector<std::shared_ptr<VRegBase>> range_; // NOTE: donot resize
+    std::pmr::vector<std::shared_ptr<VRegBase>> range_; // NOTE: donot resize
 
 public:
-    VRange(std::vector<std::shared_ptr<VRegBase>> &&range, std::string_view name, std::string_view desc = "")
+    VRange(std::pmr::vector<std::shared_ptr<VRegBase>> &&range, std::string_view name, std::string_view desc = "")
         : VMountBase(name, desc), range_(std::move(range)) {}
+    VRange(std::vector<std::shared_ptr<VRegBase>> &&range, std::string_view name, std::string_view desc = "")
+        : VMountBase(name, desc), range_(std::make_move_iterator(range.begin()),
+                                         std::make_move_iterator(range.end())) {}
 
     virtual size_t size() const override { return range_.size(); }
     virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
@@ -180,7 +370,7 @@ public:
         if (addr >= range_.size()) {
             return std::nullopt;
         }
-        const auto vreg = range_[addr];
+        const auto &vreg = range_[addr];
         if (!vreg) {
             return std::nullopt;
         }
@@ -191,73 +381,222 @@ public:
         if (addr >= range_.size()) {
             return std::nullopt;
         }
-        const auto vreg = range_[addr];
+        const auto &vreg = range_[addr];
         if (!vreg) {
             return std::nullopt;
         }
         return vreg->read(bytes, endian);
     };
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        if (addr >= range_.size() || !range_[addr]) {
+            return std::nullopt;
+        }
+        return range_[addr]->view(scratch);
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        if (addr >= range_.size() || !range_[addr]) {
+            return readyTask(size_opt());
+        }
+        return range_[addr]->writeAsync(bytes, endian);
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        if (addr >= range_.size() || !range_[addr]) {
+            return readyTask(size_opt());
+        }
+        return range_[addr]->readAsync(bytes, endian);
+    }
+
+    virtual range_result readRange(addr_t addr, size_t count, std::span<std::byte> bytes, VBitmap status = {},
+                                   std::endian endian = std::endian::native) override {
+        size_t used = 0;
+        for (size_t i = 0; i < count; i++) {
+            const size_t index = size_t(addr) + i;
+            VRegBase *vreg = index < range_.size() ? range_[index].get() : nullptr;
+            const size_opt result = vreg ? vreg->read(bytes.subspan(used), endian) : std::nullopt;
+            status.set(i, result.has_value());
+            used += result.value_or(0);
+        }
+        return {count, used};
+    }
+    virtual range_result writeRange(addr_t addr, size_t count, std::span<const std::byte> bytes, VBitmap status = {},
+                                    std::endian endian = std::endian::native) override {
+        size_t used = 0;
+        for (size_t i = 0; i < count; i++) {
+            const size_t index = size_t(addr) + i;
+            VRegBase *vreg = index < range_.size() ? range_[index].get() : nullptr;
+            const size_opt result = vreg ? vreg->write(bytes.subspan(used), endian) : std::nullopt;
+            status.set(i, result.has_value());
+            if (!result) {
+                status.clear(i + 1, count - i - 1);
+                return {i, used};
+            }
+            used += *result;
+        }
+        return {count, used};
+    }
+
+    virtual void accept(addr_t base, VMountVisitor &visitor) override {
+        visitor.enter(base, *this);
+        for (size_t i = 0; i < range_.size(); i++) {
+            if (range_[i])
+                range_[i]->accept(base + i, visitor);
+        }
+        visitor.leave(base, *this);
+    }
 
     auto &at(size_t addr) { return range_.at(addr); }
     const auto &at(size_t addr) const { return range_.at(addr); }
 };
 
+// NOTE: VMap is immutable, so the lookup index and mount sizes are resolved once at construction.
 class VMap : public VMountBase {
 public:
     using pair = std::pair<size_t, std::shared_ptr<VMountBase>>;
 
 private:
-    mutable std::vector<pair> ordered_;
+    struct Slot {
+        addr_t offset, end;
+        VMountBase *mount;
+        size_t entry; // in ordered_
+    };
+    std::vector<pair> ordered_;
+    std::vector<Slot> slots_; // by index span
+    VAddrIndex index_;
+    size_t size_ = 0;
+    bool overlapped_ = false;
+
+    const Slot *locate(addr_t addr) const {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos ? &slots_[index] : nullptr;
+    }
+    // the first slot ending after addr
+    std::vector<Slot>::const_iterator after(addr_t addr) const {
+        return std::ranges::upper_bound(slots_, addr, {}, &Slot::end);
+    }
 
 public:
-    VMap(std::vector<pair> &&ordered, std::string_view name, std::string_view desc)
+    VMap(std::vector<pair> &&ordered, std::string_view name, std::string_view desc = "")
         : VMountBase(name, desc), ordered_(std::move(ordered)) {
         std::ranges::sort(ordered_, {}, [](const pair &p) { return p.first; });
-        // TODO: check overlap
-    }
-
-    virtual size_t size() const {
-        if (ordered_.empty())
-            return 0;
-        const auto &back = ordered_.back();
-        size_t last_addr = back.first;
-        if (auto ptr = back.second; ptr) {
-            last_addr += ptr->size();
+        std::vector<VAddrIndex::Span> spans;
+        spans.reserve(ordered_.size());
+        slots_.reserve(ordered_.size());
+        for (size_t entry = 0; entry < ordered_.size(); entry++) {
+            const auto &[offset, mount] = ordered_[entry];
+            const size_t size = mount ? mount->size() : 0;
+            if (size == 0)
+                continue;
+            if (!spans.empty() && offset < spans.back().end) {
+                overlapped_ = true; // NOTE: the former mount wins
+                continue;
+            }
+            spans.push_back({addr_t(offset), addr_t(offset + size)});
+            slots_.push_back({addr_t(offset), addr_t(offset + size), mount.get(), entry});
         }
-        return last_addr;
+        assert(!overlapped_ && "mounts overlap");
+        size_ = spans.empty() ? 0 : spans.back().end;
+        index_ = VAddrIndex(spans);
     }
 
+    virtual size_t size() const override { return size_; }
+    bool overlapped() const { return overlapped_; }
+    // sorted by offset
+    const std::vector<pair> &entries() const { return ordered_; }
+
     std::optional<pair> find(size_t addr) const {
-        auto end = std::ranges::lower_bound(ordered_, addr + 1, {}, [](const pair &p) { return p.first; });
-        auto iter = end - 1;
-        if (iter != ordered_.begin()) {
-            const auto &[offset, mount] = *iter;
-            const size_t size = mount ? mount->size() : 0;
-            if (offset <= addr && addr < offset + size) {
-                return *iter;
-            }
+        if (const Slot *slot = locate(addr)) {
+            return ordered_[slot->entry];
         }
         return std::nullopt;
     }
 
     virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
                              std::endian endian = std::endian::native) override {
-        if (auto opt = find(addr)) {
-            const auto &[offset, mount] = *opt;
-            return mount->writeAt(addr - offset, bytes, endian);
-        } else {
-            return std::nullopt;
+        if (const Slot *slot = locate(addr)) {
+            return slot->mount->writeAt(addr - slot->offset, bytes, endian);
         }
+        return std::nullopt;
     };
     virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
                             std::endian endian = std::endian::native) override {
-        if (auto opt = find(addr)) {
-            const auto &[offset, mount] = *opt;
-            return mount->readAt(addr - offset, bytes, endian);
-        } else {
-            return std::nullopt;
+        if (const Slot *slot = locate(addr)) {
+            return slot->mount->readAt(addr - slot->offset, bytes, endian);
         }
+        return std::nullopt;
     };
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        if (const Slot *slot = locate(addr)) {
+            return slot->mount->viewAt(addr - slot->offset, scratch);
+        }
+        return std::nullopt;
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        if (const Slot *slot = locate(addr)) {
+            return slot->mount->writeAtAsync(addr - slot->offset, bytes, endian);
+        }
+        return readyTask(size_opt());
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        if (const Slot *slot = locate(addr)) {
+            return slot->mount->readAtAsync(addr - slot->offset, bytes, endian);
+        }
+        return readyTask(size_opt());
+    }
+
+    // NOTE: contiguous regions are handed to the mounts as a whole, unmapped addresses fail
+    virtual range_result readRange(addr_t addr, size_t count, std::span<std::byte> bytes, VBitmap status = {},
+                                   std::endian endian = std::endian::native) override {
+        const size_t last = size_t(addr) + count;
+        size_t cursor = addr, used = 0;
+        for (auto iter = after(addr); cursor < last; iter++) {
+            const size_t begin = (iter != slots_.end()) ? std::max<size_t>(iter->offset, cursor) : last;
+            if (cursor < begin) {
+                status.clear(cursor - addr, std::min(begin, last) - cursor);
+                cursor = begin;
+            }
+            if (cursor >= last)
+                break;
+            const size_t n = std::min<size_t>(last, iter->end) - cursor;
+            const auto result = iter->mount->readRange(addr_t(cursor - iter->offset), n, bytes.subspan(used),
+                                                       status.sub(cursor - addr), endian);
+            used += result.bytes;
+            cursor += n;
+        }
+        return {count, used};
+    }
+    virtual range_result writeRange(addr_t addr, size_t count, std::span<const std::byte> bytes, VBitmap status = {},
+                                    std::endian endian = std::endian::native) override {
+        const size_t last = size_t(addr) + count;
+        size_t cursor = addr, used = 0;
+        for (auto iter = after(addr); cursor < last; iter++) {
+            if (iter == slots_.end() || cursor < iter->offset) {
+                status.clear(cursor - addr, last - cursor);
+                return {cursor - addr, used};
+            }
+            const size_t n = std::min<size_t>(last, iter->end) - cursor;
+            const auto result = iter->mount->writeRange(addr_t(cursor - iter->offset), n, bytes.subspan(used),
+                                                        status.sub(cursor - addr), endian);
+            used += result.bytes;
+            if (result.count < n) {
+                status.clear(cursor - addr + n, last - cursor - n);
+                return {cursor - addr + result.count, used};
+            }
+            cursor += n;
+        }
+        return {count, used};
+    }
+
+    virtual void accept(addr_t base, VMountVisitor &visitor) override {
+        visitor.enter(base, *this);
+        for (const auto &slot : slots_) {
+            slot.mount->accept(base + slot.offset, visitor);
+        }
+        visitor.leave(base, *this);
+    }
 };
 
 }; // namespace vreg::impl
\ No newline at end of file
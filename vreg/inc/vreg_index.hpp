@@ -0,0 +1,161 @@
+#pragma once
+#include "vreg_base.hpp"
+#include <bit>
+#include <limits>
+
+namespace vreg::impl {
+using base::addr_t, base::size_opt, base::view_opt;
+using base::VMountBase, base::VMountVisitor, base::VRegBase, base::VRegThunk;
+
+// NOTE: immutable address -> span lookup, built once from sorted and non-overlapping spans.
+// compact address spaces get a dense jump table, sparse ones (e.g. 29-bit CAN IDs) an Eytzinger layout.
+class VAddrIndex {
+public:
+    struct Span {
+        addr_t begin, end; // [begin, end)
+    };
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t dense_limit = size_t(1) << 16; // table entries
+    static constexpr size_t dense_floor = size_t(1) << 12; // always dense up to this
+    static constexpr size_t dense_ratio = 4;               // table entries per mapped address
+
+private:
+    std::vector<addr_t> ends_; // by span index
+    // dense
+    addr_t base_ = 0;
+    std::vector<uint32_t> table_; // table_[addr - base_] = span index or npos
+    // sparse (1-based Eytzinger order, slot 0 unused)
+    std::vector<addr_t> begins_;
+    std::vector<uint32_t> ranks_;
+
+    void buildDense(std::span<const Span> spans) {
+        base_ = spans.front().begin;
+        table_.assign(spans.back().end - base_, npos);
+        for (uint32_t i = 0; i < spans.size(); i++) {
+            std::fill(table_.begin() + (spans[i].begin - base_), table_.begin() + (spans[i].end - base_), i);
+        }
+    }
+
+    void buildEytzinger(std::span<const Span> spans, size_t &rank, size_t k = 1) {
+        if (k > spans.size())
+            return;
+        buildEytzinger(spans, rank, 2 * k);
+        begins_[k] = spans[rank].begin;
+        ranks_[k] = uint32_t(rank++);
+        buildEytzinger(spans, rank, 2 * k + 1);
+    }
+
+public:
+    VAddrIndex() = default;
+    explicit VAddrIndex(std::span<const Span> spans) {
+        if (spans.empty())
+            return;
+        ends_.reserve(spans.size());
+        size_t mapped = 0;
+        for (const auto &span : spans) {
+            ends_.push_back(span.end);
+            mapped += span.end - span.begin;
+        }
+        const size_t extent = spans.back().end - spans.front().begin;
+        if (extent <= dense_limit && (extent <= dense_floor || extent <= mapped * dense_ratio)) {
+            buildDense(spans);
+        } else {
+            begins_.resize(spans.size() + 1);
+            ranks_.resize(spans.size() + 1);
+            size_t rank = 0;
+            buildEytzinger(spans, rank);
+        }
+    }
+
+    bool dense() const { return !table_.empty(); }
+    size_t count() const { return ends_.size(); }
+
+    // span index holding addr, or npos
+    uint32_t find(addr_t addr) const {
+        if (dense()) {
+            const size_t offset = size_t(addr) - base_;
+            return offset < table_.size() ? table_[offset] : npos;
+        }
+        if (begins_.empty())
+            return npos;
+        const size_t n = begins_.size() - 1;
+        // branchless descent to the first begin > addr
+        size_t k = 1;
+        while (k <= n) {
+            k = 2 * k + (begins_[k] <= addr);
+        }
+        k >>= std::countr_one(k) + 1;
+        const size_t upper = k ? ranks_[k] : n;
+        if (upper == 0)
+            return npos;
+        const uint32_t index = uint32_t(upper - 1);
+        return addr < ends_[index] ? index : npos;
+    }
+};
+
+// NOTE: every register address of a mount tree, sorted. mounts with unknown structure count each address.
+static inline std::vector<addr_t> leafAddrs(VMountBase &mount) {
+    struct Collector : public VMountVisitor {
+        std::vector<addr_t> addrs_;
+        virtual void reg(addr_t addr, VRegBase &reg) override { (void)reg, addrs_.push_back(addr); }
+        virtual void mount(addr_t base, VMountBase &mount) override {
+            for (size_t i = 0; i < mount.size(); i++) {
+                addrs_.push_back(addr_t(base + i));
+            }
+        }
+    } collector;
+    mount.accept(0, collector);
+    std::ranges::sort(collector.addrs_);
+    collector.addrs_.erase(std::ranges::unique(collector.addrs_).begin(), collector.addrs_.end());
+    return std::move(collector.addrs_);
+}
+
+// register of a mount tree whose value lives in memory, see VRegThunk
+struct VLeafStorage {
+    addr_t addr;
+    const std::byte *data;
+    uint32_t size;
+    VRegThunk::read_fn read; // converts data to either endian, with data as the context
+};
+
+// NOTE: registers with storage, sorted by address. nothing is read, registers with read side effects are safe.
+// registers behind opaque mounts are not listed.
+static inline std::vector<VLeafStorage> leafStorage(VMountBase &mount) {
+    struct Collector : public VMountVisitor {
+        std::vector<VLeafStorage> leaves_;
+        virtual void reg(addr_t addr, VRegBase &reg) override {
+            if (const VRegThunk thunk = reg.thunk(); thunk.size > 0)
+                leaves_.push_back({addr, static_cast<const std::byte *>(thunk.context), thunk.size, thunk.read});
+        }
+        virtual void mount(addr_t base, VMountBase &mount) override { (void)base, (void)mount; }
+    } collector;
+    mount.accept(0, collector);
+    std::ranges::sort(collector.leaves_, {}, &VLeafStorage::addr);
+    return std::move(collector.leaves_);
+}
+
+// register of a mount tree with its size as far as it is known without reading
+struct VLeafSize {
+    addr_t addr;
+    uint32_t size; // VRegBase::valueSize(), 0 for callbacks and addresses behind opaque mounts
+};
+
+// NOTE: the addresses of leafAddrs with their sizes. nothing is read, registers with read side effects are safe.
+static inline std::vector<VLeafSize> leafSizes(VMountBase &mount) {
+    struct Collector : public VMountVisitor {
+        std::vector<VLeafSize> leaves_;
+        virtual void reg(addr_t addr, VRegBase &reg) override { leaves_.push_back({addr, uint32_t(reg.valueSize())}); }
+        virtual void mount(addr_t base, VMountBase &mount) override {
+            for (size_t i = 0; i < mount.size(); i++) {
+                leaves_.push_back({addr_t(base + i), 0});
+            }
+        }
+    } collector;
+    mount.accept(0, collector);
+    std::ranges::stable_sort(collector.leaves_, {}, &VLeafSize::addr);
+    const auto duplicates = std::ranges::unique(collector.leaves_, {}, &VLeafSize::addr);
+    collector.leaves_.erase(duplicates.begin(), duplicates.end());
+    return std::move(collector.leaves_);
+}
+
+}; // namespace vreg::impl
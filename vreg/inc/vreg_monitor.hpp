@@ -0,0 +1,470 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include "vreg_names.hpp"
+#include <charconv>
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define VREG_HAS_POSIX_IO 1
+#endif
+
+namespace vreg::impl {
+
+// NOTE: register monitor protocol over a byte stream (UART, pty, pipe).
+// frames are [0xA5][command][length][payload][crc8], the crc covers command, length and payload.
+// a response carries the command with the high bit set and starts its payload with the status.
+// addresses and counts are little endian, register values are in the byte order of the monitor.
+struct VMonitorProtocol {
+    static constexpr std::byte sync{0xa5};
+    static constexpr uint8_t response = 0x80;
+    static constexpr size_t max_payload = 255, overhead = 4;
+    static constexpr size_t max_value = 64; // bytes per register
+    static constexpr size_t max_dump = 64;  // registers per dump
+
+    enum Command : uint8_t {
+        ping = 0,      // -> status
+        read = 1,      // addr:u32 -> status, value
+        write = 2,     // addr:u32, value -> status, written:u8
+        dump = 3,      // addr:u32, count:u8 -> status, bitmap:u64 (bit set = read), values back to back
+        find = 4,      // name -> status, addr:u32
+        read_name = 5, // name -> status, addr:u32, value
+    };
+    enum Status : uint8_t { ok = 0, failed = 1, bad_request = 2, unknown_command = 3 };
+
+    static uint32_t load32(std::span<const std::byte> bytes) {
+        uint32_t value;
+        memcpy(&value, bytes.data(), sizeof(value));
+        return std::endian::native == std::endian::little ? value : vregex::byteswap(value);
+    }
+    static void store32(std::span<std::byte> bytes, uint32_t value) {
+        value = std::endian::native == std::endian::little ? value : vregex::byteswap(value);
+        memcpy(bytes.data(), &value, sizeof(value));
+    }
+
+    // a frame of payload parts into out, returns its size or 0 when it does not fit
+    static size_t frame(uint8_t command, std::initializer_list<std::span<const std::byte>> parts,
+                        std::span<std::byte> out) {
+        size_t length = 0;
+        for (const auto &part : parts) {
+            length += part.size();
+        }
+        if (length > max_payload || out.size() < length + overhead)
+            return 0;
+        out[0] = sync, out[1] = std::byte(command), out[2] = std::byte(length);
+        size_t used = 3;
+        for (const auto &part : parts) {
+            std::ranges::copy(part, out.begin() + used);
+            used += part.size();
+        }
+        out[used] = std::byte(vregex::crc8(out.subspan(1, used - 1)));
+        return used + 1;
+    }
+
+    // requests, for clients and tests
+    static size_t readRequest(addr_t addr, std::span<std::byte> out) {
+        std::array<std::byte, 4> a;
+        store32(a, addr);
+        return frame(read, {a}, out);
+    }
+    static size_t writeRequest(addr_t addr, std::span<const std::byte> value, std::span<std::byte> out) {
+        std::array<std::byte, 4> a;
+        store32(a, addr);
+        return frame(write, {a, value}, out);
+    }
+    static size_t dumpRequest(addr_t addr, uint8_t count, std::span<std::byte> out) {
+        std::array<std::byte, 5> a;
+        store32(a, addr);
+        a[4] = std::byte(count);
+        return frame(dump, {a}, out);
+    }
+    static size_t findRequest(std::string_view name, std::span<std::byte> out, Command command = find) {
+        return frame(command, {std::as_bytes(std::span(name))}, out);
+    }
+};
+
+// NOTE: incremental, allocation free frame parser. feed() takes whatever the stream delivered: frames that lie
+// whole in the input are handed to on_frame(command, payload) in place, fragmented ones are collected in an
+// internal buffer. a bad crc drops the sync byte and the parser resyncs on the next one, also inside the dropped
+// frame, so the frames found do not depend on how the stream is split.
+// with text enabled, lines not starting with the sync byte go to on_line without their line end.
+class VMonitorParser {
+    enum class State : uint8_t { sync, command, length, payload, crc, line };
+    using P = VMonitorProtocol;
+
+    State state_ = State::sync;
+    bool text_;
+    uint8_t command_ = 0, length_ = 0;
+    size_t have_ = 0;
+    std::array<std::byte, P::max_payload> payload_;
+    std::array<char, 128> line_;
+    size_t line_size_ = 0;
+    bool line_overflow_ = false;
+    size_t crc_errors_ = 0, dropped_ = 0;
+
+    static bool lineEnd(std::byte b) { return b == std::byte('\n') || b == std::byte('\r'); }
+
+    // parses input until it ends or a fragmented frame fails its crc (the crc byte is not consumed).
+    // returns the consumed bytes.
+    template <class OnFrame, class OnLine>
+    size_t scan(std::span<const std::byte> input, OnFrame &on_frame, OnLine &on_line, bool &failed) {
+        size_t i = 0;
+        while (i < input.size()) {
+            const std::byte b = input[i];
+            switch (state_) {
+            case State::sync:
+                if (b == P::sync) {
+                    // whole frame in the input, nothing is copied
+                    if (i + 3 <= input.size() && i + P::overhead + size_t(input[i + 2]) <= input.size()) {
+                        const size_t length = size_t(input[i + 2]);
+                        const auto body = input.subspan(i + 1, 2 + length);
+                        if (vregex::crc8(body) == uint8_t(input[i + 3 + length])) {
+                            on_frame(uint8_t(body[0]), body.subspan(2));
+                            i += P::overhead + length;
+                        } else {
+                            crc_errors_++, i++;
+                        }
+                        continue;
+                    }
+                    state_ = State::command;
+                } else if (text_ && !lineEnd(b)) {
+                    const auto rest = input.subspan(i);
+                    const auto end = std::ranges::find_if(rest, lineEnd);
+                    if (end != rest.end()) {
+                        const auto line = rest.first(size_t(end - rest.begin()));
+                        on_line(std::string_view(reinterpret_cast<const char *>(line.data()), line.size()));
+                        i += line.size() + 1;
+                        continue;
+                    }
+                    state_ = State::line, line_size_ = 0, line_overflow_ = false;
+                    continue;
+                } else if (!lineEnd(b)) {
+                    dropped_++;
+                }
+                i++;
+                break;
+            case State::command:
+                command_ = uint8_t(b), state_ = State::length, i++;
+                break;
+            case State::length:
+                length_ = uint8_t(b), have_ = 0, state_ = length_ ? State::payload : State::crc, i++;
+                break;
+            case State::payload: {
+                const size_t n = std::min<size_t>(length_ - have_, input.size() - i);
+                memcpy(payload_.data() + have_, input.data() + i, n);
+                have_ += n, i += n;
+                if (have_ == length_)
+                    state_ = State::crc;
+                break;
+            }
+            case State::crc: {
+                const std::array<std::byte, 2> header = {std::byte(command_), std::byte(length_)};
+                const auto payload = std::span(payload_).first(length_);
+                state_ = State::sync;
+                if (vregex::crc8(payload, vregex::crc8(header)) != uint8_t(b)) {
+                    crc_errors_++, failed = true;
+                    return i;
+                }
+                on_frame(command_, std::span<const std::byte>(payload));
+                i++;
+                break;
+            }
+            case State::line:
+                if (lineEnd(b)) {
+                    if (line_overflow_) {
+                        dropped_ += line_size_;
+                    } else {
+                        on_line(std::string_view(line_.data(), line_size_));
+                    }
+                    state_ = State::sync;
+                } else if (line_size_ < line_.size()) {
+                    line_[line_size_++] = char(b);
+                } else {
+                    line_overflow_ = true;
+                }
+                i++;
+                break;
+            }
+        }
+        return i;
+    }
+
+public:
+    explicit VMonitorParser(bool text = false) : text_(text) {}
+
+    size_t crcErrors() const { return crc_errors_; }
+    size_t dropped() const { return dropped_; } // bytes outside frames and overlong lines
+
+    template <class OnFrame, class OnLine>
+    void feed(std::span<const std::byte> input, OnFrame &&on_frame, OnLine &&on_line) {
+        // bytes after the sync byte of a fragmented frame that failed its crc, scanned again before the rest.
+        // a failure inside them leaves fewer bytes to scan, so they always fit.
+        std::array<std::byte, 2 + P::max_payload> rescan;
+        std::span<const std::byte> pending;
+        while (!pending.empty() || !input.empty()) {
+            std::span<const std::byte> &source = pending.empty() ? input : pending;
+            bool failed = false;
+            source = source.subspan(scan(source, on_frame, on_line, failed));
+            if (!failed)
+                continue;
+            const size_t buffered = 2 + length_;
+            const size_t rest = pending.size();
+            if (rest > 0) {
+                memmove(rescan.data() + buffered, pending.data(), rest);
+            }
+            rescan[0] = std::byte(command_), rescan[1] = std::byte(length_);
+            memcpy(rescan.data() + 2, payload_.data(), length_);
+            pending = std::span(rescan).first(buffered + rest);
+        }
+    }
+    template <class OnFrame> void feed(std::span<const std::byte> input, OnFrame &&on_frame) {
+        feed(input, on_frame, [](std::string_view) {});
+    }
+};
+
+// NOTE: serves monitor requests against a mount, e.g. a VMap behind a UART. the responses to everything fed are
+// appended to one output buffer, which the caller sends and consumes. nothing is allocated after construction,
+// requests arriving while the output cannot hold a full response are dropped and counted.
+// the text mode answers lines, in hex and with big endian values so that they read as numbers:
+//   p | r <addr> | w <addr> <value> | d <addr> <count> | f <name> | n <name>  ->  ok [fields] | err <status>
+// addresses are 32 bit, numbers and values may start with 0x.
+class VMonitor {
+public:
+    using P = VMonitorProtocol;
+    static constexpr size_t max_response = P::max_payload + P::overhead;
+    static constexpr size_t max_text_response = 2 * P::max_payload + 16;
+
+    struct Counters {
+        size_t requests = 0;
+        size_t overflows = 0; // dropped for lack of output space
+    };
+
+private:
+    VMountBase &mount_;
+    const VNameIndex *names_;
+    std::endian endian_;
+    VMonitorParser parser_;
+    std::vector<std::byte> output_;
+    size_t output_size_ = 0;
+    Counters counters_;
+
+    // the response payload after the status
+    P::Status execute(uint8_t command, std::span<const std::byte> request, std::span<std::byte> out, size_t &size,
+                      std::endian endian) {
+        size = 0;
+        switch (command) {
+        case P::ping:
+            return P::ok;
+        case P::read: {
+            if (request.size() != 4)
+                return P::bad_request;
+            const size_opt result = mount_.readAt(P::load32(request), out.first(P::max_value), endian);
+            size = result.value_or(0);
+            return result ? P::ok : P::failed;
+        }
+        case P::write: {
+            if (request.size() < 4)
+                return P::bad_request;
+            const size_opt result = mount_.writeAt(P::load32(request), request.subspan(4), endian);
+            if (!result)
+                return P::failed;
+            out[0] = std::byte(*result), size = 1;
+            return P::ok;
+        }
+        case P::dump: {
+            if (request.size() != 5 || size_t(request[4]) > P::max_dump)
+                return P::bad_request;
+            std::array<uint64_t, 1> words{};
+            const auto result = mount_.readRange(P::load32(request), size_t(request[4]), out.subspan(8),
+                                                 VBitmap(words), endian);
+            const uint64_t bitmap = std::endian::native == std::endian::little ? words[0] : vregex::byteswap(words[0]);
+            memcpy(out.data(), &bitmap, sizeof(bitmap));
+            size = 8 + result.bytes;
+            return P::ok;
+        }
+        case P::find:
+        case P::read_name: {
+            const std::string_view name(reinterpret_cast<const char *>(request.data()), request.size());
+            const std::optional<addr_t> addr = names_ ? names_->find(name) : std::nullopt;
+            if (!addr)
+                return P::failed;
+            P::store32(out, *addr), size = 4;
+            if (command == P::find)
+                return P::ok;
+            const size_opt result = mount_.readAt(*addr, out.subspan(4, P::max_value), endian);
+            size += result.value_or(0);
+            return result ? P::ok : P::failed;
+        }
+        default:
+            return P::unknown_command;
+        }
+    }
+
+    void onFrame(uint8_t command, std::span<const std::byte> request) {
+        if (command & P::response)
+            return; // our own echo or another monitor
+        counters_.requests++;
+        if (output_.size() - output_size_ < max_response) {
+            counters_.overflows++;
+            return;
+        }
+        const auto out = std::span(output_).subspan(output_size_);
+        size_t size;
+        const P::Status status = execute(command, request, out.subspan(4, P::max_payload - 1), size, endian_);
+        out[0] = P::sync, out[1] = std::byte(command | P::response), out[2] = std::byte(size + 1);
+        out[3] = std::byte(status);
+        out[4 + size] = std::byte(vregex::crc8(out.subspan(1, 3 + size)));
+        output_size_ += size + P::overhead + 1;
+    }
+
+    void put(std::string_view s) {
+        memcpy(output_.data() + output_size_, s.data(), s.size());
+        output_size_ += s.size();
+    }
+    void putHex(std::span<const std::byte> bytes) {
+        constexpr char digits[] = "0123456789abcdef";
+        put(" ");
+        for (const std::byte b : bytes) {
+            const char pair[2] = {digits[uint8_t(b) >> 4], digits[uint8_t(b) & 0xf]};
+            put(std::string_view(pair, 2));
+        }
+    }
+    void putNumber(uint64_t value) {
+        std::array<char, 17> text;
+        const auto end = std::to_chars(text.data(), text.data() + text.size(), value, 16).ptr;
+        put(" "), put(std::string_view(text.data(), end));
+    }
+
+    static std::string_view withoutPrefix(std::string_view token) {
+        if (token.starts_with("0x") || token.starts_with("0X"))
+            token.remove_prefix(2);
+        return token;
+    }
+    // hex number with an optional 0x
+    static std::optional<uint64_t> parseNumber(std::string_view token) {
+        token = withoutPrefix(token);
+        uint64_t value;
+        const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value, 16);
+        if (error != std::errc() || end != token.data() + token.size())
+            return std::nullopt;
+        return value;
+    }
+    static std::string_view nextToken(std::string_view &line) {
+        const size_t begin = std::min(line.find_first_not_of(' '), line.size());
+        const size_t end = std::min(line.find(' ', begin), line.size());
+        const std::string_view token = line.substr(begin, end - begin);
+        line.remove_prefix(end);
+        return token;
+    }
+
+    void onLine(std::string_view line) {
+        counters_.requests++;
+        if (output_.size() - output_size_ < max_text_response) {
+            counters_.overflows++;
+            return;
+        }
+        // the line to a binary request
+        std::array<std::byte, P::max_payload> request;
+        size_t length = 0;
+        uint8_t command = 0xff;
+        const std::string_view verb = nextToken(line);
+        bool valid = verb.size() == 1;
+        if (valid && (verb[0] == 'f' || verb[0] == 'n')) {
+            const std::string_view name = nextToken(line);
+            command = verb[0] == 'f' ? P::find : P::read_name;
+            length = std::min(name.size(), request.size());
+            memcpy(request.data(), name.data(), length);
+        } else if (valid) {
+            constexpr std::string_view verbs = "prwd"; // in command order
+            command = uint8_t(std::min(verbs.find(verb[0]), size_t(0xff)));
+            if (command != P::ping && command != 0xff) {
+                const auto addr = parseNumber(nextToken(line));
+                valid = addr.has_value() && *addr <= std::numeric_limits<uint32_t>::max();
+                P::store32(request, uint32_t(addr.value_or(0))), length = 4;
+            }
+            const std::string_view arg = nextToken(line);
+            if (command == P::dump) {
+                const auto count = parseNumber(arg);
+                valid &= count.has_value() && *count <= P::max_dump;
+                request[4] = std::byte(count.value_or(0)), length = 5;
+            } else if (command == P::write) {
+                const std::string_view value = withoutPrefix(arg);
+                valid &= value.size() % 2 == 0 && value.size() / 2 <= P::max_value;
+                for (size_t k = 0; valid && k < value.size(); k += 2) {
+                    const auto byte = parseNumber(value.substr(k, 2));
+                    valid = byte.has_value();
+                    request[length++] = std::byte(byte.value_or(0));
+                }
+            }
+        }
+
+        std::array<std::byte, P::max_payload> response;
+        size_t size = 0;
+        const P::Status status = valid ? execute(command, std::span(request).first(length), response, size,
+                                                 std::endian::big)
+                                       : P::bad_request;
+        if (status != P::ok) {
+            put("err"), putNumber(status), put("\n");
+            return;
+        }
+        put("ok");
+        const auto data = std::span(response).first(size);
+        if (command == P::find || command == P::read_name) {
+            putNumber(P::load32(data));
+            if (command == P::read_name)
+                putHex(data.subspan(4));
+        } else if (command == P::dump) {
+            uint64_t bitmap;
+            memcpy(&bitmap, data.data(), sizeof(bitmap));
+            putNumber(std::endian::native == std::endian::little ? bitmap : vregex::byteswap(bitmap));
+            putHex(data.subspan(8));
+        } else if (size > 0) {
+            putHex(data);
+        }
+        put("\n");
+    }
+
+public:
+    // NOTE: names may be null, name queries then fail. output holds at least one response of either mode.
+    explicit VMonitor(VMountBase &mount, const VNameIndex *names = nullptr, std::endian endian = std::endian::little,
+                      bool text = false, size_t output = 4096)
+        : mount_(mount), names_(names), endian_(endian), parser_(text),
+          output_(std::max({output, max_response, max_text_response})) {}
+    VMonitor(const VMonitor &) = delete;
+
+    const Counters &counters() const { return counters_; }
+    const VMonitorParser &parser() const { return parser_; }
+
+    // received bytes, in any fragmentation
+    void feed(std::span<const std::byte> input) {
+        parser_.feed(
+            input, [this](uint8_t command, std::span<const std::byte> request) { onFrame(command, request); },
+            [this](std::string_view line) { onLine(line); });
+    }
+    // pending responses, to be sent and consumed
+    std::span<const std::byte> output() const { return std::span(output_).first(output_size_); }
+    void consume(size_t n) {
+        n = std::min(n, output_size_);
+        memmove(output_.data(), output_.data() + n, output_size_ - n);
+        output_size_ -= n;
+    }
+
+#ifdef VREG_HAS_POSIX_IO
+    // NOTE: one blocking read from in, then every response written to out.
+    // false at the end of the stream or on an error.
+    bool serve(int in, int out) {
+        std::array<std::byte, 512> received;
+        const ssize_t n = ::read(in, received.data(), received.size());
+        if (n <= 0)
+            return false;
+        feed(std::span(received).first(size_t(n)));
+        while (output_size_ > 0) {
+            const ssize_t written = ::write(out, output_.data(), output_size_);
+            if (written <= 0)
+                return false;
+            consume(size_t(written));
+        }
+        return true;
+    }
+#endif
+};
+
+}; // namespace vreg::impl
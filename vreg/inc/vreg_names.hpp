@@ -0,0 +1,178 @@
+#pragma once
+#include "vreg_impl.hpp"
+
+namespace vreg::impl {
+
+// NOTE: name to address lookup over a mount tree, e.g. for "read by name" over UART.
+// registers are keyed by their path below the root, the names of the mounts entered on the way and the
+// register joined by the separator ("motor.speed"). unnamed mounts add no component, opaque ones are skipped.
+// built once with a minimal perfect hash (hash and displace): find() hashes the name once, 8 bytes at a time, probes
+// one slot and compares one string, without allocating. when two registers share a path the lower address wins.
+class VNameIndex {
+    struct Slot {
+        uint32_t offset; // in names_
+        uint32_t length;
+        addr_t addr;
+    };
+
+    uint64_t seed_ = vregex::fnv1a("");
+    std::vector<uint32_t> displacements_; // per bucket
+    std::vector<Slot> slots_;             // one per path
+    std::string names_;                   // cold, for the final comparison
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        return x ^ (x >> 33);
+    }
+    // 8 bytes per step instead of fnv1a's one, the final mix spreads similar names over the high bits
+    uint64_t hash(std::string_view name) const {
+        uint64_t h = seed_ ^ (name.size() * 0x9e3779b97f4a7c15ULL);
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= name.size(); i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, name.data() + i, sizeof(word));
+            h = (h ^ word) * 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+        }
+        // the tail without a variable length copy: the last 8 bytes overlapping the words (also when there is no
+        // rest, one branch less), two 4 byte loads or 3 single bytes
+        const size_t rest = name.size() - i;
+        const char *end = name.data() + name.size();
+        uint64_t tail = 0;
+        if (name.size() >= sizeof(uint64_t)) {
+            memcpy(&tail, end - sizeof(uint64_t), sizeof(tail));
+        } else if (rest >= sizeof(uint32_t)) {
+            uint32_t first, last;
+            memcpy(&first, name.data(), sizeof(first));
+            memcpy(&last, end - sizeof(last), sizeof(last));
+            tail = uint64_t(first) << 32 | last;
+        } else if (rest > 0) {
+            tail = uint64_t(uint8_t(name[0])) << 16 | uint64_t(uint8_t(name[rest / 2])) << 8 | uint8_t(end[-1]);
+        }
+        return mix(h ^ tail);
+    }
+    // 32 bits to [0, n) by multiplication instead of a division
+    static size_t reduce(uint64_t h, size_t n) { return size_t((h & 0xffffffff) * n >> 32); }
+    size_t bucket(uint64_t h) const { return reduce(h >> 32, displacements_.size()); }
+    // double hashing, each displacement moves the keys of a bucket by their own stride
+    size_t slot(uint64_t h, uint32_t displacement) const {
+        return reduce(uint32_t(h) + displacement * (uint32_t(h >> 16) | 1), slots_.size());
+    }
+
+    class Collector : public VMountVisitor {
+        char separator_;
+        std::vector<std::string_view> stack_;
+
+    public:
+        std::vector<std::pair<std::string, addr_t>> paths_;
+
+        explicit Collector(char separator) : separator_(separator) {}
+        virtual void enter(addr_t base, VMountBase &mount) override {
+            (void)base;
+            stack_.push_back(mount.name_);
+        }
+        virtual void leave(addr_t base, VMountBase &mount) override { (void)base, (void)mount, stack_.pop_back(); }
+        virtual void reg(addr_t addr, VRegBase &reg) override {
+            std::string path;
+            // the root is not part of the path
+            for (size_t i = 1; i < stack_.size(); i++) {
+                if (!stack_[i].empty()) {
+                    path.append(stack_[i]).push_back(separator_);
+                }
+            }
+            path.append(reg.name_);
+            paths_.emplace_back(std::move(path), addr);
+        }
+        virtual void mount(addr_t base, VMountBase &mount) override { (void)base, (void)mount; }
+    };
+
+    // false when some bucket found no displacement, retried with another seed
+    bool place(const std::vector<std::pair<std::string, addr_t>> &paths, const std::vector<uint32_t> &offsets) {
+        constexpr uint32_t max_displacement = 1u << 20;
+        std::vector<std::vector<uint32_t>> buckets(displacements_.size());
+        std::vector<uint64_t> hashes(paths.size());
+        for (uint32_t i = 0; i < paths.size(); i++) {
+            hashes[i] = hash(paths[i].first);
+            buckets[bucket(hashes[i])].push_back(i);
+        }
+        std::vector<uint32_t> order(buckets.size());
+        for (uint32_t b = 0; b < order.size(); b++) {
+            order[b] = b;
+        }
+        // the largest buckets first, while the table is empty
+        std::ranges::stable_sort(order, std::greater<>(), [&](uint32_t b) { return buckets[b].size(); });
+
+        std::vector<bool> used(slots_.size(), false);
+        std::vector<size_t> taken;
+        for (const uint32_t b : order) {
+            if (buckets[b].empty())
+                break;
+            uint32_t displacement = 0;
+            for (; displacement < max_displacement; displacement++) {
+                taken.clear();
+                bool ok = true;
+                for (const uint32_t key : buckets[b]) {
+                    const size_t s = slot(hashes[key], displacement);
+                    if (used[s] || std::ranges::find(taken, s) != taken.end()) {
+                        ok = false;
+                        break;
+                    }
+                    taken.push_back(s);
+                }
+                if (ok)
+                    break;
+            }
+            if (displacement == max_displacement)
+                return false;
+            displacements_[b] = displacement;
+            for (size_t k = 0; k < taken.size(); k++) {
+                const uint32_t key = buckets[b][k];
+                used[taken[k]] = true;
+                slots_[taken[k]] = {offsets[key], uint32_t(paths[key].first.size()), paths[key].second};
+            }
+        }
+        return true;
+    }
+
+public:
+    VNameIndex() = default;
+    explicit VNameIndex(VMountBase &root, char separator = '.') {
+        Collector collector(separator);
+        root.accept(0, collector);
+        auto &paths = collector.paths_;
+        std::ranges::stable_sort(paths, {}, [](const auto &p) { return p.second; });
+        std::ranges::stable_sort(paths, {}, [](const auto &p) { return std::string_view(p.first); });
+        paths.erase(std::ranges::unique(paths, {}, [](const auto &p) { return std::string_view(p.first); }).begin(),
+                    paths.end());
+        if (paths.empty())
+            return;
+
+        std::vector<uint32_t> offsets;
+        for (const auto &[path, addr] : paths) {
+            offsets.push_back(uint32_t(names_.size()));
+            names_.append(path);
+        }
+        displacements_.resize((paths.size() + 1) / 2);
+        slots_.resize(paths.size());
+        while (!place(paths, offsets)) {
+            seed_ = mix(seed_ + 1);
+        }
+    }
+
+    size_t size() const { return slots_.size(); }
+
+    std::optional<addr_t> find(std::string_view path) const {
+        if (slots_.empty())
+            return std::nullopt;
+        const uint64_t h = hash(path);
+        const Slot &found = slots_[slot(h, displacements_[bucket(h)])];
+        if (std::string_view(names_).substr(found.offset, found.length) != path)
+            return std::nullopt;
+        return found.addr;
+    }
+};
+
+}; // namespace vreg::impl
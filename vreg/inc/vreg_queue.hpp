@@ -0,0 +1,160 @@
+#pragma once
+#include "vreg_base.hpp"
+#include "vreg_index.hpp"
+#include "vregex_ring.hpp"
+
+namespace vreg::impl {
+using base::size_opt, base::addr_t;
+using base::VMountBase, base::VBitmap;
+
+enum class VOp : uint8_t { read, write };
+
+// NOTE: register access deferred to a worker. payloads are inline, so posting never allocates.
+struct VRequest {
+    static constexpr size_t payload_size = 8;
+    uint32_t tag; // echoed in the completion
+    addr_t addr;
+    VOp op;
+    uint8_t size; // write: payload bytes, read: requested bytes
+    std::endian endian;
+    std::array<std::byte, payload_size> payload;
+};
+
+struct VCompletion {
+    uint32_t tag;
+    addr_t addr;
+    VOp op;
+    bool ok;
+    uint8_t size; // transferred bytes
+    std::array<std::byte, VRequest::payload_size> payload;
+};
+
+// NOTE: lock-free request ring (many producers) in front of a mount, and a completion ring back (one consumer).
+// producers may post from any thread, one worker drains and applies them in batches.
+// in a batch, runs of requests with the same op and endian to consecutive registers whose storage has the requested
+// size are applied by one readRange/writeRange, so the mount resolves the address once per run.
+// the storage sizes are taken by prepare(mount), without them every request is applied on its own.
+template <size_t N = 256> class VRequestQueue {
+    vregex::mpsc_ring<VRequest, N> requests_;
+    vregex::spsc_ring<VCompletion, N> completions_;
+    // worker side, storage sizes of the prepared mount
+    std::vector<VLeafStorage> storage_;
+
+public:
+    static constexpr size_t batch = 32;
+
+    // producer side: false when the ring is full
+    bool post(const VRequest &request) { return requests_.push(request); }
+    bool postRead(uint32_t tag, addr_t addr, size_t size = VRequest::payload_size,
+                  std::endian endian = std::endian::native) {
+        if (size > VRequest::payload_size)
+            return false;
+        return post({tag, addr, VOp::read, uint8_t(size), endian, {}});
+    }
+    bool postWrite(uint32_t tag, addr_t addr, std::span<const std::byte> bytes,
+                   std::endian endian = std::endian::native) {
+        if (bytes.size() > VRequest::payload_size)
+            return false;
+        VRequest request{tag, addr, VOp::write, uint8_t(bytes.size()), endian, {}};
+        std::ranges::copy(bytes, request.payload.begin());
+        return post(request);
+    }
+
+    // worker side: collects the storage sizes of the mount drained next (leafStorage), so runs can be merged.
+    // NOTE: the sizes belong to that mount. prepare again, or invalidate(), before draining another mount or after
+    // its registers changed, otherwise runs are merged by stale sizes.
+    void prepare(VMountBase &mount) { storage_ = leafStorage(mount); }
+    void invalidate() { storage_.clear(); }
+
+    // worker side: apply up to max requests, returns the applied count.
+    // NOTE: requests stay queued while the completion ring has no room. mount is the prepared one, if any.
+    size_t drain(VMountBase &mount, size_t max = N) {
+        std::array<VRequest, batch> requests;
+        std::array<VCompletion, batch> completions;
+        size_t done = 0;
+        while (done < max) {
+            const size_t room = N - completions_.size();
+            const size_t n = requests_.pop(std::span(requests).first(std::min({batch, max - done, room})));
+            if (n == 0)
+                break;
+            for (size_t i = 0; i < n;) {
+                const auto pending = std::span(requests).subspan(i, n - i);
+                const size_t run = runOf(pending);
+                i += run > 1 ? applyRun(mount, pending.first(run), std::span(completions).subspan(i))
+                             : (completions[i] = apply(mount, requests[i]), 1);
+            }
+            completions_.push(std::span(completions).first(n));
+            done += n;
+        }
+        return done;
+    }
+
+    // completion side
+    size_t poll(std::span<VCompletion> completions) { return completions_.pop(completions); }
+    bool poll(VCompletion &completion) { return completions_.pop(completion); }
+
+    size_t pending() const { return requests_.size(); }
+
+private:
+    // requests at the front that can go in one range access
+    size_t runOf(std::span<const VRequest> requests) const {
+        const VRequest &first = requests.front();
+        const auto it = std::ranges::lower_bound(storage_, first.addr, {}, &VLeafStorage::addr);
+        size_t run = 0;
+        while (run < requests.size() && it + run < storage_.end()) {
+            const VRequest &request = requests[run];
+            const VLeafStorage &leaf = it[run];
+            if (request.op != first.op || request.endian != first.endian || request.size != first.size ||
+                request.addr != first.addr + run || leaf.addr != request.addr || leaf.size != request.size)
+                break;
+            run++;
+        }
+        return std::max<size_t>(run, 1);
+    }
+
+    // returns the requests completed, a write run stops after its first failure
+    static size_t applyRun(VMountBase &mount, std::span<const VRequest> run, std::span<VCompletion> completions) {
+        const VRequest &first = run.front();
+        const size_t size = first.size;
+        std::array<std::byte, batch * VRequest::payload_size> buffer;
+        std::array<uint64_t, VBitmap::words(batch)> words{};
+        const VBitmap status(words);
+        size_t count = run.size();
+        if (first.op == VOp::read) {
+            mount.readRange(first.addr, count, std::span(buffer).first(count * size), status, first.endian);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                std::ranges::copy(std::span(run[i].payload).first(size), buffer.begin() + i * size);
+            }
+            const size_t written =
+                mount.writeRange(first.addr, count, std::span(buffer).first(count * size), status, first.endian).count;
+            count = std::min(written + 1, count);
+        }
+        size_t offset = 0; // failed reads take no bytes
+        for (size_t i = 0; i < count; i++) {
+            const bool ok = status.test(i);
+            VCompletion &completion = completions[i];
+            completion = {run[i].tag, run[i].addr, first.op, ok, uint8_t(ok ? size : 0), {}};
+            if (ok && first.op == VOp::read) {
+                std::ranges::copy(std::span(buffer).subspan(offset, size), completion.payload.begin());
+                offset += size;
+            }
+        }
+        return count;
+    }
+
+    static VCompletion apply(VMountBase &mount, const VRequest &request) {
+        VCompletion completion{request.tag, request.addr, request.op, false, 0, {}};
+        size_opt result;
+        if (request.op == VOp::read) {
+            result = mount.readAt(request.addr, std::span(completion.payload).first(request.size), request.endian);
+        } else {
+            result = mount.writeAt(request.addr, std::span(request.payload).first(request.size), request.endian);
+        }
+        completion.ok = result.has_value();
+        completion.size = uint8_t(result.value_or(0));
+        return completion;
+    }
+};
+
+}; // namespace vreg::impl
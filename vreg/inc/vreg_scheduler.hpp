@@ -0,0 +1,189 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include <chrono>
+#include <thread>
+
+namespace vreg::impl {
+
+// packed values of one subscription, in subscription order
+struct VFrame {
+    uint32_t id;     // subscription
+    uint64_t tick;   // when it was read
+    uint32_t failed; // registers that could not be read, they take no bytes
+    std::span<const std::byte> bytes;
+};
+
+// NOTE: cyclic publisher, e.g. CAN broadcasts of register groups every 1, 10 and 100 ms.
+// subscriptions (addresses, period, phase in ticks) sit in a hierarchical timer wheel, so a tick only touches
+// the subscriptions that are due. every tick reads all due groups in one pass (consecutive addresses as
+// readRange) into one buffer and hands the frames to sink(std::span<const VFrame>) at once.
+// buffers are sized at subscribe, tick() does not allocate. the sink must not subscribe.
+template <class Sink> class VScheduler {
+public:
+    using clock = std::chrono::steady_clock;
+    static constexpr size_t slot_bits = 6, slots = size_t(1) << slot_bits, levels = 4;
+    static constexpr uint32_t npos = ~uint32_t(0);
+    static constexpr uint32_t unsized_reserve = 8; // frame bytes for a register without a known size
+
+private:
+    struct Run {
+        addr_t addr;
+        uint32_t count;
+    };
+    struct Sub {
+        uint64_t period, expires;
+        uint32_t first_run, runs; // in runs_
+        uint32_t registers;
+        uint32_t frame_size;
+        uint32_t next = npos; // in the same wheel slot
+        bool active = true;
+    };
+
+    VMountBase &mount_;
+    std::vector<VLeafSize> sizes_; // of every register, collected by the first subscribe
+    Sink sink_;
+    std::endian endian_;
+    uint64_t now_ = 0;
+    std::array<std::array<uint32_t, slots>, levels> wheel_;
+    std::vector<Sub> subs_;
+    std::vector<Run> runs_;
+    // per tick, sized for every subscription due at once
+    std::vector<uint32_t> due_;
+    std::vector<VFrame> frames_;
+    std::vector<std::byte> buffer_;
+    std::vector<uint64_t> status_;
+
+    void insert(uint32_t index) {
+        Sub &sub = subs_[index];
+        size_t level = 0;
+        while (level + 1 < levels && (sub.expires >> (slot_bits * level)) - (now_ >> (slot_bits * level)) >= slots) {
+            level++;
+        }
+        // further than the top level reaches: parked in its last slot and placed again on the cascade
+        const uint64_t top = (now_ >> (slot_bits * level)) + slots - 1;
+        const uint64_t at = std::min(sub.expires >> (slot_bits * level), top);
+        uint32_t &head = wheel_[level][at % slots];
+        sub.next = head;
+        head = index;
+    }
+    void cascade(size_t level) {
+        uint32_t &head = wheel_[level][(now_ >> (slot_bits * level)) % slots];
+        for (uint32_t index = std::exchange(head, npos); index != npos;) {
+            const uint32_t next = subs_[index].next;
+            insert(index);
+            index = next;
+        }
+    }
+
+public:
+    VScheduler(VMountBase &mount, Sink sink, std::endian endian = std::endian::native)
+        : mount_(mount), sink_(std::move(sink)), endian_(endian) {
+        for (auto &level : wheel_) {
+            level.fill(npos);
+        }
+    }
+    VScheduler(const VScheduler &) = delete;
+
+    // NOTE: addrs are published in the given order. the frame is sized from leafSizes, nothing is read before the
+    // first tick. registers without a known size (callbacks) get unsized_reserve bytes, registers that cannot be
+    // read (or need more) take no bytes and are counted in VFrame::failed.
+    // the first publication is the next tick t with t % period == phase % period.
+    uint32_t subscribe(std::span<const addr_t> addrs, uint64_t period, uint64_t phase = 0) {
+        assert(period > 0);
+        Sub sub{period, 0, uint32_t(runs_.size()), 0, uint32_t(addrs.size()), 0};
+        if (sizes_.empty()) {
+            sizes_ = leafSizes(mount_);
+        }
+        for (const addr_t addr : addrs) {
+            if (sub.runs > 0 && runs_.back().addr + runs_.back().count == addr) {
+                runs_.back().count++;
+            } else {
+                runs_.push_back({addr, 1});
+                sub.runs++;
+            }
+            const auto leaf = std::ranges::lower_bound(sizes_, addr, {}, &VLeafSize::addr);
+            if (leaf != sizes_.end() && leaf->addr == addr) {
+                sub.frame_size += leaf->size > 0 ? leaf->size : unsized_reserve;
+            }
+        }
+        const uint64_t first = now_ + 1;
+        sub.expires = first + (phase % period + period - first % period) % period;
+
+        const uint32_t index = uint32_t(subs_.size());
+        subs_.push_back(sub);
+        due_.reserve(subs_.size());
+        frames_.reserve(subs_.size());
+        buffer_.resize(buffer_.size() + sub.frame_size);
+        size_t registers = 0;
+        for (const auto &s : subs_) {
+            registers += s.registers;
+        }
+        status_.resize(VBitmap::words(registers));
+        insert(index);
+        return index;
+    }
+    // stops publishing, the slot is not reused
+    void unsubscribe(uint32_t id) { subs_.at(id).active = false; }
+
+    uint64_t now() const { return now_; }
+    size_t subscriptions() const { return subs_.size(); }
+
+    // advances one tick, returns the published frames
+    size_t tick() {
+        now_++;
+        for (size_t level = 1; level < levels && now_ % (uint64_t(1) << (slot_bits * level)) == 0; level++) {
+            cascade(level);
+        }
+        due_.clear();
+        uint32_t &head = wheel_[0][now_ % slots];
+        for (uint32_t index = std::exchange(head, npos); index != npos;) {
+            const uint32_t next = subs_[index].next;
+            if (subs_[index].active) {
+                due_.push_back(index);
+            }
+            index = next;
+        }
+        if (due_.empty())
+            return 0;
+        std::ranges::sort(due_); // frames in subscription order
+
+        // one pass over every due register
+        frames_.clear();
+        size_t used = 0, bit = 0;
+        for (const uint32_t index : due_) {
+            Sub &sub = subs_[index];
+            const auto frame = std::span(buffer_).subspan(used, sub.frame_size);
+            const VBitmap status(status_, bit);
+            size_t size = 0, offset = 0;
+            for (const auto &run : std::span(runs_).subspan(sub.first_run, sub.runs)) {
+                size += mount_.readRange(run.addr, run.count, frame.subspan(size), status.sub(offset), endian_)
+                            .bytes;
+                offset += run.count;
+            }
+            frames_.push_back({index, now_, uint32_t(sub.registers - status.count(sub.registers)),
+                               frame.first(size)});
+            used += sub.frame_size, bit += sub.registers;
+            sub.expires += sub.period;
+            insert(index);
+        }
+        sink_(std::span<const VFrame>(frames_));
+        return frames_.size();
+    }
+    void advance(uint64_t ticks) {
+        for (uint64_t i = 0; i < ticks; i++) {
+            tick();
+        }
+    }
+
+    // NOTE: ticks on the wall clock until stop is set. deadlines do not drift, late ticks run at once.
+    void run(clock::duration period, const std::atomic<bool> &stop) {
+        clock::time_point deadline = clock::now();
+        while (!stop.load(std::memory_order_relaxed)) {
+            deadline += period;
+            std::this_thread::sleep_until(deadline);
+            tick();
+        }
+    }
+};
+
+}; // namespace vreg::impl
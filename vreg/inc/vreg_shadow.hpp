@@ -0,0 +1,330 @@
+#pragma once
+#include "vreg_impl.hpp"
+
+namespace vreg::impl {
+using base::VMountBasePtr;
+
+// NOTE: write any value to commit the bank, read the number of commits
+template <class Bank> class VCommitReg : public VRegBase {
+    Bank &bank_;
+
+public:
+    VCommitReg(Bank &bank, std::string_view name, std::string_view desc = "") : VRegBase(name, desc), bank_(bank) {}
+    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) override {
+        (void)endian;
+        if (bytes.empty())
+            return std::nullopt;
+        if constexpr (std::is_void_v<decltype(bank_.commit())>) {
+            bank_.commit();
+            return 1;
+        } else {
+            return bank_.commit() == 0 ? size_opt(1) : std::nullopt; // some staged write failed
+        }
+    }
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        uint32_t commits = uint32_t(bank_.commits());
+        return detail::loadStorage<uint32_t>(&commits, bytes, endian);
+    }
+    virtual size_t valueSize() override { return sizeof(uint32_t); }
+};
+
+// NOTE: registers that must change together (gain sets, multi-register setpoints).
+// writes go to the staging copy, commit() publishes all of them at once into one of two buffers.
+// readers (e.g. the control loop) load() the last published set lock free and never see half an update.
+// one writer thread stages and commits, any number of threads load.
+template <class T>
+    requires std::is_trivially_copyable_v<T>
+class VShadowBank {
+    static constexpr size_t words_ = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    T staging_;
+    // odd while commit (epoch + 1) / 2 writes its buffer, the published buffer is (epoch / 2) % 2
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<uint64_t> buffers_[2][words_];
+
+    void store(std::atomic<uint64_t> (&buffer)[words_], const T &value) {
+        uint64_t words[words_]{};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < words_; i++) {
+            buffer[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+public:
+    using CommitReg = VCommitReg<VShadowBank>;
+
+    explicit VShadowBank(const T &initial = T{}) : staging_(initial) {
+        store(buffers_[0], initial);
+        store(buffers_[1], initial);
+    }
+    VShadowBank(const VShadowBank &) = delete;
+    VShadowBank &operator=(const VShadowBank &) = delete;
+
+    // writer side, bind registers to its fields
+    T &staging() { return staging_; }
+    const T &staging() const { return staging_; }
+
+    void commit() {
+        const uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+        epoch_.store(epoch + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store(buffers_[(epoch / 2 + 1) % 2], staging_);
+        epoch_.store(epoch + 2, std::memory_order_release);
+    }
+    // staging back to the published values
+    void rollback() { staging_ = load(); }
+
+    uint64_t commits() const { return epoch_.load(std::memory_order_acquire) / 2; }
+
+    // reader side. retries only when two commits overtook the copy.
+    T load() const {
+        uint64_t words[words_];
+        while (true) {
+            const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+            const auto &buffer = buffers_[(epoch / 2) % 2];
+            for (size_t i = 0; i < words_; i++) {
+                words[i] = buffer[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // the buffer is written again by the commit that makes the epoch odd after the next one
+            if (epoch_.load(std::memory_order_relaxed) < epoch / 2 * 2 + 3)
+                break;
+        }
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    std::shared_ptr<CommitReg> commitReg(std::string_view name = "commit", std::string_view desc = "") {
+        return std::make_shared<CommitReg>(*this, name, desc);
+    }
+};
+
+// NOTE: shadow mode for a VRange/VMap. writeAt stages the value, commit() writes the staged registers to the
+// target in address order and publishes a copy of the map into one of two buffers selected by an epoch.
+// readAt/readRange serve the last published copy lock free, a readRange over a register group never mixes two
+// commits. the copy holds both endians, so reads do not touch the target.
+// every register is captured once per commit. registers with storage are copied from memory in both endians,
+// others are read once in the native endian and reads in the other byte order are forwarded to the target.
+// sizes come from leafSizes, a register without a known size (callbacks) is read once at construction to learn it,
+// registers that cannot be read are written through at once.
+// values changed behind the mount are published when their register is committed again.
+// one writer thread stages and commits, any number of threads read.
+class VShadowMount : public VMountBase {
+    struct Entry {
+        addr_t addr;
+        uint32_t offset; // in staging_ and in each half of image_
+        uint32_t size;   // 0 when not readable
+        const std::byte *storage = nullptr;
+        VRegThunk::read_fn convert = nullptr; // with storage: fills the swapped half
+        std::endian endian = std::endian::native;
+        bool staged = false;
+    };
+    static constexpr size_t max_unsized = size_t(1) << 16; // largest register of unknown size
+    static constexpr std::endian swapped_ =
+        std::endian::native == std::endian::little ? std::endian::big : std::endian::little;
+
+    VMountBasePtr target_;
+    std::vector<Entry> entries_; // sorted by address
+    VAddrIndex index_;
+    std::vector<std::byte> staging_; // as written
+    size_t data_size_ = 0, words_ = 0;
+    std::vector<std::byte> image_; // writer side copy: native values, then swapped values
+    // odd while commit (epoch + 1) / 2 writes its buffer, the published buffer is (epoch / 2) % 2
+    std::atomic<uint64_t> epoch_{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> buffers_; // 2 * words_
+
+    Entry *locate(addr_t addr) {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos ? &entries_[index] : nullptr;
+    }
+    void capture(const Entry &entry) {
+        const auto native = std::span(image_).subspan(entry.offset, entry.size);
+        if (!entry.storage) {
+            target_->readAt(entry.addr, native);
+            return;
+        }
+        memcpy(native.data(), entry.storage, entry.size);
+        entry.convert(const_cast<std::byte *>(entry.storage),
+                      std::span(image_).subspan(data_size_ + entry.offset, entry.size), swapped_);
+    }
+    // the swapped half holds only registers with storage
+    bool forwarded(const Entry &entry, std::endian endian) const {
+        return endian != std::endian::native && entry.size > 0 && !entry.storage;
+    }
+    void store(std::atomic<uint64_t> *buffer) {
+        for (size_t i = 0; i < words_; i++) {
+            uint64_t word;
+            memcpy(&word, image_.data() + i * sizeof(word), sizeof(word));
+            buffer[i].store(word, std::memory_order_relaxed);
+        }
+    }
+    // bytes [offset, offset + out.size()) of buffer
+    static void copy(const std::atomic<uint64_t> *buffer, size_t offset, std::span<std::byte> out) {
+        for (size_t i = 0; i < out.size();) {
+            const size_t at = offset + i, n = std::min(sizeof(uint64_t) - at % sizeof(uint64_t), out.size() - i);
+            const uint64_t word = buffer[at / sizeof(uint64_t)].load(std::memory_order_relaxed);
+            memcpy(out.data() + i, reinterpret_cast<const std::byte *>(&word) + at % sizeof(uint64_t), n);
+            i += n;
+        }
+    }
+    // runs read(buffer) until no commit overtook it
+    template <class F> void load(F &&read) const {
+        while (true) {
+            const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+            read(buffers_.get() + (epoch / 2) % 2 * words_);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // the buffer is written again by the commit that makes the epoch odd after the next one
+            if (epoch_.load(std::memory_order_relaxed) < epoch / 2 * 2 + 3)
+                return;
+        }
+    }
+    size_opt copyAt(const std::atomic<uint64_t> *buffer, addr_t addr, std::span<std::byte> bytes,
+                    std::endian endian) const {
+        const uint32_t index = index_.find(addr);
+        if (index == VAddrIndex::npos)
+            return std::nullopt;
+        const Entry &entry = entries_[index];
+        if (entry.size == 0 || bytes.size() < entry.size)
+            return std::nullopt;
+        copy(buffer, (endian == std::endian::native ? 0 : data_size_) + entry.offset, bytes.first(entry.size));
+        return entry.size;
+    }
+
+public:
+    explicit VShadowMount(VMountBasePtr target)
+        : VMountBase(target->name_, target->desc_), target_(std::move(target)) {
+        std::vector<VAddrIndex::Span> spans;
+        const std::vector<VLeafStorage> storage = leafStorage(*target_);
+        auto leaf = storage.begin();
+        std::vector<std::byte> scratch;
+        // the native half, each register read at most once
+        for (const VLeafSize &sized : leafSizes(*target_)) {
+            Entry entry{sized.addr, uint32_t(data_size_), sized.size};
+            while (leaf != storage.end() && leaf->addr < sized.addr) {
+                leaf++;
+            }
+            if (leaf != storage.end() && leaf->addr == sized.addr && leaf->size == sized.size) {
+                entry.storage = leaf->data, entry.convert = leaf->read;
+                image_.insert(image_.end(), leaf->data, leaf->data + leaf->size);
+            } else if (entry.size > 0) {
+                image_.resize(image_.size() + entry.size);
+                target_->readAt(entry.addr, std::span(image_).last(entry.size));
+            } else {
+                scratch.resize(max_unsized);
+                entry.size = uint32_t(target_->readAt(entry.addr, scratch).value_or(0));
+                image_.insert(image_.end(), scratch.begin(), scratch.begin() + entry.size);
+            }
+            entries_.push_back(entry);
+            data_size_ += entry.size;
+            spans.push_back({entry.addr, addr_t(entry.addr + 1)});
+        }
+        index_ = VAddrIndex(spans);
+        staging_.resize(data_size_);
+        words_ = (2 * data_size_ + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        image_.resize(words_ * sizeof(uint64_t));
+        for (const auto &entry : entries_) {
+            if (entry.storage) {
+                entry.convert(const_cast<std::byte *>(entry.storage),
+                              std::span(image_).subspan(data_size_ + entry.offset, entry.size), swapped_);
+            }
+        }
+        buffers_ = std::make_unique<std::atomic<uint64_t>[]>(2 * words_);
+        store(buffers_.get());
+        store(buffers_.get() + words_);
+    }
+    VShadowMount(const VShadowMount &) = delete;
+
+    VMountBase &target() const { return *target_; }
+    virtual size_t size() const override { return target_->size(); }
+    size_t registers() const { return entries_.size(); }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        Entry *entry = locate(addr);
+        if (!entry)
+            return std::nullopt;
+        if (entry->size == 0)
+            return target_->writeAt(addr, bytes, endian);
+        if (bytes.size() < entry->size)
+            return std::nullopt;
+        std::ranges::copy(bytes.first(entry->size), staging_.begin() + entry->offset);
+        entry->endian = endian;
+        entry->staged = true;
+        return entry->size;
+    }
+    // NOTE: only registers written through reach the target, staging and reads complete at once
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        const Entry *entry = locate(addr);
+        if (entry && entry->size == 0)
+            return target_->writeAtAsync(addr, bytes, endian);
+        return readyTask(writeAt(addr, bytes, endian));
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        if (const Entry *entry = locate(addr); entry && forwarded(*entry, endian))
+            return target_->readAt(addr, bytes, endian);
+        size_opt result;
+        load([&](const std::atomic<uint64_t> *buffer) { result = copyAt(buffer, addr, bytes, endian); });
+        return result;
+    }
+    // NOTE: all registers of the range come from the same commit, unless a register without storage is read in the
+    // other byte order: then each register is read on its own and those go to the target.
+    virtual range_result readRange(addr_t addr, size_t count, std::span<std::byte> bytes, VBitmap status = {},
+                                   std::endian endian = std::endian::native) override {
+        for (size_t i = 0; endian != std::endian::native && i < count; i++) {
+            if (const Entry *entry = locate(addr_t(addr + i)); entry && forwarded(*entry, endian))
+                return VMountBase::readRange(addr, count, bytes, status, endian);
+        }
+        size_t used = 0;
+        load([&](const std::atomic<uint64_t> *buffer) {
+            used = 0;
+            for (size_t i = 0; i < count; i++) {
+                const size_opt result = copyAt(buffer, addr_t(addr + i), bytes.subspan(used), endian);
+                status.set(i, result.has_value());
+                used += result.value_or(0);
+            }
+        });
+        return {count, used};
+    }
+
+    bool staged(addr_t addr) const {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos && entries_[index].staged;
+    }
+    // drops the staged writes
+    void rollback() {
+        for (auto &entry : entries_) {
+            entry.staged = false;
+        }
+    }
+
+    // writes the staged registers and publishes them at once, returns the number of failed writes
+    // (e.g. read-only registers). the values read back from the target are published either way.
+    size_t commit() {
+        size_t failed = 0;
+        for (auto &entry : entries_) {
+            if (!entry.staged)
+                continue;
+            entry.staged = false;
+            const auto value = std::span(staging_).subspan(entry.offset, entry.size);
+            failed += !target_->writeAt(entry.addr, value, entry.endian);
+            capture(entry);
+        }
+        const uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+        epoch_.store(epoch + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store(buffers_.get() + (epoch / 2 + 1) % 2 * words_);
+        epoch_.store(epoch + 2, std::memory_order_release);
+        return failed;
+    }
+    uint64_t commits() const { return epoch_.load(std::memory_order_acquire) / 2; }
+
+    std::shared_ptr<VCommitReg<VShadowMount>> commitReg(std::string_view name = "commit",
+                                                        std::string_view desc = "") {
+        return std::make_shared<VCommitReg<VShadowMount>>(*this, name, desc);
+    }
+};
+
+}; // namespace vreg::impl
@@ -0,0 +1,174 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include "vreg_queue.hpp"
+#include <thread>
+
+namespace vreg::impl {
+
+// NOTE: serves a VMap from several worker threads. the top level mounts are split into contiguous shards,
+// each owned by one worker, so mounts never see concurrent access and need no locks.
+// producers (CAN, UART, ...) post from any thread, requests are routed to the owning shard's lock-free queue.
+// one thread polls the completions, replies arrive in batches per shard and in order within a shard.
+// an idle worker yields spin_limit times, then blocks until a request is posted to its shard.
+// the map must not be accessed directly while the server runs.
+template <size_t N = 256> class VShardServer {
+public:
+    static constexpr size_t spin_limit = 64;
+
+private:
+    struct Shard {
+        VMap map;
+        VRequestQueue<N> queue;
+        std::atomic<uint32_t> wake{0}; // bumped to wake the sleeping worker
+        std::atomic<bool> sleeping{false};
+        std::thread worker;
+        Shard(std::vector<VMap::pair> &&entries, std::string_view name) : map(std::move(entries), name) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<uint32_t> routes_; // shard of each index span
+    VAddrIndex index_;
+    std::atomic<bool> running_{false};
+    size_t next_ = 0; // first shard to poll
+
+    void work(Shard &shard) {
+        size_t idle = 0;
+        while (running_.load(std::memory_order_relaxed)) {
+            if (shard.queue.drain(shard.map) > 0) {
+                idle = 0;
+                continue;
+            }
+            if (idle++ < spin_limit) {
+                std::this_thread::yield();
+                continue;
+            }
+            idle = 0;
+            const uint32_t wake = shard.wake.load(std::memory_order_acquire);
+            shard.sleeping.store(true, std::memory_order_relaxed);
+            // pairs with the fence in notify: either the producer sees sleeping or this sees its request
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (shard.queue.pending() == 0 && running_.load(std::memory_order_relaxed)) {
+                shard.wake.wait(wake, std::memory_order_acquire);
+            }
+            shard.sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+    static void wakeUp(Shard &shard) {
+        shard.wake.fetch_add(1, std::memory_order_release);
+        shard.wake.notify_one();
+    }
+    static bool notify(Shard &shard, bool posted) {
+        if (posted) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (shard.sleeping.load(std::memory_order_relaxed)) {
+                wakeUp(shard);
+            }
+        }
+        return posted;
+    }
+
+public:
+    // shards are balanced by mount count
+    VShardServer(const VMap &map, size_t shards) {
+        std::vector<VMap::pair> entries;
+        for (const auto &entry : map.entries()) {
+            if (entry.second && entry.second->size() > 0) {
+                entries.push_back(entry);
+            }
+        }
+        shards = std::clamp<size_t>(shards, 1, std::max<size_t>(entries.size(), 1));
+        std::vector<VAddrIndex::Span> spans;
+        for (size_t s = 0; s < shards; s++) {
+            const size_t begin = s * entries.size() / shards, end = (s + 1) * entries.size() / shards;
+            std::vector<VMap::pair> owned(entries.begin() + begin, entries.begin() + end);
+            for (const auto &[offset, mount] : owned) {
+                spans.push_back({addr_t(offset), addr_t(offset + mount->size())});
+                routes_.push_back(uint32_t(s));
+            }
+            shards_.push_back(std::make_unique<Shard>(std::move(owned), map.name_));
+            // the shard owns its map, the sizes stay valid as long as the queue
+            shards_.back()->queue.prepare(shards_.back()->map);
+        }
+        index_ = VAddrIndex(spans);
+    }
+    VShardServer(const VShardServer &) = delete;
+    ~VShardServer() { stop(); }
+
+    size_t shards() const { return shards_.size(); }
+    // unmapped addresses go to shard 0, which fails them
+    size_t shardOf(addr_t addr) const {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos ? routes_[index] : 0;
+    }
+    const VMap &shard(size_t index) const { return shards_[index]->map; }
+
+    void start() {
+        if (running_.exchange(true))
+            return;
+        for (auto &shard : shards_) {
+            shard->worker = std::thread([this, &shard = *shard] { work(shard); });
+        }
+    }
+    // requests still queued stay there until the next start()
+    void stop() {
+        if (!running_.exchange(false))
+            return;
+        for (auto &shard : shards_) {
+            wakeUp(*shard);
+            shard->worker.join();
+        }
+    }
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+    // workers blocked (or about to block) waiting for a request
+    size_t parked() const {
+        size_t n = 0;
+        for (const auto &shard : shards_) {
+            n += shard->sleeping.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    // producer side: false when the shard's ring is full
+    bool post(const VRequest &request) {
+        Shard &shard = *shards_[shardOf(request.addr)];
+        return notify(shard, shard.queue.post(request));
+    }
+    bool postRead(uint32_t tag, addr_t addr, size_t size = VRequest::payload_size,
+                  std::endian endian = std::endian::native) {
+        Shard &shard = *shards_[shardOf(addr)];
+        return notify(shard, shard.queue.postRead(tag, addr, size, endian));
+    }
+    bool postWrite(uint32_t tag, addr_t addr, std::span<const std::byte> bytes,
+                   std::endian endian = std::endian::native) {
+        Shard &shard = *shards_[shardOf(addr)];
+        return notify(shard, shard.queue.postWrite(tag, addr, bytes, endian));
+    }
+
+    // completion side (one thread): fills completions from the shards in turn
+    size_t poll(std::span<VCompletion> completions) {
+        size_t n = 0;
+        for (size_t i = 0; i < shards_.size() && n < completions.size(); i++) {
+            n += shards_[(next_ + i) % shards_.size()]->queue.poll(completions.subspan(n));
+        }
+        next_ = (next_ + 1) % shards_.size();
+        return n;
+    }
+
+    // without workers, e.g. from a single threaded main loop
+    size_t drain() {
+        size_t done = 0;
+        for (auto &shard : shards_) {
+            done += shard->queue.drain(shard->map);
+        }
+        return done;
+    }
+    size_t pending() const {
+        size_t n = 0;
+        for (const auto &shard : shards_) {
+            n += shard->queue.pending();
+        }
+        return n;
+    }
+};
+
+}; // namespace vreg::impl
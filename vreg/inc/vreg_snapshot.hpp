@@ -0,0 +1,122 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include "vregex_mmap.hpp"
+
+namespace vreg::impl {
+
+// NOTE: whole-map snapshot into one packed image, [Header][register data...] in layout order.
+// the layout (offset and size per register) is computed once, so capture and restore are single passes.
+// the image is in the native endian of the writer and is restored with that endian on any host.
+class VSnapshot {
+public:
+    struct Entry {
+        addr_t addr;
+        uint32_t offset; // from the start of the data
+        uint32_t size;
+    };
+    struct Header {
+        std::array<char, 4> magic;
+        uint8_t version;
+        uint8_t big_endian;
+        uint16_t reserved;
+        uint32_t count;     // registers
+        uint32_t data_size; // bytes after the header
+        uint64_t layout;    // hash of the layout, images of other maps are rejected
+    };
+    static_assert(sizeof(Header) == 24);
+    static constexpr std::array<char, 4> magic = {'V', 'R', 'S', 'N'};
+    static constexpr uint8_t version = 1;
+
+private:
+    VMountBase &mount_;
+    std::vector<Entry> entries_;
+    uint32_t data_size_ = 0;
+    uint64_t layout_ = 0;
+
+    static uint64_t hash(uint64_t seed, uint32_t value) {
+        char bytes[sizeof(value)];
+        for (size_t i = 0; i < sizeof(value); i++) {
+            bytes[i] = char(value >> (8 * i)); // little endian, the same on every host
+        }
+        return vregex::fnv1a(std::string_view(bytes, sizeof(bytes)), seed);
+    }
+
+    Header header() const {
+        return {magic, version, std::endian::native == std::endian::big, 0, uint32_t(entries_.size()), data_size_,
+                layout_};
+    }
+
+public:
+    // NOTE: the mount must outlive the snapshot. the layout is the registers with a known size (leafSizes), no
+    // register is read to build it. callbacks and registers behind opaque mounts are not part of the image.
+    explicit VSnapshot(VMountBase &mount) : mount_(mount) {
+        uint64_t layout = vregex::fnv1a("");
+        for (const VLeafSize &leaf : leafSizes(mount)) {
+            if (leaf.size == 0)
+                continue;
+            entries_.push_back({leaf.addr, data_size_, leaf.size});
+            data_size_ += leaf.size;
+            layout = hash(hash(layout, leaf.addr), leaf.size);
+        }
+        layout_ = layout;
+    }
+
+    std::span<const Entry> layout() const { return entries_; }
+    size_t imageSize() const { return sizeof(Header) + data_size_; }
+
+    // returns the image size, or nullopt when image is too small or a register changed its size
+    size_opt capture(std::span<std::byte> image) const {
+        if (image.size() < imageSize())
+            return std::nullopt;
+        const Header h = header();
+        memcpy(image.data(), &h, sizeof(h));
+        const auto data = image.subspan(sizeof(Header));
+        for (const auto &entry : entries_) {
+            if (mount_.readAt(entry.addr, data.subspan(entry.offset, entry.size)) != entry.size)
+                return std::nullopt;
+        }
+        return imageSize();
+    }
+
+    // one writeAt per register. returns the number of written registers (read-only ones are skipped),
+    // or nullopt when the image does not belong to this layout.
+    size_opt restore(std::span<const std::byte> image) {
+        if (image.size() < sizeof(Header))
+            return std::nullopt;
+        Header h;
+        memcpy(&h, image.data(), sizeof(h));
+        const bool swapped = bool(h.big_endian) != (std::endian::native == std::endian::big);
+        if (swapped) {
+            h.count = vregex::byteswap(h.count);
+            h.data_size = vregex::byteswap(h.data_size);
+            h.layout = vregex::byteswap(h.layout);
+        }
+        if (h.magic != magic || h.version != version || h.layout != layout_ || h.count != entries_.size() ||
+            h.data_size != data_size_ || image.size() < imageSize())
+            return std::nullopt;
+        const std::endian endian = h.big_endian ? std::endian::big : std::endian::little;
+        const auto data = image.subspan(sizeof(Header));
+        size_t written = 0;
+        for (const auto &entry : entries_) {
+            written += mount_.writeAt(entry.addr, data.subspan(entry.offset, entry.size), endian).has_value();
+        }
+        return written;
+    }
+
+#ifdef VREGEX_HAS_MMAP
+    // NOTE: the image is captured straight into the mapped file and restored straight from it
+    size_opt save(const char *path) const {
+        auto file = vregex::mapped_file::create(path, imageSize());
+        if (!file)
+            return std::nullopt;
+        const size_opt result = capture(file->writable());
+        return result && file->sync() ? result : std::nullopt;
+    }
+    size_opt load(const char *path) {
+        const auto file = vregex::mapped_file::open(path);
+        return file ? restore(file->bytes()) : std::nullopt;
+    }
+#endif
+};
+
+}; // namespace vreg::impl
@@ -0,0 +1,285 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include <array>
+#include <tuple>
+#include <utility>
+
+// NOTE: compile-time register map.
+// Every register is held by value and called through its concrete type (no vtable, no heap).
+namespace vreg::statics {
+using base::size_opt, base::addr_t;
+using base::VRegBase;
+
+template <class M>
+concept static_mount = requires(M &mount, addr_t addr, std::span<std::byte> bytes, std::endian endian) {
+    { M::extent } -> std::convertible_to<size_t>;
+    { mount.readAt(addr, bytes, endian) } -> std::same_as<size_opt>;
+};
+
+template <class M>
+concept static_entry = static_mount<M> || std::derived_from<M, VRegBase>;
+
+// unify registers (extent 1) and nested static mounts
+template <static_entry M> struct traits {
+    static constexpr size_t extent = M::extent;
+    static size_opt writeAt(M &mount, addr_t addr, std::span<const std::byte> bytes, std::endian endian) {
+        return mount.writeAt(addr, bytes, endian);
+    }
+    static size_opt readAt(M &mount, addr_t addr, std::span<std::byte> bytes, std::endian endian) {
+        return mount.readAt(addr, bytes, endian);
+    }
+    template <addr_t addr> static size_opt writeAt(M &mount, std::span<const std::byte> bytes, std::endian endian) {
+        return mount.template writeAt<addr>(bytes, endian);
+    }
+    template <addr_t addr> static size_opt readAt(M &mount, std::span<std::byte> bytes, std::endian endian) {
+        return mount.template readAt<addr>(bytes, endian);
+    }
+};
+
+template <static_entry R>
+    requires std::derived_from<R, VRegBase>
+struct traits<R> {
+    static constexpr size_t extent = 1;
+    // NOTE: qualified calls bypass the vtable
+    static size_opt writeAt(R &reg, addr_t addr, std::span<const std::byte> bytes, std::endian endian) {
+        return (addr == 0) ? reg.R::write(bytes, endian) : std::nullopt;
+    }
+    static size_opt readAt(R &reg, addr_t addr, std::span<std::byte> bytes, std::endian endian) {
+        return (addr == 0) ? reg.R::read(bytes, endian) : std::nullopt;
+    }
+    template <addr_t addr> static size_opt writeAt(R &reg, std::span<const std::byte> bytes, std::endian endian) {
+        static_assert(addr == 0, "address out of register");
+        return reg.R::write(bytes, endian);
+    }
+    template <addr_t addr> static size_opt readAt(R &reg, std::span<std::byte> bytes, std::endian endian) {
+        static_assert(addr == 0, "address out of register");
+        return reg.R::read(bytes, endian);
+    }
+};
+
+namespace detail {
+template <class Tuple, size_t I>
+size_opt writeReg(Tuple &regs, std::span<const std::byte> bytes, std::endian endian) {
+    using R = std::tuple_element_t<I, Tuple>;
+    return std::get<I>(regs).R::write(bytes, endian);
+}
+template <class Tuple, size_t I> size_opt readReg(Tuple &regs, std::span<std::byte> bytes, std::endian endian) {
+    using R = std::tuple_element_t<I, Tuple>;
+    return std::get<I>(regs).R::read(bytes, endian);
+}
+template <class Tuple, size_t... I> constexpr auto regWriters(std::index_sequence<I...>) {
+    using write_fn = size_opt (*)(Tuple &, std::span<const std::byte>, std::endian);
+    return std::array<write_fn, sizeof...(I)>{&writeReg<Tuple, I>...};
+}
+template <class Tuple, size_t... I> constexpr auto regReaders(std::index_sequence<I...>) {
+    using read_fn = size_opt (*)(Tuple &, std::span<std::byte>, std::endian);
+    return std::array<read_fn, sizeof...(I)>{&readReg<Tuple, I>...};
+}
+
+template <class Tuple, size_t I>
+size_opt writeEntry(Tuple &entries, addr_t addr, std::span<const std::byte> bytes, std::endian endian) {
+    auto &entry = std::get<I>(entries);
+    return traits<decltype(entry.mount)>::writeAt(entry.mount, addr, bytes, endian);
+}
+template <class Tuple, size_t I>
+size_opt readEntry(Tuple &entries, addr_t addr, std::span<std::byte> bytes, std::endian endian) {
+    auto &entry = std::get<I>(entries);
+    return traits<decltype(entry.mount)>::readAt(entry.mount, addr, bytes, endian);
+}
+template <class Tuple, size_t... I> constexpr auto entryWriters(std::index_sequence<I...>) {
+    using write_fn = size_opt (*)(Tuple &, addr_t, std::span<const std::byte>, std::endian);
+    return std::array<write_fn, sizeof...(I)>{&writeEntry<Tuple, I>...};
+}
+template <class Tuple, size_t... I> constexpr auto entryReaders(std::index_sequence<I...>) {
+    using read_fn = size_opt (*)(Tuple &, addr_t, std::span<std::byte>, std::endian);
+    return std::array<read_fn, sizeof...(I)>{&readEntry<Tuple, I>...};
+}
+
+struct Span {
+    addr_t begin, end;
+    size_t index;
+};
+// address spans of the entries, sorted by begin
+template <class... Entries> constexpr auto entrySpans() {
+    std::array<Span, sizeof...(Entries)> spans{Span{Entries::offset, addr_t(Entries::offset + Entries::extent), 0}...};
+    for (size_t i = 0; i < spans.size(); i++) {
+        spans[i].index = i;
+    }
+    std::ranges::sort(spans, {}, &Span::begin);
+    return spans;
+}
+template <size_t n> constexpr size_t indexOf(const std::array<Span, n> &spans, addr_t addr) {
+    for (const auto &span : spans) {
+        if (span.begin <= addr && addr < span.end)
+            return span.index;
+    }
+    return n;
+}
+
+// compile-time resolved handler of one address (index == entry count means unmapped)
+template <class Tuple, addr_t addr, size_t index>
+size_opt writeLeaf(Tuple &entries, std::span<const std::byte> bytes, std::endian endian) {
+    if constexpr (index < std::tuple_size_v<Tuple>) {
+        auto &entry = std::get<index>(entries);
+        using E = std::tuple_element_t<index, Tuple>;
+        return traits<decltype(entry.mount)>::template writeAt<addr - E::offset>(entry.mount, bytes, endian);
+    } else {
+        (void)entries, (void)bytes, (void)endian;
+        return std::nullopt;
+    }
+}
+template <class Tuple, addr_t addr, size_t index>
+size_opt readLeaf(Tuple &entries, std::span<std::byte> bytes, std::endian endian) {
+    if constexpr (index < std::tuple_size_v<Tuple>) {
+        auto &entry = std::get<index>(entries);
+        using E = std::tuple_element_t<index, Tuple>;
+        return traits<decltype(entry.mount)>::template readAt<addr - E::offset>(entry.mount, bytes, endian);
+    } else {
+        (void)entries, (void)bytes, (void)endian;
+        return std::nullopt;
+    }
+}
+template <class Tuple, auto spans, addr_t... addr> constexpr auto leafWriters(std::integer_sequence<addr_t, addr...>) {
+    using write_fn = size_opt (*)(Tuple &, std::span<const std::byte>, std::endian);
+    return std::array<write_fn, sizeof...(addr)>{&writeLeaf<Tuple, addr, indexOf(spans, addr)>...};
+}
+template <class Tuple, auto spans, addr_t... addr> constexpr auto leafReaders(std::integer_sequence<addr_t, addr...>) {
+    using read_fn = size_opt (*)(Tuple &, std::span<std::byte>, std::endian);
+    return std::array<read_fn, sizeof...(addr)>{&readLeaf<Tuple, addr, indexOf(spans, addr)>...};
+}
+
+template <size_t n> constexpr bool overlapped(const std::array<Span, n> &spans) {
+    for (size_t i = 1; i < n; i++) {
+        if (spans[i - 1].end > spans[i].begin)
+            return true;
+    }
+    return false;
+}
+} // namespace detail
+
+template <std::derived_from<VRegBase>... Regs> class StaticVRange {
+    using tuple = std::tuple<Regs...>;
+    static constexpr auto writers_ = detail::regWriters<tuple>(std::index_sequence_for<Regs...>{});
+    static constexpr auto readers_ = detail::regReaders<tuple>(std::index_sequence_for<Regs...>{});
+
+    tuple regs_;
+
+public:
+    static constexpr size_t extent = sizeof...(Regs);
+    const std::string_view name_; // for auto documentation
+    const std::string_view desc_; // for auto documentation
+
+    constexpr StaticVRange(std::string_view name, std::string_view desc, Regs... regs)
+        : regs_(std::move(regs)...), name_(name), desc_(desc) {}
+
+    constexpr size_t size() const { return extent; }
+
+    size_opt writeAt(addr_t addr, std::span<const std::byte> bytes, std::endian endian = std::endian::native) {
+        return (addr < extent) ? writers_[addr](regs_, bytes, endian) : std::nullopt;
+    }
+    size_opt readAt(addr_t addr, std::span<std::byte> bytes, std::endian endian = std::endian::native) {
+        return (addr < extent) ? readers_[addr](regs_, bytes, endian) : std::nullopt;
+    }
+    template <addr_t addr>
+    size_opt writeAt(std::span<const std::byte> bytes, std::endian endian = std::endian::native) {
+        static_assert(addr < extent, "address out of range");
+        return detail::writeReg<tuple, addr>(regs_, bytes, endian);
+    }
+    template <addr_t addr> size_opt readAt(std::span<std::byte> bytes, std::endian endian = std::endian::native) {
+        static_assert(addr < extent, "address out of range");
+        return detail::readReg<tuple, addr>(regs_, bytes, endian);
+    }
+
+    template <size_t I> auto &at() { return std::get<I>(regs_); }
+    template <size_t I> const auto &at() const { return std::get<I>(regs_); }
+};
+template <class... Regs> StaticVRange(std::string_view, std::string_view, Regs...) -> StaticVRange<Regs...>;
+
+template <addr_t Offset, static_entry M> struct StaticAt {
+    static constexpr addr_t offset = Offset;
+    static constexpr size_t extent = traits<M>::extent;
+    M mount;
+};
+
+template <addr_t offset, class M> constexpr auto mountAt(M &&mount) {
+    return StaticAt<offset, std::decay_t<M>>{std::forward<M>(mount)};
+}
+
+// NOTE: maps up to dense_limit addresses get one flattened handler per address,
+// larger maps search the sorted spans and dispatch per entry.
+template <class... Entries> class StaticVMap {
+    using tuple = std::tuple<Entries...>;
+    using Span = detail::Span;
+    static constexpr size_t count_ = sizeof...(Entries);
+    static constexpr auto spans_ = detail::entrySpans<Entries...>();
+    static_assert(!detail::overlapped(spans_), "mounts overlap");
+    static constexpr addr_t end_ = count_ ? spans_.back().end : 0;
+
+    // dense
+    static constexpr size_t dense_limit_ = 1024;
+    static constexpr bool dense_ = end_ <= dense_limit_;
+    static constexpr auto leaf_writers_ =
+        detail::leafWriters<tuple, spans_>(std::make_integer_sequence<addr_t, dense_ ? end_ : 0>{});
+    static constexpr auto leaf_readers_ =
+        detail::leafReaders<tuple, spans_>(std::make_integer_sequence<addr_t, dense_ ? end_ : 0>{});
+
+    // sparse
+    static constexpr auto writers_ = detail::entryWriters<tuple>(std::index_sequence_for<Entries...>{});
+    static constexpr auto readers_ = detail::entryReaders<tuple>(std::index_sequence_for<Entries...>{});
+
+    tuple entries_;
+
+    // the span holding addr, or nullptr
+    static constexpr const Span *find(addr_t addr) {
+        const auto iter = std::ranges::upper_bound(spans_, addr, {}, &Span::begin);
+        if (iter == spans_.begin())
+            return nullptr;
+        const Span *span = &*(iter - 1);
+        return addr < span->end ? span : nullptr;
+    }
+
+public:
+    static constexpr size_t extent = end_;
+    const std::string_view name_; // for auto documentation
+    const std::string_view desc_; // for auto documentation
+
+    constexpr StaticVMap(std::string_view name, std::string_view desc, Entries... entries)
+        : entries_(std::move(entries)...), name_(name), desc_(desc) {}
+
+    constexpr size_t size() const { return extent; }
+    static constexpr bool has(addr_t addr) { return find(addr) != nullptr; }
+
+    size_opt writeAt(addr_t addr, std::span<const std::byte> bytes, std::endian endian = std::endian::native) {
+        if constexpr (dense_) {
+            return (addr < end_) ? leaf_writers_[addr](entries_, bytes, endian) : std::nullopt;
+        } else {
+            const Span *span = find(addr);
+            return span ? writers_[span->index](entries_, addr - span->begin, bytes, endian) : std::nullopt;
+        }
+    }
+    size_opt readAt(addr_t addr, std::span<std::byte> bytes, std::endian endian = std::endian::native) {
+        if constexpr (dense_) {
+            return (addr < end_) ? leaf_readers_[addr](entries_, bytes, endian) : std::nullopt;
+        } else {
+            const Span *span = find(addr);
+            return span ? readers_[span->index](entries_, addr - span->begin, bytes, endian) : std::nullopt;
+        }
+    }
+    template <addr_t addr>
+    size_opt writeAt(std::span<const std::byte> bytes, std::endian endian = std::endian::native) {
+        constexpr size_t index = detail::indexOf(spans_, addr);
+        static_assert(index < count_, "address is not mounted");
+        return detail::writeLeaf<tuple, addr, index>(entries_, bytes, endian);
+    }
+    template <addr_t addr> size_opt readAt(std::span<std::byte> bytes, std::endian endian = std::endian::native) {
+        constexpr size_t index = detail::indexOf(spans_, addr);
+        static_assert(index < count_, "address is not mounted");
+        return detail::readLeaf<tuple, addr, index>(entries_, bytes, endian);
+    }
+
+    template <size_t I> auto &at() { return std::get<I>(entries_).mount; }
+    template <size_t I> const auto &at() const { return std::get<I>(entries_).mount; }
+};
+template <class... Entries> StaticVMap(std::string_view, std::string_view, Entries...) -> StaticVMap<Entries...>;
+
+}; // namespace vreg::statics
@@ -0,0 +1,258 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include <chrono>
+
+namespace vreg::impl {
+using base::VMountBasePtr;
+
+// NOTE: relaxed counters, concurrent accessors never wait on each other to count
+struct VAccessCounters {
+    std::atomic<uint64_t> reads{0}, writes{0}, read_failures{0}, write_failures{0};
+};
+
+struct VAccessStats {
+    uint64_t reads, writes, read_failures, write_failures;
+};
+
+// NOTE: log2 buckets of nanoseconds, bucket i holds [2^(i-1), 2^i) and the last one everything above
+struct VLatencyHistogram {
+    static constexpr size_t buckets = 32;
+    std::array<std::atomic<uint64_t>, buckets> reads{}, writes{};
+    static constexpr size_t bucket(uint64_t ns) { return std::min<size_t>(std::bit_width(ns), buckets - 1); }
+};
+
+// NOTE: per-register statistics of one mount, counters are indexed through a VAddrIndex of the register
+// addresses, so sparse maps cost per register, not per address. index registers() counts the other accesses.
+template <bool Latency = false> class VStatsTable {
+    std::vector<addr_t> addrs_; // sorted
+    VAddrIndex index_;
+    std::unique_ptr<VAccessCounters[]> counters_;
+    std::unique_ptr<VLatencyHistogram[]> histograms_;
+
+    size_t slot(addr_t addr) const {
+        const uint32_t index = index_.find(addr);
+        return index != VAddrIndex::npos ? index : addrs_.size();
+    }
+
+public:
+    static constexpr bool latency = Latency;
+
+    // addrs: sorted register addresses, e.g. from leafAddrs()
+    explicit VStatsTable(std::vector<addr_t> addrs)
+        : addrs_(std::move(addrs)), counters_(std::make_unique<VAccessCounters[]>(addrs_.size() + 1)) {
+        std::vector<VAddrIndex::Span> spans;
+        spans.reserve(addrs_.size());
+        for (const addr_t addr : addrs_) {
+            spans.push_back({addr, addr_t(addr + 1)});
+        }
+        index_ = VAddrIndex(spans);
+        if constexpr (Latency) {
+            histograms_ = std::make_unique<VLatencyHistogram[]>(addrs_.size() + 1);
+        }
+    }
+
+    size_t registers() const { return addrs_.size(); }
+    // register address of counter index i
+    addr_t addr(size_t index) const { return addrs_[index]; }
+
+    template <class F> size_opt read(addr_t addr, F &&access) { return record<false>(slot(addr), access); }
+    template <class F> size_opt write(addr_t addr, F &&access) { return record<true>(slot(addr), access); }
+    // NOTE: the same for coroutine accesses, access() returns a VTask and the latency spans its completion
+    template <class F> VTask<size_opt> readAsync(addr_t addr, F access) {
+        return recordAsync<false>(slot(addr), std::move(access));
+    }
+    template <class F> VTask<size_opt> writeAsync(addr_t addr, F access) {
+        return recordAsync<true>(slot(addr), std::move(access));
+    }
+
+    VAccessStats stats(addr_t addr) const { return load(counters_[slot(addr)]); }
+    // accesses to addresses without a register
+    VAccessStats outside() const { return load(counters_[addrs_.size()]); }
+
+    const VLatencyHistogram &histogram(addr_t addr) const
+        requires Latency
+    {
+        return histograms_[slot(addr)];
+    }
+
+    void reset() {
+        for (size_t i = 0; i <= addrs_.size(); i++) {
+            counters_[i].reads = counters_[i].writes = counters_[i].read_failures = counters_[i].write_failures = 0;
+            if constexpr (Latency) {
+                for (size_t b = 0; b < VLatencyHistogram::buckets; b++) {
+                    histograms_[i].reads[b] = histograms_[i].writes[b] = 0;
+                }
+            }
+        }
+    }
+
+    // NOTE: read-only view of the counters, address 4 * i + {reads, writes, read_failures, write_failures}
+    // for the register at addr(i). the last four registers count outside(). the table must outlive the range.
+    VRange statsRange(std::string_view name = "stats", std::string_view desc = "") const {
+        std::vector<VRegBasePtr> regs;
+        regs.reserve(4 * (addrs_.size() + 1));
+        for (size_t i = 0; i <= addrs_.size(); i++) {
+            const auto &c = counters_[i];
+            regs.push_back(std::make_shared<VRegBinder<const std::atomic<uint64_t>>>(c.reads, "reads"));
+            regs.push_back(std::make_shared<VRegBinder<const std::atomic<uint64_t>>>(c.writes, "writes"));
+            regs.push_back(std::make_shared<VRegBinder<const std::atomic<uint64_t>>>(c.read_failures, "read_failures"));
+            regs.push_back(
+                std::make_shared<VRegBinder<const std::atomic<uint64_t>>>(c.write_failures, "write_failures"));
+        }
+        return VRange(std::move(regs), name, desc);
+    }
+
+    // NOTE: address 2 * buckets * i + b for reads, + buckets for writes
+    VRange histogramRange(std::string_view name = "latency", std::string_view desc = "") const
+        requires Latency
+    {
+        constexpr size_t buckets = VLatencyHistogram::buckets;
+        std::vector<VRegBasePtr> regs;
+        regs.reserve(2 * buckets * (addrs_.size() + 1));
+        for (size_t i = 0; i <= addrs_.size(); i++) {
+            for (const auto &bucket : histograms_[i].reads) {
+                regs.push_back(std::make_shared<VRegBinder<const std::atomic<uint64_t>>>(bucket, "read_ns"));
+            }
+            for (const auto &bucket : histograms_[i].writes) {
+                regs.push_back(std::make_shared<VRegBinder<const std::atomic<uint64_t>>>(bucket, "write_ns"));
+            }
+        }
+        return VRange(std::move(regs), name, desc);
+    }
+
+private:
+    static VAccessStats load(const VAccessCounters &c) {
+        return {c.reads.load(std::memory_order_relaxed), c.writes.load(std::memory_order_relaxed),
+                c.read_failures.load(std::memory_order_relaxed), c.write_failures.load(std::memory_order_relaxed)};
+    }
+
+    static std::chrono::steady_clock::time_point begin() {
+        if constexpr (Latency) {
+            return std::chrono::steady_clock::now();
+        } else {
+            return {};
+        }
+    }
+
+    template <bool Write, class F> size_opt record(size_t index, F &access) {
+        const auto since = begin();
+        return count<Write>(index, access(), since);
+    }
+    template <bool Write, class F> VTask<size_opt> recordAsync(size_t index, F access) {
+        const auto since = begin();
+        const size_opt result = co_await access();
+        co_return count<Write>(index, result, since);
+    }
+
+    template <bool Write>
+    size_opt count(size_t index, size_opt result, [[maybe_unused]] std::chrono::steady_clock::time_point since) {
+        if constexpr (Latency) {
+            const auto elapsed = std::chrono::steady_clock::now() - since;
+            const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            auto &histogram = Write ? histograms_[index].writes : histograms_[index].reads;
+            histogram[VLatencyHistogram::bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+        auto &c = counters_[index];
+        (Write ? c.writes : c.reads).fetch_add(1, std::memory_order_relaxed);
+        if (!result) {
+            (Write ? c.write_failures : c.read_failures).fetch_add(1, std::memory_order_relaxed);
+        }
+        return result;
+    }
+};
+
+// NOTE: instrumentation decorator, counts every access to the wrapped mount by address.
+// stays opaque to visitors, so VFlatMap compiles it as one mount and keeps counting.
+template <bool Latency = false> class VStatsMount : public VMountBase {
+    VMountBasePtr target_;
+    VStatsTable<Latency> table_;
+
+public:
+    explicit VStatsMount(VMountBasePtr target)
+        : VMountBase(target->name_, target->desc_), target_(std::move(target)), table_(leafAddrs(*target_)) {}
+
+    VMountBase &target() const { return *target_; }
+    VStatsTable<Latency> &table() { return table_; }
+    const VStatsTable<Latency> &table() const { return table_; }
+
+    virtual size_t size() const override { return target_->size(); }
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        return table_.write(addr, [&] { return target_->writeAt(addr, bytes, endian); });
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        return table_.read(addr, [&] { return target_->readAt(addr, bytes, endian); });
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        co_return co_await table_.writeAsync(addr, [&] { return target_->writeAtAsync(addr, bytes, endian); });
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        co_return co_await table_.readAsync(addr, [&] { return target_->readAtAsync(addr, bytes, endian); });
+    }
+    // NOTE: counted as a read
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        view_opt view;
+        table_.read(addr, [&] {
+            view = target_->viewAt(addr, scratch);
+            return view ? size_opt(view->size()) : std::nullopt;
+        });
+        return view;
+    }
+};
+
+// NOTE: the same for a single register, so it can still be placed in a VRange
+template <bool Latency = false> class VStatsReg : public VRegBase {
+    VRegBasePtr target_;
+    VStatsTable<Latency> table_;
+
+public:
+    explicit VStatsReg(VRegBasePtr target)
+        : VRegBase(target->name_, target->desc_), target_(std::move(target)), table_({0}) {}
+
+    VRegBase &target() const { return *target_; }
+    VStatsTable<Latency> &table() { return table_; }
+    const VStatsTable<Latency> &table() const { return table_; }
+
+    virtual size_opt write(std::span<const std::byte> bytes, std::endian endian = std::endian::native) override {
+        return table_.write(0, [&] { return target_->write(bytes, endian); });
+    }
+    virtual size_opt read(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        return table_.read(0, [&] { return target_->read(bytes, endian); });
+    }
+    virtual VTask<size_opt> writeAsync(std::span<const std::byte> bytes,
+                                       std::endian endian = std::endian::native) override {
+        co_return co_await table_.writeAsync(0, [&] { return target_->writeAsync(bytes, endian); });
+    }
+    virtual VTask<size_opt> readAsync(std::span<std::byte> bytes, std::endian endian = std::endian::native) override {
+        co_return co_await table_.readAsync(0, [&] { return target_->readAsync(bytes, endian); });
+    }
+    virtual view_opt view(std::span<std::byte> scratch = {}) override {
+        view_opt view;
+        table_.read(0, [&] {
+            view = target_->view(scratch);
+            return view ? size_opt(view->size()) : std::nullopt;
+        });
+        return view;
+    }
+    virtual size_t valueSize() override { return target_->valueSize(); }
+};
+
+// NOTE: wraps with statistics, or returns the target itself when built with VREG_NO_STATS.
+// use std::dynamic_pointer_cast<VStatsMount<>> (or VStatsReg) to reach the table, it is null when compiled out.
+template <bool Latency = false, std::derived_from<VMountBase> M> auto withStats(std::shared_ptr<M> target) {
+    using result_t = std::conditional_t<std::derived_from<M, VRegBase>, VRegBasePtr, VMountBasePtr>;
+#ifdef VREG_NO_STATS
+    return result_t(std::move(target));
+#else
+    if constexpr (std::derived_from<M, VRegBase>) {
+        return result_t(std::make_shared<VStatsReg<Latency>>(std::move(target)));
+    } else {
+        return result_t(std::make_shared<VStatsMount<Latency>>(std::move(target)));
+    }
+#endif
+}
+
+}; // namespace vreg::impl
@@ -0,0 +1,137 @@
+#pragma once
+#include "vreg_impl.hpp"
+
+namespace vreg::impl {
+
+// NOTE: VRange stored as structure of arrays. access runs through packed arrays of function pointers,
+// contexts, sizes and flags without touching the register objects: registers backed by memory are read and
+// written on their storage directly, others through a trampoline to their virtual functions.
+// the registers themselves (names, descriptions, visitors) are a cold array beside them.
+class VTable : public VMountBase {
+public:
+    enum Flag : uint8_t {
+        present = 1,  // a register is mapped
+        writable = 2, //
+        storage = 4,  // context is the value, viewable without a call
+    };
+
+private:
+    std::vector<VRegThunk::read_fn> reads_;
+    std::vector<VRegThunk::write_fn> writes_;
+    std::vector<void *> contexts_;
+    std::vector<uint32_t> sizes_;
+    std::vector<uint8_t> flags_;
+    std::vector<VRegBasePtr> regs_; // cold
+
+    static size_opt fail(void *, std::span<std::byte>, std::endian) { return std::nullopt; }
+    static size_opt reject(void *, std::span<const std::byte>, std::endian) { return std::nullopt; }
+
+    template <class Regs> void build(Regs &range) {
+        const size_t n = range.size();
+        reads_.reserve(n), writes_.reserve(n), contexts_.reserve(n), sizes_.reserve(n), flags_.reserve(n);
+        regs_.reserve(n);
+        for (auto &reg : range) {
+            const VRegThunk thunk = reg ? reg->thunk() : VRegThunk{&fail, nullptr, nullptr, 0};
+            reads_.push_back(thunk.read);
+            writes_.push_back(thunk.write ? thunk.write : &reject);
+            contexts_.push_back(thunk.context);
+            sizes_.push_back(thunk.size);
+            flags_.push_back(uint8_t((reg ? present : 0) | (thunk.write ? writable : 0) | (thunk.size ? storage : 0)));
+            regs_.push_back(std::move(reg));
+        }
+    }
+
+public:
+    VTable(std::pmr::vector<VRegBasePtr> &&range, std::string_view name, std::string_view desc = "")
+        : VMountBase(name, desc) {
+        build(range);
+    }
+    VTable(std::vector<VRegBasePtr> &&range, std::string_view name, std::string_view desc = "")
+        : VMountBase(name, desc) {
+        build(range);
+    }
+    VTable(const VTable &) = delete;
+    VTable(VTable &&) = default;
+
+    virtual size_t size() const override { return reads_.size(); }
+    uint8_t flags(addr_t addr) const { return addr < flags_.size() ? flags_[addr] : 0; }
+    // storage size, 0 when unknown
+    size_t regSize(addr_t addr) const { return addr < sizes_.size() ? sizes_[addr] : 0; }
+    std::string_view name(addr_t addr) const { return regs_.at(addr) ? std::string_view(regs_[addr]->name_) : ""; }
+    std::string_view desc(addr_t addr) const { return regs_.at(addr) ? std::string_view(regs_[addr]->desc_) : ""; }
+    const VRegBasePtr &at(size_t addr) const { return regs_.at(addr); }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        if (addr >= writes_.size())
+            return std::nullopt;
+        return writes_[addr](contexts_[addr], bytes, endian);
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        if (addr >= reads_.size())
+            return std::nullopt;
+        return reads_[addr](contexts_[addr], bytes, endian);
+    }
+    // NOTE: registers without storage may be remote, they are awaited through the cold array
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        if (addr >= flags_.size() || (flags_[addr] & (present | storage)) != present)
+            return readyTask(writeAt(addr, bytes, endian));
+        return regs_[addr]->writeAsync(bytes, endian);
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        if (addr >= flags_.size() || (flags_[addr] & (present | storage)) != present)
+            return readyTask(readAt(addr, bytes, endian));
+        return regs_[addr]->readAsync(bytes, endian);
+    }
+    virtual view_opt viewAt(addr_t addr, std::span<std::byte> scratch = {}) override {
+        if (addr >= flags_.size())
+            return std::nullopt;
+        if (flags_[addr] & storage)
+            return std::span((const std::byte *)contexts_[addr], sizes_[addr]);
+        return VMountBase::viewAt(addr, scratch);
+    }
+
+    virtual range_result readRange(addr_t addr, size_t count, std::span<std::byte> bytes, VBitmap status = {},
+                                   std::endian endian = std::endian::native) override {
+        const size_t end = std::min(size_t(addr) + count, reads_.size());
+        size_t used = 0;
+        for (size_t index = addr; index < end; index++) {
+            const size_opt result = reads_[index](contexts_[index], bytes.subspan(used), endian);
+            status.set(index - addr, result.has_value());
+            used += result.value_or(0);
+        }
+        const size_t mapped = end > addr ? end - addr : 0;
+        status.clear(mapped, count - mapped);
+        return {count, used};
+    }
+    virtual range_result writeRange(addr_t addr, size_t count, std::span<const std::byte> bytes, VBitmap status = {},
+                                    std::endian endian = std::endian::native) override {
+        size_t used = 0;
+        for (size_t i = 0; i < count; i++) {
+            const size_t index = size_t(addr) + i;
+            const size_opt result =
+                index < writes_.size() ? writes_[index](contexts_[index], bytes.subspan(used), endian) : std::nullopt;
+            status.set(i, result.has_value());
+            if (!result) {
+                status.clear(i + 1, count - i - 1);
+                return {i, used};
+            }
+            used += *result;
+        }
+        return {count, used};
+    }
+
+    virtual void accept(addr_t base, VMountVisitor &visitor) override {
+        visitor.enter(base, *this);
+        for (size_t i = 0; i < regs_.size(); i++) {
+            if (regs_[i])
+                regs_[i]->accept(base + i, visitor);
+        }
+        visitor.leave(base, *this);
+    }
+};
+
+}; // namespace vreg::impl
@@ -0,0 +1,89 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace vreg::base {
+
+template <class T = void> class VTask;
+
+namespace detail {
+// resumes the awaiting coroutine, if any, when a task finishes
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <class P> std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) const noexcept {
+        const std::coroutine_handle<> continuation = handle.promise().continuation_;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation_;
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() const noexcept { std::terminate(); }
+};
+
+template <class T> struct Promise : public PromiseBase {
+    std::optional<T> value_;
+    VTask<T> get_return_object() noexcept;
+    void return_value(T value) { value_.emplace(std::move(value)); }
+    T result() { return std::move(*value_); }
+};
+template <> struct Promise<void> : public PromiseBase {
+    VTask<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void result() const noexcept {}
+};
+} // namespace detail
+
+// NOTE: lazy coroutine task. it starts when awaited (or resumed by an executor) and resumes its awaiter on
+// completion by symmetric transfer, so chains of awaits do not grow the stack.
+template <class T> class [[nodiscard]] VTask {
+public:
+    using promise_type = detail::Promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+private:
+    handle_type handle_;
+
+public:
+    explicit VTask(handle_type handle) noexcept : handle_(handle) {}
+    VTask(VTask &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    VTask &operator=(VTask &&other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+    ~VTask() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    handle_type handle() const noexcept { return handle_; }
+    bool done() const noexcept { return !handle_ || handle_.done(); }
+    // after done()
+    T result() { return handle_.promise().result(); }
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation_ = awaiting;
+        return handle_;
+    }
+    T await_resume() { return result(); }
+};
+
+namespace detail {
+template <class T> VTask<T> Promise<T>::get_return_object() noexcept {
+    return VTask<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+inline VTask<void> Promise<void>::get_return_object() noexcept {
+    return VTask<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+} // namespace detail
+
+// a task that returns value when awaited (lazy like every VTask, it does not suspend on the way)
+template <class T> VTask<T> readyTask(T value) { co_return value; }
+
+}; // namespace vreg::base
@@ -0,0 +1,296 @@
+#pragma once
+#include "vreg_impl.hpp"
+#include "vreg_queue.hpp"
+#include "vregex_ring.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace vreg::impl {
+using base::VMountBasePtr;
+
+// one access, in the native endian of the recording host
+struct VTraceRecord {
+    static constexpr size_t payload_size = 8; // leading bytes kept
+    uint64_t time;    // ns since the trace started
+    uint32_t latency; // ns spent in the target, saturated
+    addr_t addr;
+    VOp op;
+    bool ok;
+    uint8_t request; // bytes offered by the caller, saturated at 255
+    uint8_t size;    // bytes transferred
+    bool big_endian; // requested byte order
+    std::array<std::byte, payload_size> payload; // read result or written data
+};
+static_assert(sizeof(VTraceRecord) == 32);
+
+// NOTE: trace file, [Header][VTraceRecord...] as flushed (ordered per thread, not across threads)
+struct VTraceFile {
+    struct Header {
+        std::array<char, 4> magic;
+        uint8_t version;
+        uint8_t big_endian;
+        uint16_t record_size;
+    };
+    static constexpr std::array<char, 4> magic = {'V', 'R', 'T', 'R'};
+    static constexpr uint8_t version = 1;
+
+    // records sorted by time, empty when the file is missing or broken.
+    // traces of the other byte order are converted.
+    static std::vector<VTraceRecord> load(const char *path) {
+        std::vector<VTraceRecord> records;
+        FILE *file = fopen(path, "rb");
+        if (!file)
+            return records;
+        Header header;
+        const bool read = fread(&header, sizeof(header), 1, file) == 1;
+        const bool swapped = read && header.big_endian != (std::endian::native == std::endian::big);
+        if (swapped) {
+            header.record_size = vregex::byteswap(header.record_size);
+        }
+        const bool valid = read && header.magic == magic && header.version == version &&
+                           header.record_size == sizeof(VTraceRecord);
+        VTraceRecord record;
+        while (valid && fread(&record, sizeof(record), 1, file) == 1) {
+            if (swapped) {
+                record.time = vregex::byteswap(record.time);
+                record.latency = vregex::byteswap(record.latency);
+                record.addr = vregex::byteswap(record.addr);
+            }
+            records.push_back(record);
+        }
+        fclose(file);
+        std::ranges::stable_sort(records, {}, &VTraceRecord::time);
+        return records;
+    }
+};
+
+// NOTE: access recorder. every access is appended to a lock-free ring of the calling thread and a background
+// thread writes the rings to a binary file every period. recording never blocks: records are dropped and
+// counted when a ring is full. up to max_threads threads are traced, accesses of others are only counted.
+template <size_t RingSize = 4096> class VTraceMount : public VMountBase {
+public:
+    using clock = std::chrono::steady_clock;
+    static constexpr size_t max_threads = 16;
+
+private:
+    using Ring = vregex::spsc_ring<VTraceRecord, RingSize>;
+    struct Slot {
+        std::thread::id thread;
+        std::unique_ptr<Ring> ring;
+    };
+
+    VMountBasePtr target_;
+    FILE *file_ = nullptr;
+    std::atomic<bool> recording_{false};
+    const clock::time_point start_ = clock::now();
+    const uint64_t serial_; // tells instances apart in the per-thread cache
+    std::array<Slot, max_threads> slots_;
+    std::atomic<size_t> threads_{0};
+    std::atomic<size_t> dropped_{0}, written_{0};
+    std::mutex mutex_; // claiming slots, waking the writer
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread writer_;
+
+    static uint64_t nextSerial() {
+        static std::atomic<uint64_t> serial{0};
+        return ++serial;
+    }
+
+    // the rings of the last few instances a thread traced, so alternating mounts stay off mutex_
+    Ring *ring() {
+        struct Cached {
+            uint64_t serial = 0;
+            Ring *ring = nullptr;
+        };
+        thread_local std::array<Cached, 8> cache{};
+        thread_local size_t next = 0;
+        for (const Cached &cached : cache) {
+            if (cached.serial == serial_)
+                return cached.ring;
+        }
+        std::lock_guard lock(mutex_);
+        const size_t n = threads_.load(std::memory_order_relaxed);
+        Ring *found = nullptr;
+        for (size_t i = 0; i < n; i++) {
+            if (slots_[i].thread == std::this_thread::get_id())
+                found = slots_[i].ring.get();
+        }
+        if (!found && n < max_threads) {
+            slots_[n] = {std::this_thread::get_id(), std::make_unique<Ring>()};
+            found = slots_[n].ring.get();
+            threads_.store(n + 1, std::memory_order_release);
+        }
+        cache[next++ % cache.size()] = {serial_, found};
+        return found;
+    }
+
+    template <class Bytes, class Access> size_opt record(VOp op, addr_t addr, Bytes bytes, std::endian endian,
+                                                         Access access) {
+        const clock::time_point begin = clock::now();
+        const size_opt result = access();
+        append(op, addr, bytes, endian, result, begin);
+        return result;
+    }
+    // async accesses are recorded on completion, latency spans the whole await
+    template <class Bytes, class Access> VTask<size_opt> recordAsync(VOp op, addr_t addr, Bytes bytes,
+                                                                     std::endian endian, Access access) {
+        const clock::time_point begin = clock::now();
+        const size_opt result = co_await access();
+        append(op, addr, bytes, endian, result, begin);
+        co_return result;
+    }
+
+    template <class Bytes>
+    void append(VOp op, addr_t addr, Bytes bytes, std::endian endian, size_opt result, clock::time_point begin) {
+        const clock::time_point end = clock::now();
+        if (!recording_.load(std::memory_order_relaxed))
+            return;
+        using std::chrono::duration_cast, std::chrono::nanoseconds;
+        VTraceRecord record{uint64_t(duration_cast<nanoseconds>(begin - start_).count()),
+                            uint32_t(std::min<int64_t>(duration_cast<nanoseconds>(end - begin).count(), UINT32_MAX)),
+                            addr,
+                            op,
+                            result.has_value(),
+                            uint8_t(std::min<size_t>(bytes.size(), 255)),
+                            uint8_t(std::min<size_t>(result.value_or(0), 255)),
+                            endian == std::endian::big,
+                            {}};
+        const size_t kept = std::min(op == VOp::read ? result.value_or(0) : bytes.size(), VTraceRecord::payload_size);
+        memcpy(record.payload.data(), bytes.data(), kept);
+        Ring *ring = this->ring();
+        if (!ring || !ring->push(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // writer thread only
+    void drain() {
+        std::array<VTraceRecord, 256> batch;
+        const size_t n = threads_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; i++) {
+            while (const size_t popped = slots_[i].ring->pop(batch)) {
+                written_.fetch_add(fwrite(batch.data(), sizeof(VTraceRecord), popped, file_),
+                                   std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    // NOTE: with a file that cannot be created the target is forwarded without recording
+    VTraceMount(VMountBasePtr target, const char *path, clock::duration period = std::chrono::milliseconds(10))
+        : VMountBase(target->name_, target->desc_), target_(std::move(target)), serial_(nextSerial()) {
+        file_ = fopen(path, "wb");
+        if (!file_)
+            return;
+        const VTraceFile::Header header{VTraceFile::magic, VTraceFile::version,
+                                        std::endian::native == std::endian::big, sizeof(VTraceRecord)};
+        fwrite(&header, sizeof(header), 1, file_);
+        recording_ = true;
+        writer_ = std::thread([this, period] {
+            std::unique_lock lock(mutex_);
+            while (!stopping_) {
+                wake_.wait_for(lock, period);
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        });
+    }
+    VTraceMount(const VTraceMount &) = delete;
+    virtual ~VTraceMount() { stop(); }
+
+    // flushes what is recorded and closes the file, later accesses are forwarded only
+    void stop() {
+        if (!recording_.exchange(false))
+            return;
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+        drain();
+        FILE *file = std::exchange(file_, nullptr);
+        fclose(file);
+    }
+
+    bool recording() const { return recording_.load(std::memory_order_relaxed); }
+    size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    size_t written() const { return written_.load(std::memory_order_relaxed); }
+    VMountBase &target() const { return *target_; }
+    virtual size_t size() const override { return target_->size(); }
+
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes,
+                             std::endian endian = std::endian::native) override {
+        return record(VOp::write, addr, bytes, endian, [&] { return target_->writeAt(addr, bytes, endian); });
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes,
+                            std::endian endian = std::endian::native) override {
+        return record(VOp::read, addr, bytes, endian, [&] { return target_->readAt(addr, bytes, endian); });
+    }
+    virtual VTask<size_opt> writeAtAsync(addr_t addr, std::span<const std::byte> bytes,
+                                         std::endian endian = std::endian::native) override {
+        return recordAsync(VOp::write, addr, bytes, endian,
+                           [target = target_.get(), addr, bytes, endian] {
+                               return target->writeAtAsync(addr, bytes, endian);
+                           });
+    }
+    virtual VTask<size_opt> readAtAsync(addr_t addr, std::span<std::byte> bytes,
+                                        std::endian endian = std::endian::native) override {
+        return recordAsync(VOp::read, addr, bytes, endian,
+                           [target = target_.get(), addr, bytes, endian] {
+                               return target->readAtAsync(addr, bytes, endian);
+                           });
+    }
+};
+
+// NOTE: drives a recorded trace against a mount. writes replay the recorded data, reads are compared with it.
+// full speed issues the records back to back, real time keeps their recorded spacing.
+struct VTraceReplay {
+    enum class Pace { full, realtime };
+    struct Result {
+        size_t count = 0;      // replayed records
+        size_t skipped = 0;    // writes longer than the kept payload
+        size_t mismatched = 0; // success, size or read data differs from the recording
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    static Result run(VMountBase &mount, std::span<const VTraceRecord> records, Pace pace = Pace::full) {
+        using clock = std::chrono::steady_clock;
+        Result result;
+        std::array<std::byte, 256> buffer;
+        const clock::time_point start = clock::now();
+        const uint64_t first = records.empty() ? 0 : records.front().time;
+        for (const auto &record : records) {
+            if (pace == Pace::realtime) {
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.time - first));
+            }
+            const std::endian endian = record.big_endian ? std::endian::big : std::endian::little;
+            size_opt size;
+            if (record.op == VOp::read) {
+                size = mount.readAt(record.addr, std::span(buffer).first(record.request), endian);
+            } else {
+                if (record.request > VTraceRecord::payload_size) {
+                    result.skipped++;
+                    continue;
+                }
+                size = mount.writeAt(record.addr, std::span(record.payload).first(record.request), endian);
+            }
+            result.count++;
+            const size_t kept = std::min<size_t>(record.size, VTraceRecord::payload_size);
+            const std::span<const std::byte> read = std::span(buffer).first(kept);
+            const std::span<const std::byte> recorded = std::span(record.payload).first(kept);
+            const bool same_data = record.op == VOp::write || !record.ok || std::ranges::equal(read, recorded);
+            const bool same = size.has_value() == record.ok && size.value_or(0) == record.size && same_data;
+            result.mismatched += !same;
+        }
+        result.elapsed = clock::now() - start;
+        return result;
+    }
+};
+
+}; // namespace vreg::impl
@@ -1,71 +1,223 @@
 #pragma once
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <bit>
+#include <cassert>
 #include <compare>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <optional>
+#include <span>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 namespace vregex {
 
 #if __cplusplus < 202302L
+// NOTE: the builtins are one bswap (or rev) instruction and usable in constant expressions
 template <std::integral T> constexpr T byteswap(T x) {
-
-    constexpr size_t n = sizeof(T);
-    std::byte *const bytes = (std::byte *)(&x);
-    for (size_t i = 0; i < n / 2; i++) {
-        std::swap(bytes[i], bytes[n - i - 1]);
+    if constexpr (sizeof(T) == 1) {
+        return x; // also bool, which has no unsigned counterpart
+    } else {
+        using U = std::make_unsigned_t<T>;
+#if defined(__GNUC__)
+        if constexpr (sizeof(T) == 2) {
+            return T(__builtin_bswap16(U(x)));
+        } else if constexpr (sizeof(T) == 4) {
+            return T(__builtin_bswap32(U(x)));
+        } else if constexpr (sizeof(T) == 8) {
+            return T(__builtin_bswap64(U(x)));
+        }
+#endif
+        U u = U(x), out = 0;
+        for (size_t i = 0; i < sizeof(T); i++, u >>= 8) {
+            out = U(out << 8 | (u & 0xff));
+        }
+        return T(out);
     }
-    return x;
 }
 #else
 using std::byteswap;
 #endif
 
-// NOTE: heapless string class like SQL's VARCHAR(n)
+// NOTE: a value shared between threads. readers never block writers, they retry a torn read instead.
+template <class T>
+    requires std::is_trivially_copyable_v<T>
+class seqlock {
+    static constexpr size_t words_ = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    std::atomic<uint32_t> seq_{0}; // odd while writing
+    std::atomic<uint64_t> data_[words_];
+
+public:
+    using value_type = T;
+    seqlock(const T &value = T{}) {
+        for (auto &word : data_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+        store(value);
+    }
+    seqlock(const seqlock &) = delete;
+    seqlock &operator=(const seqlock &) = delete;
+
+    void store(const T &value) {
+        uint64_t words[words_]{};
+        memcpy(words, &value, sizeof(T));
+        // writers exclude each other by making the sequence odd
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        while ((seq & 1) || !seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire)) {
+            seq = seq_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < words_; i++) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint64_t words[words_];
+        uint32_t before, after;
+        for (size_t spins = 1;; spins++) {
+            before = seq_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < words_; i++) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+            if (!(before & 1) && before == after)
+                break;
+            // NOTE: the writer may be preempted on an oversubscribed core
+            if (spins % 64 == 0)
+                std::this_thread::yield();
+        }
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+};
+
+// FNV-1a
+constexpr uint64_t fnv1a(std::string_view s, uint64_t seed = 0xcbf29ce484222325ULL) {
+    uint64_t hash = seed;
+    for (const char c : s) {
+        hash = (hash ^ uint8_t(c)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// CRC-8 (polynomial 0x07, initial 0), table driven
+namespace detail {
+constexpr std::array<uint8_t, 256> crc8Table() {
+    std::array<uint8_t, 256> table{};
+    for (size_t i = 0; i < 256; i++) {
+        uint8_t crc = uint8_t(i);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = uint8_t(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+inline constexpr std::array<uint8_t, 256> crc8_table = crc8Table();
+} // namespace detail
+constexpr uint8_t crc8(std::span<const std::byte> bytes, uint8_t crc = 0) {
+    for (const std::byte b : bytes) {
+        crc = detail::crc8_table[crc ^ uint8_t(b)];
+    }
+    return crc;
+}
+
+// NOTE: fixed-capacity string table. equal strings share one copy and nothing is allocated.
+// returned views stay valid as long as the pool.
+template <size_t bytes, size_t slots = 256>
+    requires(std::has_single_bit(slots))
+class intern_pool {
+    struct Entry {
+        uint32_t offset, length;
+        bool used;
+    };
+    char chars_[bytes];
+    size_t used_ = 0, count_ = 0;
+    std::array<Entry, slots> table_{};
+
+public:
+    std::optional<std::string_view> intern(std::string_view s) {
+        for (size_t i = fnv1a(s);; i++) {
+            Entry &entry = table_[i % slots];
+            if (!entry.used) {
+                if (count_ + 1 > slots * 3 / 4 || used_ + s.size() > bytes)
+                    return std::nullopt;
+                memcpy(chars_ + used_, s.data(), s.size());
+                entry = {uint32_t(used_), uint32_t(s.size()), true};
+                used_ += s.size(), count_++;
+                return std::string_view(chars_ + entry.offset, entry.length);
+            }
+            const std::string_view stored(chars_ + entry.offset, entry.length);
+            if (stored == s)
+                return stored;
+        }
+    }
+    size_t size() const { return count_; }
+    size_t used() const { return used_; }
+};
+
+// NOTE: heapless string class like SQL's VARCHAR(n). the length is stored, so size() is O(1),
+// and the characters stay null terminated for c_str(). longer inputs are truncated to cap.
 template <size_t cap> class varchar {
     constexpr static size_t capacity_ = cap;
-    using traits = std::char_traits<char>;
+    using length_t = std::conditional_t<(cap < 256), uint8_t, std::conditional_t<(cap < 65536), uint16_t, uint32_t>>;
+    length_t length_ = 0;
     char chars_[cap + 1];
 
+    constexpr void assign(const char *s, size_t l) {
+        memcpy(chars_, s, l);
+        memset(chars_ + l, 0, sizeof(chars_) - l);
+        length_ = length_t(l);
+    }
+
 public:
     constexpr varchar() { memset(chars_, 0, sizeof(chars_)); }
 
     constexpr varchar(const char *s) {
         assert(s);
-        const size_t l = strnlen(s, cap);
-        memcpy(chars_, s, l);
-        memset(chars_ + l, 0, sizeof(chars_) - l);
-    }
-    constexpr varchar(std::string_view sv) { sv.copy(chars_, cap); }
-    template <size_t cap2> constexpr varchar(const varchar<cap2> &v) {
-        const size_t l = std::min(v.size(), cap);
-        memcpy(chars_, v.data(), l);
-        memset(chars_ + l, 0, sizeof(chars_) - l);
+        assign(s, strnlen(s, cap));
     }
+    constexpr varchar(std::string_view sv) { assign(sv.data(), std::min(sv.size(), cap)); }
+    template <size_t cap2> constexpr varchar(const varchar<cap2> &v) { assign(v.data(), std::min(v.size(), cap)); }
+    constexpr varchar(const varchar<cap> &) = default;
     constexpr varchar(varchar<cap> &&) = default;
-    auto operator<=>(const varchar<cap> &) const = default;
-    constexpr operator std::string_view() const { return chars_; }
+    constexpr varchar &operator=(const varchar<cap> &) = default;
+    friend constexpr bool operator==(const varchar &a, const varchar &b) {
+        return std::string_view(a) == std::string_view(b);
+    }
+    friend constexpr auto operator<=>(const varchar &a, const varchar &b) {
+        return std::string_view(a) <=> std::string_view(b);
+    }
+    constexpr operator std::string_view() const { return std::string_view(chars_, length_); }
 
     // iterator
     constexpr char *begin() { return chars_; }
     constexpr const char *cbegin() const { return chars_; }
-    constexpr char *end() { return chars_ + size(); }
-    constexpr const char *cend() const { return chars_ + size(); }
+    constexpr char *end() { return chars_ + length_; }
+    constexpr const char *cend() const { return chars_ + length_; }
 
     // region
     constexpr size_t max_size() const { return cap; }
-    constexpr size_t size() const { return traits::length(chars_); }
-    constexpr size_t length() const { return size(); }
-    constexpr bool empty() const { return chars_[0]; }
+    constexpr size_t size() const { return length_; }
+    constexpr size_t length() const { return length_; }
+    constexpr bool empty() const { return length_ == 0; }
 
     // element
     constexpr char at(size_t index) const { return index < capacity_ ? chars_[index] : 0; }
     constexpr char operator[](size_t index) const { return index < sizeof(chars_) ? chars_[index] : 0; }
+    // NOTE: must not change the length (no null characters)
     constexpr char &operator[](size_t index) {
-        assert(index < sizeof(chars_));
+        assert(index < length_);
         return chars_[index];
     }
     constexpr const char *data() const { return chars_; }
@@ -73,15 +225,14 @@ public:
 
     // modify
     constexpr varchar &operator=(std::string_view sv) {
-        const size_t l = std::min(sv.size(), cap);
-        memcpy(chars_, sv.data(), l);
-        memset(chars_ + l, 0, sizeof(chars_) - l);
+        assign(sv.data(), std::min(sv.size(), cap));
         return *this;
     }
     constexpr varchar &operator+=(std::string_view sv) {
-        const size_t n = size();
-        const size_t writable = std::min(sv.size(), max_size() - n);
-        strncpy(chars_ + n, sv.data(), writable);
+        const size_t writable = std::min(sv.size(), cap - length_);
+        memcpy(chars_ + length_, sv.data(), writable);
+        length_ = length_t(length_ + writable);
+        chars_[length_] = 0;
         return *this;
     }
 };
@@ -94,5 +245,5 @@ using varchar_long = varchar<255>;
 }; // namespace vregex
 
 template <size_t n> struct std::hash<vregex::varchar<n>> {
-    size_t operator()(const vregex::varchar<n> &v) const { return std::hash<const char *>()(v.c_str()); }
+    size_t operator()(const vregex::varchar<n> &v) const { return vregex::fnv1a(v); }
 };
\ No newline at end of file
@@ -0,0 +1,190 @@
+#pragma once
+#include "vregex.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
+#include <tuple>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define VREGEX_HAS_X86_BSWAP 1
+#endif
+namespace vregex {
+
+// NOTE: bulk byteswap of n elements of width bytes (2, 4 or 8) from src to dst, which may be unaligned.
+// x86-64 uses AVX2 or SSSE3 byte shuffles when the CPU has them, everything else the scalar loop.
+namespace bswap {
+
+template <class U> inline void scalar(std::byte *dst, const std::byte *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        U x;
+        memcpy(&x, src + i * sizeof(U), sizeof(U));
+        x = byteswap(x);
+        memcpy(dst + i * sizeof(U), &x, sizeof(U));
+    }
+}
+
+#ifdef VREGEX_HAS_X86_BSWAP
+// byte order within each 16 byte lane
+template <size_t width> constexpr std::array<char, 16> shuffle_mask() {
+    std::array<char, 16> mask{};
+    for (size_t i = 0; i < 16; i++) {
+        mask[i] = char(i / width * width + (width - 1 - i % width));
+    }
+    return mask;
+}
+
+template <size_t width> __attribute__((target("ssse3"))) inline size_t ssse3(std::byte *dst, const std::byte *src,
+                                                                             size_t bytes) {
+    constexpr auto m = shuffle_mask<width>();
+    const __m128i mask = _mm_loadu_si128((const __m128i *)m.data());
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi8(x, mask));
+    }
+    return i;
+}
+
+template <size_t width> __attribute__((target("avx2"))) inline size_t avx2(std::byte *dst, const std::byte *src,
+                                                                           size_t bytes) {
+    constexpr auto m = shuffle_mask<width>();
+    const __m128i lane = _mm_loadu_si128((const __m128i *)m.data());
+    const __m256i mask = _mm256_broadcastsi128_si256(lane);
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_shuffle_epi8(x, mask));
+    }
+    return i;
+}
+
+enum class isa { scalar, ssse3, avx2 };
+inline isa detect() {
+    static const isa detected = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return isa::avx2;
+        if (__builtin_cpu_supports("ssse3"))
+            return isa::ssse3;
+        return isa::scalar;
+    }();
+    return detected;
+}
+#endif
+
+// NOTE: below this the dispatch costs more than it saves
+constexpr size_t simd_threshold = 32;
+
+template <size_t width> inline void copy(std::byte *dst, const std::byte *src, size_t n) {
+    static_assert(width == 2 || width == 4 || width == 8);
+    using U = std::conditional_t<width == 2, uint16_t, std::conditional_t<width == 4, uint32_t, uint64_t>>;
+    size_t done = 0; // bytes
+#ifdef VREGEX_HAS_X86_BSWAP
+    if (n * width >= simd_threshold) {
+        switch (detect()) {
+        case isa::avx2:
+            done = avx2<width>(dst, src, n * width);
+            break;
+        case isa::ssse3:
+            done = ssse3<width>(dst, src, n * width);
+            break;
+        case isa::scalar:
+            break;
+        }
+    }
+#endif
+    scalar<U>(dst + done, src + done, n - done / width);
+}
+
+} // namespace bswap
+
+// NOTE: field description for endian conversion of structs, specialize with a tuple of member pointers:
+//   template <> struct vregex::endian_fields<Calib> {
+//       static constexpr auto fields = std::tuple{&Calib::gain, &Calib::table};
+//   };
+// integers, floats, enums, arrays of them and described structs are swapped, other fields are left as they are.
+template <class T> struct endian_fields;
+
+template <class T>
+concept endian_described = std::is_trivially_copyable_v<T> && requires { endian_fields<T>::fields; };
+
+namespace bswap {
+template <class T> constexpr bool scalar_v = std::integral<T> || std::is_enum_v<T> || std::floating_point<T>;
+template <class T> constexpr bool wide() {
+    if constexpr (scalar_v<T>) {
+        return sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8;
+    } else {
+        return false; // also for void, which has no size
+    }
+}
+template <class T> constexpr bool wide_v = wide<T>();
+
+template <class T> struct element {
+    using type = void;
+};
+template <class E, size_t N> struct element<E[N]> {
+    using type = E;
+};
+template <class E, size_t N> struct element<std::array<E, N>> {
+    using type = E;
+};
+template <class T> using element_t = typename element<T>::type;
+
+template <class T> constexpr bool swappable() {
+    if constexpr (scalar_v<T> || endian_described<T>) {
+        return true;
+    } else if constexpr (!std::is_void_v<element_t<T>>) {
+        return swappable<element_t<T>>();
+    } else {
+        return false;
+    }
+}
+} // namespace bswap
+
+// types whose byte order can be converted
+template <class T>
+concept endian_swappable = std::is_trivially_copyable_v<T> && bswap::swappable<T>();
+
+template <class T> inline void byteswap_inplace(T &value) {
+    std::byte *bytes = (std::byte *)&value;
+    if constexpr (bswap::wide_v<T>) {
+        bswap::copy<sizeof(T)>(bytes, bytes, 1);
+    } else if constexpr (!std::is_void_v<bswap::element_t<T>>) {
+        using E = bswap::element_t<T>;
+        if constexpr (bswap::wide_v<E>) {
+            bswap::copy<sizeof(E)>(bytes, bytes, sizeof(T) / sizeof(E));
+        } else {
+            for (auto &e : value) {
+                byteswap_inplace(e);
+            }
+        }
+    } else if constexpr (endian_described<T>) {
+        std::apply([&](auto... fields) { (byteswap_inplace(value.*fields), ...); }, endian_fields<T>::fields);
+    }
+}
+
+// NOTE: value to dst in the other byte order. flat arrays go through the kernels without a temporary.
+template <endian_swappable T> inline void byteswap_to(std::byte *dst, const T &value) {
+    using E = bswap::element_t<T>;
+    if constexpr (bswap::wide_v<E>) {
+        bswap::copy<sizeof(E)>(dst, (const std::byte *)&value, sizeof(T) / sizeof(E));
+    } else {
+        T tmp;
+        memcpy(&tmp, &value, sizeof(T));
+        byteswap_inplace(tmp);
+        memcpy(dst, &tmp, sizeof(T));
+    }
+}
+template <endian_swappable T> inline void byteswap_from(T &value, const std::byte *src) {
+    using E = bswap::element_t<T>;
+    if constexpr (bswap::wide_v<E>) {
+        bswap::copy<sizeof(E)>((std::byte *)&value, src, sizeof(T) / sizeof(E));
+    } else {
+        T tmp;
+        memcpy(&tmp, src, sizeof(T));
+        byteswap_inplace(tmp);
+        memcpy(&value, &tmp, sizeof(T));
+    }
+}
+
+}; // namespace vregex
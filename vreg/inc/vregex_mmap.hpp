@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VREGEX_HAS_MMAP 1
+#endif
+namespace vregex {
+
+#ifdef VREGEX_HAS_MMAP
+// NOTE: a file mapped into memory (POSIX). the mapping is released on destruction.
+class mapped_file {
+    std::byte *data_ = nullptr;
+    size_t size_ = 0;
+    bool writable_ = false;
+
+    mapped_file(std::byte *data, size_t size, bool writable) : data_(data), size_(size), writable_(writable) {}
+
+    static std::optional<mapped_file> map(int fd, size_t size, bool writable) {
+        void *data = size ? mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0)
+                          : nullptr;
+        close(fd);
+        if (data == MAP_FAILED)
+            return std::nullopt;
+        return mapped_file((std::byte *)data, size, writable);
+    }
+
+public:
+    mapped_file(mapped_file &&other)
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+          writable_(other.writable_) {}
+    mapped_file &operator=(mapped_file &&other) {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(writable_, other.writable_);
+        return *this;
+    }
+    ~mapped_file() {
+        if (data_) {
+            munmap(data_, size_);
+        }
+    }
+
+    // whole file, read only
+    static std::optional<mapped_file> open(const char *path) {
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return std::nullopt;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return std::nullopt;
+        }
+        return map(fd, size_t(st.st_size), false);
+    }
+    // created or truncated to size, read and write
+    static std::optional<mapped_file> create(const char *path, size_t size) {
+        const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return std::nullopt;
+        if (ftruncate(fd, off_t(size)) != 0) {
+            close(fd);
+            return std::nullopt;
+        }
+        return map(fd, size, true);
+    }
+
+    size_t size() const { return size_; }
+    std::span<const std::byte> bytes() const { return {data_, size_}; }
+    // empty when opened read only
+    std::span<std::byte> writable() {
+        return writable_ ? std::span<std::byte>(data_, size_) : std::span<std::byte>();
+    }
+    // write back to the file
+    bool sync() { return !data_ || msync(data_, size_, MS_SYNC) == 0; }
+};
+#endif
+
+}; // namespace vregex
@@ -0,0 +1,115 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+namespace vregex {
+
+// NOTE: fixed instead of std::hardware_destructive_interference_size to keep the layout stable across flags
+constexpr size_t cacheline = 64;
+
+// NOTE: bounded lock-free ring for one producer and one consumer. no allocation.
+template <class T, size_t N>
+    requires(std::has_single_bit(N) && std::is_trivially_copyable_v<T>)
+class spsc_ring {
+    alignas(cacheline) std::atomic<size_t> head_{0}; // next pop, written by the consumer
+    alignas(cacheline) std::atomic<size_t> tail_{0}; // next push, written by the producer
+    alignas(cacheline) std::array<T, N> items_;
+
+public:
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    // producer: push as many as fit, returns the pushed count
+    size_t push(std::span<const T> items) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t n = std::min(items.size(), N - (tail - head_.load(std::memory_order_acquire)));
+        for (size_t i = 0; i < n; i++) {
+            items_[(tail + i) % N] = items[i];
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+    bool push(const T &item) { return push(std::span(&item, 1)) == 1; }
+
+    // consumer: pop up to items.size(), returns the popped count
+    size_t pop(std::span<T> items) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t n = std::min(items.size(), tail_.load(std::memory_order_acquire) - head);
+        for (size_t i = 0; i < n; i++) {
+            items[i] = items_[(head + i) % N];
+        }
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+    bool pop(T &item) { return pop(std::span(&item, 1)) == 1; }
+};
+
+// NOTE: bounded lock-free ring for many producers and one consumer (per-cell sequence). no allocation.
+template <class T, size_t N>
+    requires(std::has_single_bit(N) && std::is_trivially_copyable_v<T>)
+class mpsc_ring {
+    struct Cell {
+        std::atomic<size_t> seq;
+        T item;
+    };
+    alignas(cacheline) std::atomic<size_t> head_{0}; // written by the consumer
+    alignas(cacheline) std::atomic<size_t> tail_{0}; // claimed by producers
+    alignas(cacheline) std::array<Cell, N> cells_;
+
+public:
+    mpsc_ring() {
+        for (size_t i = 0; i < N; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    mpsc_ring(const mpsc_ring &) = delete;
+    mpsc_ring &operator=(const mpsc_ring &) = delete;
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+
+    // producer: false when full
+    bool push(const T &item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells_[tail % N];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(tail);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.seq.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                tail = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // consumer: pop the published prefix, up to items.size()
+    size_t pop(std::span<T> items) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        size_t n = 0;
+        for (; n < items.size(); n++) {
+            Cell &cell = cells_[(head + n) % N];
+            if (cell.seq.load(std::memory_order_acquire) != head + n + 1)
+                break;
+            items[n] = cell.item;
+            cell.seq.store(head + n + N, std::memory_order_release);
+        }
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+    bool pop(T &item) { return pop(std::span(&item, 1)) == 1; }
+};
+
+}; // namespace vregex
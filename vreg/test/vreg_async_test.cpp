@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace async_test {
+using namespace std::chrono_literals;
+
+VTask<size_t> add(VExecutor &executor, size_t a, size_t b) {
+    co_await executor.yield();
+    co_return a + b;
+}
+
+TEST(VTask, chain) {
+    VExecutor executor;
+    size_t sum = 0;
+    auto outer = [&]() -> VTask<> {
+        for (size_t i = 0; i < 10000; i++) {
+            sum = co_await add(executor, sum, 1);
+        }
+    };
+    executor.spawn(outer());
+    EXPECT_EQ(executor.pending(), 1);
+    executor.run();
+    EXPECT_EQ(sum, 10000);
+    EXPECT_EQ(executor.pending(), 0);
+    EXPECT_EQ(executor.block(add(executor, 2, 3)), 5);
+}
+
+TEST(VMountBase, asyncFallback) {
+    VExecutor executor;
+    uint32_t value = 0x12345678;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("value").buildBinder(value));
+    VMap map({{0x10, std::make_shared<VRange>(rb.build())}}, "map");
+
+    uint32_t out = 0;
+    EXPECT_EQ(executor.block(map.readAtAsync(0x10, std::as_writable_bytes(std::span(&out, 1)))), 4);
+    EXPECT_EQ(out, 0x12345678);
+    const uint32_t in = 0x11223344;
+    EXPECT_EQ(executor.block(map.writeAtAsync(0x10, std::as_bytes(std::span(&in, 1)), std::endian::big)), 4);
+    EXPECT_EQ(value, 0x44332211);
+    EXPECT_EQ(executor.block(map.readAtAsync(0x20, std::as_writable_bytes(std::span(&out, 1)))), std::nullopt);
+}
+
+TEST(VRegAsync, remote) {
+    VExecutor executor;
+    uint32_t value = 7;
+    size_t requests = 0;
+    auto writer = [&](std::span<const std::byte> bytes, std::endian endian) -> VTask<size_opt> {
+        co_await executor.yield(); // round trip
+        requests++;
+        co_return VRegBinder<uint32_t>(value, "").write(bytes, endian);
+    };
+    auto reader = [&](std::span<std::byte> bytes, std::endian endian) -> VTask<size_opt> {
+        co_await executor.yield();
+        requests++;
+        co_return VRegBinder<uint32_t>(value, "").read(bytes, endian);
+    };
+    static_assert(async_reader<decltype(reader)> && async_writer<decltype(writer)>);
+    static_assert(!base::reader<decltype(reader)>);
+    VRangeBuilder rb("range");
+    auto remote = std::make_shared<VRegAsync<decltype(writer), decltype(reader)>>(std::move(writer),
+                                                                                  std::move(reader), "remote");
+    rb.add(remote);
+    VFlatMap map(std::make_shared<VRange>(rb.build()));
+
+    uint32_t out = 0;
+    const auto bytes = std::as_writable_bytes(std::span(&out, 1));
+    EXPECT_EQ(map.readAt(0, bytes), std::nullopt); // needs an executor
+    EXPECT_EQ(executor.block(map.readAtAsync(0, bytes)), 4);
+    EXPECT_EQ(out, 7);
+    const uint32_t in = 9;
+    EXPECT_EQ(executor.block(map.writeAtAsync(0, std::as_bytes(std::span(&in, 1)))), 4);
+    EXPECT_EQ(value, 9);
+    EXPECT_EQ(requests, 2);
+
+    // a table reaches it through the cold array
+    VRangeBuilder tb("table");
+    tb.add(remote);
+    VTable table = tb.buildTable();
+    EXPECT_EQ(executor.block(table.readAtAsync(0, bytes)), 4);
+    EXPECT_EQ(out, 9);
+    EXPECT_EQ(requests, 3);
+}
+
+TEST(VDelayMount, pipelining) {
+    constexpr size_t count = 32;
+    constexpr auto latency = 2ms;
+    VExecutor executor;
+    std::array<uint32_t, count> values;
+    VRangeBuilder rb("range");
+    for (size_t i = 0; i < count; i++) {
+        values[i] = uint32_t(i * 3);
+        rb.add(VRegBuilder("value").buildBinder(values[i]));
+    }
+    VDelayMount device(std::make_shared<VRange>(rb.build()), executor, latency);
+
+    std::array<uint32_t, count> out{};
+    size_t ok = 0;
+    auto request = [&](addr_t addr) -> VTask<> {
+        ok += co_await device.readAtAsync(addr, std::as_writable_bytes(std::span(&out[addr], 1))) == 4;
+    };
+    for (size_t i = 0; i < count; i++) {
+        executor.spawn(request(addr_t(i)));
+    }
+    // all requests in flight at once after the first step, each waiting for its own round trip
+    EXPECT_TRUE(executor.step());
+    EXPECT_EQ(executor.sleeping(), count);
+    executor.run();
+    EXPECT_EQ(ok, count);
+    EXPECT_EQ(out, values);
+}
+
+TEST(VDelayMount, pipeliningThroughDecorators) {
+    constexpr size_t count = 32;
+    constexpr auto latency = 2ms;
+    VExecutor executor;
+    std::array<uint32_t, count> values;
+    VRangeBuilder rb("range");
+    for (size_t i = 0; i < count; i++) {
+        values[i] = uint32_t(i * 3);
+        rb.add(VRegBuilder("value").buildBinder(values[i]));
+    }
+    auto device = std::make_shared<VDelayMount>(std::make_shared<VRange>(rb.build()), executor, latency);
+    auto stats = withStats<true>(device);
+    const std::vector<std::shared_ptr<VMountBase>> mounts = {stats, std::make_shared<VDirtyMount>(device),
+                                                             std::make_shared<VCacheMount<>>(device)};
+
+    for (const auto &mount : mounts) {
+        std::array<uint32_t, count> out{};
+        size_t ok = 0;
+        auto request = [&](addr_t addr) -> VTask<> {
+            ok += co_await mount->readAtAsync(addr, std::as_writable_bytes(std::span(&out[addr], 1))) == 4;
+        };
+        for (size_t i = 0; i < count; i++) {
+            executor.spawn(request(addr_t(i)));
+        }
+        EXPECT_TRUE(executor.step());
+        EXPECT_EQ(executor.sleeping(), count);
+        executor.run();
+        EXPECT_EQ(ok, count);
+        EXPECT_EQ(out, values);
+    }
+#ifdef VREG_NO_STATS
+    EXPECT_FALSE(std::dynamic_pointer_cast<VStatsMount<true>>(stats));
+#else
+    // counted on completion, with the round trip as latency
+    auto &table = std::dynamic_pointer_cast<VStatsMount<true>>(stats)->table();
+    EXPECT_EQ(table.stats(0).reads, 1);
+    const auto &reads = table.histogram(0).reads;
+    EXPECT_EQ(std::accumulate(reads.begin() + VLatencyHistogram::bucket(1'000'000), reads.end(), uint64_t(0)), 1);
+#endif
+}
+
+} // namespace async_test
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+using namespace vreg;
+using namespace std::chrono_literals;
+
+namespace cache_test {
+// a sensor behind a slow bus
+struct SlowDevice {
+    std::chrono::microseconds latency;
+    uint32_t value = 1;
+    uint16_t config = 2;
+    size_t reads = 0, writes = 0;
+    bool fail = false; // the bus rejects writes
+
+    std::shared_ptr<VRange> range() {
+        auto bus = [this] { std::this_thread::sleep_for(latency); };
+        VRangeBuilder rb("device");
+        rb.add(VRegBuilder("value").buildRW(
+            [this, bus](std::span<const std::byte> bytes, std::endian endian) -> size_opt {
+                bus(), writes++;
+                return VRegBinder(value, "").write(bytes, endian);
+            },
+            [this, bus](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+                bus(), reads++;
+                return VRegBinder(value, "").read(bytes, endian);
+            }));
+        rb.add(VRegBuilder("config").buildRW(
+            [this, bus](std::span<const std::byte> bytes, std::endian endian) -> size_opt {
+                bus(), writes++;
+                if (fail)
+                    return std::nullopt;
+                return VRegBinder(config, "").write(bytes, endian);
+            },
+            [this, bus](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+                bus(), reads++;
+                return VRegBinder(config, "").read(bytes, endian);
+            }));
+        return std::make_shared<VRange>(rb.build());
+    }
+};
+
+struct FakeClock {
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static inline time_point current{};
+    static time_point now() { return current; }
+};
+
+TEST(VCacheMount, ttl) {
+    SlowDevice device{0us};
+    VCacheMount<FakeClock> cache(device.range(), {10ms});
+    uint32_t v;
+    auto buf = std::as_writable_bytes(std::span(&v, 1));
+    EXPECT_EQ(cache.readAt(0, buf), 4);
+    EXPECT_EQ(cache.readAt(0, buf), 4);
+    EXPECT_EQ(device.reads, 1);
+    EXPECT_EQ(cache.hits(), 1);
+
+    device.value = 5;
+    FakeClock::current += 5ms;
+    EXPECT_EQ(cache.readAt(0, buf), 4);
+    EXPECT_EQ(v, 1); // still cached
+    FakeClock::current += 5ms;
+    EXPECT_EQ(cache.readAt(0, buf), 4);
+    EXPECT_EQ(v, 5); // expired
+    EXPECT_EQ(device.reads, 2);
+
+    device.value = 6;
+    cache.invalidate(0);
+    cache.readAt(0, buf);
+    EXPECT_EQ(v, 6);
+    // other endians are not cached
+    cache.readAt(0, buf, std::endian::big);
+    EXPECT_EQ(device.reads, 4);
+}
+
+TEST(VCacheMount, writeBack) {
+    SlowDevice device{0us};
+    VCacheMount<FakeClock> cache(device.range(), {1s, VCachePolicy::Write::back});
+    uint16_t c = 0;
+    auto buf = std::as_writable_bytes(std::span(&c, 1));
+    cache.readAt(1, buf); // learns the size
+
+    // coalesced until flush
+    for (c = 10; c < 20; c++) {
+        EXPECT_EQ(cache.writeAt(1, buf), 2);
+    }
+    EXPECT_EQ(device.writes, 0);
+    EXPECT_EQ(device.config, 2);
+    cache.invalidate(); // pending writes survive
+    EXPECT_EQ(cache.readAt(1, buf), 2);
+    EXPECT_EQ(c, 19);
+    EXPECT_EQ(cache.flush(), 0);
+    EXPECT_EQ(device.writes, 1);
+    EXPECT_EQ(device.config, 19);
+
+    // write-through on another address
+    cache.setPolicy(0, {1s, VCachePolicy::Write::through});
+    const uint32_t v = 7;
+    EXPECT_EQ(cache.writeAt(0, std::as_bytes(std::span(&v, 1))), 4);
+    EXPECT_EQ(device.value, 7);
+    EXPECT_EQ(device.writes, 2);
+}
+
+TEST(VCacheMount, flushOnDestruction) {
+    SlowDevice device{0us};
+    {
+        VCacheMount<FakeClock> cache(device.range(), {1s, VCachePolicy::Write::back});
+        uint32_t v = 0;
+        cache.readAt(0, std::as_writable_bytes(std::span(&v, 1)));
+        v = 42;
+        cache.writeAt(0, std::as_bytes(std::span(&v, 1)));
+        EXPECT_EQ(device.value, 1);
+    }
+    EXPECT_EQ(device.value, 42);
+}
+
+TEST(VCacheMount, failedWriteBack) {
+    SlowDevice device{0us};
+    VCacheMount<FakeClock> cache(device.range(), {1s, VCachePolicy::Write::back});
+    uint16_t c = 0;
+    auto buf = std::as_writable_bytes(std::span(&c, 1));
+    cache.readAt(1, buf);
+    c = 10;
+    cache.writeAt(1, buf);
+    device.fail = true;
+    EXPECT_EQ(cache.flush(), 1);
+
+    // the pending value is neither bypassed nor dropped
+    c = 20;
+    EXPECT_EQ(cache.writeAt(1, buf, std::endian::big), std::nullopt);
+    EXPECT_EQ(cache.readAt(1, buf, std::endian::big), std::nullopt);
+    cache.setPolicy(1, {1s, VCachePolicy::Write::through});
+    EXPECT_EQ(cache.writeAt(1, buf), std::nullopt);
+    EXPECT_EQ(cache.readAt(1, buf), 2);
+    EXPECT_EQ(c, 10);
+    EXPECT_EQ(device.config, 2);
+
+    device.fail = false;
+    EXPECT_EQ(cache.flush(), 0);
+    EXPECT_EQ(device.config, 10);
+    c = 20;
+    EXPECT_EQ(cache.writeAt(1, buf, std::endian::big), 2);
+    EXPECT_EQ(cache.flush(), 0);
+    EXPECT_EQ(device.config, 0x1400);
+}
+
+TEST(VCacheMount, writeThroughDoesNotCache) {
+    uint8_t status = 0x0f, written = 0;
+    VRangeBuilder rb("device");
+    rb.add(VRegBuilder("command").buildWO([&](std::span<const std::byte> bytes, std::endian endian) -> size_opt {
+        return VRegBinder(written, "").write(bytes, endian);
+    }));
+    // write-1-to-clear
+    rb.add(VRegBuilder("status").buildRW(
+        [&](std::span<const std::byte> bytes, std::endian) -> size_opt {
+            status &= ~uint8_t(bytes[0]);
+            return 1;
+        },
+        [&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+            return VRegBinder(status, "").read(bytes, endian);
+        }));
+    VCacheMount<FakeClock> cache(std::make_shared<VRange>(rb.build()), {1s});
+    uint8_t v = 0x03;
+    auto buf = std::as_writable_bytes(std::span(&v, 1));
+
+    EXPECT_EQ(cache.writeAt(0, buf), 1);
+    EXPECT_EQ(written, 0x03);
+    EXPECT_EQ(cache.readAt(0, buf), std::nullopt);
+
+    EXPECT_EQ(cache.readAt(1, buf), 1);
+    EXPECT_EQ(v, 0x0f);
+    v = 0x03;
+    EXPECT_EQ(cache.writeAt(1, buf), 1);
+    EXPECT_EQ(cache.readAt(1, buf), 1);
+    EXPECT_EQ(v, 0x0c);
+}
+
+TEST(VCacheMount, latency) {
+    constexpr size_t count = 20;
+    SlowDevice device{200us};
+    auto range = device.range();
+    VCacheMount<> cache(range, {1s});
+    uint32_t v;
+    auto buf = std::as_writable_bytes(std::span(&v, 1));
+
+    auto measure = [&](VMountBase &mount) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            mount.readAt(0, buf);
+        }
+        return std::chrono::steady_clock::now() - begin;
+    };
+    const auto direct = measure(*range);
+    const auto cached = measure(cache);
+    EXPECT_EQ(device.reads, count + 1);
+    EXPECT_LT(cached * 5, direct);
+}
+} // namespace cache_test
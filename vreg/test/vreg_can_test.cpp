@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace can_test {
+struct Node {
+    uint16_t speed = 0, torque = 0;
+    uint32_t position = 0;
+    uint8_t status = 0; // mode:4 fault:1
+    const uint32_t version = 0x01020304;
+    std::shared_ptr<VMap> map;
+    Node() {
+        VRangeBuilder motor("motor");
+        motor.add(VRegBuilder("speed").buildBinder(speed));
+        motor.add(VRegBuilder("torque").buildBinder(torque));
+        motor.add(VRegBuilder("position").buildBinder(position));
+        motor.add(VRegBuilder("status").buildBinder(status));
+        VRangeBuilder info("info");
+        info.add(VRegBuilder("version").buildBinderRO(version));
+        map = std::make_shared<VMap>(std::vector<VMap::pair>{{0x10, std::make_shared<VRange>(motor.build())},
+                                                             {0x20, std::make_shared<VRange>(info.build())}},
+                                     "map");
+    }
+};
+
+VCanFrame frame(uint32_t id, std::initializer_list<uint8_t> bytes) {
+    VCanFrame f{id, uint8_t(bytes.size()), 0, {}, {}};
+    std::ranges::transform(bytes, f.data.begin(), [](uint8_t b) { return std::byte(b); });
+    return f;
+}
+
+const std::vector<VCanRoute> routes = {
+    {0x100, {{0x10, 0, 2}, {0x11, 2, 2}, {0x12, 4, 4}}},           // merged into one writeRange
+    {0x101 | VCanFrame::extended, {{0x13, 0, 1}, {0x10, 2, 2}}},   // 29-bit, out of order
+    {0x200, {{0x20, 0, 4}}},                                        // read only
+};
+
+TEST(VCanGateway, decode) {
+    Node node;
+    VCanGateway gateway(*node.map, routes);
+    EXPECT_EQ(gateway.routes(), 3);
+
+    const VCanFrame frames[] = {
+        frame(0x100, {0x34, 0x12, 0x78, 0x56, 0x04, 0x03, 0x02, 0x01}),
+        frame(0x101 | VCanFrame::extended, {0x15, 0x00, 0xcd, 0xab}),
+        frame(0x101, {0x15, 0x00, 0xff, 0xff}), // standard id 0x101 is not routed
+        frame(0x100, {0x00, 0x00}),             // too short
+        frame(0x200, {0, 0, 0, 0}),             // read only
+        frame(0x100 | VCanFrame::remote, {}),
+    };
+    EXPECT_EQ(gateway.decode(frames), 2);
+    EXPECT_EQ(node.speed, 0xabcd);
+    EXPECT_EQ(node.torque, 0x5678);
+    EXPECT_EQ(node.position, 0x01020304);
+    EXPECT_EQ(node.status, 0x15);
+    // bit level signals from the integer register
+    using Status = VFields<VField<0, 4>, VField<4, 1>>;
+    EXPECT_EQ(Status::decode(node.status), std::make_tuple(uint8_t(5), uint8_t(1)));
+
+    const auto &counters = gateway.counters();
+    EXPECT_EQ(counters.frames, 2);
+    EXPECT_EQ(counters.unknown, 2);
+    EXPECT_EQ(counters.truncated, 1);
+    EXPECT_EQ(counters.failed, 1);
+}
+
+TEST(VCanGateway, bigEndian) {
+    Node node;
+    VCanGateway gateway(*node.map, routes, std::endian::big);
+    EXPECT_TRUE(gateway.decode(frame(0x100, {0x12, 0x34, 0x56, 0x78, 0x01, 0x02, 0x03, 0x04})));
+    EXPECT_EQ(node.speed, 0x1234);
+    EXPECT_EQ(node.torque, 0x5678);
+    EXPECT_EQ(node.position, 0x01020304);
+}
+
+TEST(VCanGateway, encode) {
+    Node node;
+    node.speed = 0x1234, node.status = 0x7;
+    VCanGateway gateway(*node.map, routes);
+    const uint32_t ids[] = {0x101 | VCanFrame::extended, 0x200, 0x300};
+    std::array<VCanFrame, 3> frames;
+    EXPECT_EQ(gateway.encode(ids, frames), 2); // 0x300 is not routed
+    EXPECT_EQ(frames[0].length, 4);
+    EXPECT_EQ(frames[0].flags, 0);
+    EXPECT_EQ(frames[0].payload()[0], std::byte(0x07));
+    EXPECT_EQ(frames[0].payload()[1], std::byte(0x00));
+    EXPECT_EQ(frames[0].payload()[2], std::byte(0x34));
+    EXPECT_EQ(frames[0].payload()[3], std::byte(0x12));
+    EXPECT_EQ(frames[1].payload()[0], std::byte(0x04));
+
+    // a round trip through another node
+    Node other;
+    VCanGateway receiver(*other.map, routes);
+    EXPECT_EQ(receiver.decode(std::span(frames).first(1)), 1);
+    EXPECT_EQ(other.speed, 0x1234);
+    EXPECT_EQ(other.status, 0x7);
+}
+
+TEST(VCanGateway, rejectedRoutes) {
+    Node node;
+    uint8_t fifo = 0x42;
+    size_t reads = 0;
+    VRangeBuilder rb("fifo");
+    rb.add(VRegBuilder("fifo").buildRO([&](std::span<std::byte> bytes, std::endian) -> size_opt {
+        reads++; // read to pop
+        return bytes.empty() ? std::nullopt : (bytes[0] = std::byte(fifo), size_opt(1));
+    }));
+    VMap map({{0x00, node.map}, {0x30, std::make_shared<VRange>(rb.build())}}, "map");
+    const std::vector<VCanRoute> bad = {
+        {0x300, {{0x10, 62, 4}}},                // past the payload
+        {0x301, {{0x10, 0, 2}, {0x11, 64, 2}}},  // partly
+        {0x302, {{0x30, 0, 1}}},                 //
+        {0x303, {{0x10, 60, 2}, {0x11, 62, 2}}}, // ends at the payload
+    };
+    VCanGateway gateway(map, bad);
+    EXPECT_EQ(gateway.routes(), 2);
+    EXPECT_EQ(gateway.counters().rejected, 2);
+    EXPECT_EQ(reads, 0); // nothing is probed by reading
+
+    VCanFrame f;
+    EXPECT_FALSE(gateway.encode(0x300, f));
+    EXPECT_TRUE(gateway.encode(0x302, f));
+    EXPECT_EQ(reads, 1);
+    node.speed = 0x1234;
+    EXPECT_TRUE(gateway.encode(0x303, f));
+    EXPECT_EQ(f.length, 64);
+    EXPECT_EQ(f.data[60], std::byte(0x34));
+    EXPECT_TRUE(gateway.decode(f));
+}
+
+TEST(VCanFrame, fitLength) {
+    EXPECT_EQ(VCanFrame::fitLength(0), 0);
+    EXPECT_EQ(VCanFrame::fitLength(8), 8);
+    EXPECT_EQ(VCanFrame::fitLength(9), 12);
+    EXPECT_EQ(VCanFrame::fitLength(33), 48);
+    EXPECT_EQ(VCanFrame::fitLength(64), 64);
+    EXPECT_EQ(VCanFrame::fitLength(65), 0);
+}
+
+TEST(VCanLoopback, pump) {
+    Node tx, rx;
+    tx.speed = 1000, tx.torque = 20, tx.position = 300000;
+    VCanGateway sender(*tx.map, routes), receiver(*rx.map, routes);
+    VCanLoopback<64> bus;
+    std::thread producer([&] {
+        VCanFrame f;
+        for (int i = 0; i < 100; i++) {
+            sender.encode(0x100, f);
+            while (!bus.send(f)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    size_t received = 0;
+    while (received < 100) {
+        received += receiver.pump(bus);
+    }
+    producer.join();
+    EXPECT_EQ(receiver.counters().frames, 100);
+    EXPECT_EQ(rx.speed, 1000);
+    EXPECT_EQ(rx.torque, 20);
+    EXPECT_EQ(rx.position, 300000);
+}
+
+} // namespace can_test
@@ -0,0 +1,88 @@
+#include <array>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace concurrent_test {
+TEST(VRegBinder, atomic) {
+    std::atomic<uint32_t> value = 0x11223344;
+    VRegBinder reg(value, "atomic");
+    std::byte buf[sizeof(uint32_t)];
+    EXPECT_EQ(reg.read(buf, std::endian::big), sizeof(uint32_t));
+    EXPECT_EQ(buf[0], std::byte{0x11});
+    EXPECT_EQ(reg.write(buf, std::endian::little), sizeof(uint32_t));
+    EXPECT_EQ(value.load(), 0x44332211);
+    EXPECT_EQ(reg.read(std::span(buf).first(2)), std::nullopt);
+}
+
+TEST(VRegBinder, seqlock) {
+    struct Gain {
+        float p, i, d;
+    };
+    vregex::seqlock<Gain> gain({1, 2, 3});
+    auto reg = VRegBuilder("gain").buildBinder(gain);
+    std::byte buf[sizeof(Gain)];
+    EXPECT_EQ(reg->read(buf), sizeof(Gain));
+    Gain g;
+    memcpy(&g, buf, sizeof(g));
+    EXPECT_EQ(g.d, 3);
+    g.i = 5;
+    memcpy(buf, &g, sizeof(g));
+    EXPECT_EQ(reg->write(buf), sizeof(Gain));
+    EXPECT_EQ(gain.load().i, 5);
+}
+
+// every value is written with all bytes equal, a torn read mixes them
+template <class Check> void stress(VMountBase &mount, size_t width, Check check) {
+    constexpr size_t readers = 3;
+    std::atomic<bool> stop = false;
+    std::atomic<size_t> torn = 0, reads = 0;
+
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; r++) {
+        threads.emplace_back([&] {
+            std::array<std::byte, 64> buf;
+            size_t n = 0;
+            while (!stop.load(std::memory_order_relaxed) || n < 1000) {
+                if (mount.readAt(0, buf) != width || !check(std::span(buf).first(width)))
+                    torn++;
+                n++;
+            }
+            reads += n;
+        });
+    }
+    std::array<std::byte, 64> buf;
+    for (size_t i = 0; i < 200000; i++) {
+        buf.fill(std::byte(i));
+        ASSERT_EQ(mount.writeAt(0, buf), width);
+    }
+    stop = true;
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_GE(reads.load(), readers * 1000);
+}
+
+bool uniform(std::span<const std::byte> bytes) {
+    return std::ranges::all_of(bytes, [&](std::byte b) { return b == bytes[0]; });
+}
+
+TEST(concurrent, atomic_stress) {
+    std::atomic<uint64_t> value = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("value").buildBinder(value));
+    VRange range = rb.build();
+    stress(range, sizeof(uint64_t), uniform);
+}
+
+TEST(concurrent, seqlock_stress) {
+    vregex::seqlock<std::array<uint8_t, 40>> value;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("value").buildBinder(value));
+    VRange range = rb.build();
+    stress(range, 40, uniform);
+}
+} // namespace concurrent_test
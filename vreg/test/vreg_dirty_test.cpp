@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace dirty_test {
+struct Device {
+    uint32_t a = 1, b = 2;
+    uint16_t c = 3;
+    int64_t d = 4;
+
+    std::shared_ptr<VMap> map() {
+        VRangeBuilder rb("range");
+        rb.add(VRegBuilder("c").buildBinder(c));
+        rb.add(VRegBuilder("reserved").buildReserved());
+        rb.add(VRegBuilder("d").buildBinder(d));
+        // sparse, 29-bit like CAN IDs
+        return std::make_shared<VMap>(std::vector<VMap::pair>{
+            {0x100, VRegBuilder("a").buildBinder(a)},
+            {0x1fff0000, VRegBuilder("b").buildBinder(b)},
+            {0x200, std::make_shared<VRange>(rb.build())},
+        }, "device");
+    }
+};
+
+TEST(VDirtyMount, writeAndPoll) {
+    Device device;
+    VDirtyMount dirty(device.map());
+    EXPECT_EQ(dirty.registers(), 5);
+    EXPECT_EQ(dirty.dirtyCount(), 0);
+    EXPECT_EQ(dirty.poll(), 0);
+
+    const uint32_t value = 10;
+    EXPECT_TRUE(dirty.writeAt(0x100, std::as_bytes(std::span(&value, 1))));
+    EXPECT_FALSE(dirty.writeAt(0x201, std::as_bytes(std::span(&value, 1))));
+    EXPECT_TRUE(dirty.dirty(0x100));
+    EXPECT_FALSE(dirty.dirty(0x201));
+
+    device.d = 40; // changed behind the mount
+    EXPECT_EQ(dirty.poll(), 1);
+    EXPECT_TRUE(dirty.dirty(0x202));
+    EXPECT_EQ(dirty.dirtyCount(), 2);
+}
+
+TEST(VDirtyMount, pollSkipsCallbacks) {
+    uint32_t bound = 1, fifo = 2;
+    size_t reads = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("bound").buildBinder(bound));
+    rb.add(VRegBuilder("fifo").buildRW(
+        [&](std::span<const std::byte> bytes, std::endian endian) -> size_opt {
+            return VRegBinder(fifo, "").write(bytes, endian);
+        },
+        [&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+            reads++;
+            return VRegBinder(fifo, "").read(bytes, endian);
+        }));
+    VDirtyMount dirty(std::make_shared<VRange>(rb.build()));
+    EXPECT_EQ(dirty.watched(), 1);
+    EXPECT_EQ(reads, 0); // sized without reading
+    const size_t probed = reads;
+
+    bound = 10, fifo = 20;
+    EXPECT_EQ(dirty.poll(), 1);
+    EXPECT_TRUE(dirty.dirty(0));
+    EXPECT_FALSE(dirty.dirty(1)); // only writes mark callbacks
+    EXPECT_EQ(reads, probed);
+
+    const uint32_t value = 30;
+    EXPECT_TRUE(dirty.writeAt(1, std::as_bytes(std::span(&value, 1))));
+    EXPECT_TRUE(dirty.dirty(1));
+    EXPECT_EQ(dirty.poll(), 0);
+    EXPECT_EQ(reads, probed);
+}
+
+TEST(VDirtyMount, collectReadsOnce) {
+    uint32_t bound = 0x01020304, next = 1;
+    size_t reads = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("bound").buildBinder(bound));
+    rb.add(VRegBuilder("fifo").buildRO([&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+        reads++;
+        const size_opt result = VRegBinder(next, "").read(bytes, endian);
+        next += result.has_value(); // popped
+        return result;
+    }));
+    VDirtyMount dirty(std::make_shared<VRange>(rb.build()));
+    uint32_t mirror_bound = 0, mirror_fifo = 0;
+    VRangeBuilder hb("host");
+    hb.add(VRegBuilder("bound").buildBinder(mirror_bound));
+    hb.add(VRegBuilder("fifo").buildBinder(mirror_fifo));
+    VRange host = hb.build();
+
+    // no room for bound: it is not read and stays dirty
+    dirty.markAll();
+    std::array<std::byte, VDirtyMount::header_size + 3> tiny;
+    EXPECT_EQ(dirty.collectDirty(tiny, std::endian::big).count, 0);
+    EXPECT_EQ(dirty.dirtyCount(), 2);
+    EXPECT_EQ(reads, 0);
+
+    // one read per register in the requested endian, the value sent becomes the polled one
+    std::array<std::byte, 64> buffer;
+    range_result result = dirty.collectDirty(buffer, std::endian::big);
+    EXPECT_EQ(result.count, 2);
+    EXPECT_EQ(reads, 1);
+    EXPECT_EQ(VDirtyMount::applyDelta(host, std::span(buffer).first(result.bytes), std::endian::big).count, 2);
+    EXPECT_EQ(mirror_bound, 0x01020304);
+    EXPECT_EQ(mirror_fifo, 1);
+    EXPECT_EQ(dirty.poll(), 0);
+
+    // a value that turns out too large after its read is held, not lost
+    dirty.markDirty(1);
+    std::array<std::byte, VDirtyMount::header_size + 2> small;
+    EXPECT_EQ(dirty.collectDirty(small, std::endian::big).count, 0);
+    EXPECT_EQ(reads, 2);
+    EXPECT_EQ(dirty.dirtyCount(), 1);
+    result = dirty.collectDirty(buffer, std::endian::big);
+    EXPECT_EQ(result.count, 1);
+    EXPECT_EQ(reads, 2);
+    EXPECT_EQ(VDirtyMount::applyDelta(host, std::span(buffer).first(result.bytes), std::endian::big).count, 1);
+    EXPECT_EQ(mirror_fifo, 2);
+    EXPECT_EQ(dirty.dirtyCount(), 0);
+}
+
+TEST(VDirtyMount, collectDirty) {
+    Device device, mirror;
+    VDirtyMount dirty(device.map());
+    auto host = mirror.map();
+    device.b = 20;
+    device.c = 30;
+    device.d = 40;
+    EXPECT_EQ(dirty.poll(), 3);
+
+    // too small for all of them, the rest stays dirty
+    std::array<std::byte, 16> small;
+    range_result result = dirty.collectDirty(small, std::endian::big);
+    EXPECT_EQ(result.count, 1); // c: 5 + 2
+    EXPECT_EQ(result.bytes, VDirtyMount::header_size + 2);
+    EXPECT_EQ(VDirtyMount::applyDelta(*host, std::span(small).first(result.bytes), std::endian::big).count, 1);
+    EXPECT_EQ(mirror.c, 30);
+    EXPECT_EQ(dirty.dirtyCount(), 2);
+
+    std::array<std::byte, 64> buffer;
+    result = dirty.collectDirty(buffer, std::endian::big);
+    EXPECT_EQ(result.count, 2);
+    EXPECT_EQ(result.bytes, 2 * VDirtyMount::header_size + 8 + 4);
+    EXPECT_EQ(VDirtyMount::applyDelta(*host, std::span(buffer).first(result.bytes), std::endian::big).count, 2);
+    EXPECT_EQ(mirror.b, 20);
+    EXPECT_EQ(mirror.d, 40);
+
+    // collected values are not reported again
+    EXPECT_EQ(dirty.dirtyCount(), 0);
+    EXPECT_EQ(dirty.poll(), 0);
+    EXPECT_EQ(dirty.collectDirty(buffer).count, 0);
+}
+
+TEST(VDirtyMount, markAll) {
+    Device device, mirror;
+    VDirtyMount dirty(device.map());
+    auto host = mirror.map();
+    device.a = 7;
+    dirty.markAll();
+    std::array<std::byte, 64> buffer;
+    const range_result result = dirty.collectDirty(buffer);
+    EXPECT_EQ(result.count, 4); // reserved is skipped
+    VDirtyMount::applyDelta(*host, std::span(buffer).first(result.bytes));
+    EXPECT_EQ(mirror.a, 7);
+    EXPECT_EQ(dirty.dirtyCount(), 0);
+}
+
+TEST(VDirtyMount, largeRegister) {
+    std::array<uint32_t, 32> samples{}, copy{}; // 128 bytes, larger than a fixed probe
+    VRangeBuilder rb("range"), hb("host");
+    rb.add(VRegBuilder("samples").buildBinder(samples));
+    hb.add(VRegBuilder("samples").buildBinder(copy));
+    VDirtyMount dirty(std::make_shared<VRange>(rb.build()));
+    VRange host = hb.build();
+
+    samples[31] = 31;
+    EXPECT_EQ(dirty.poll(), 1);
+    std::array<std::byte, VDirtyMount::header_size + sizeof(samples)> buffer;
+    const range_result result = dirty.collectDirty(buffer, std::endian::big);
+    EXPECT_EQ(result.count, 1);
+    EXPECT_EQ(result.bytes, buffer.size());
+    EXPECT_EQ(VDirtyMount::applyDelta(host, buffer, std::endian::big).count, 1);
+    EXPECT_EQ(copy[31], 31);
+}
+} // namespace dirty_test
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace endpoint_test {
+struct Node {
+    uint16_t speed = 0x1234;
+    uint32_t position = 0x01020304;
+    std::array<uint16_t, 2> pair = {0x0a0b, 0x0c0d};
+    float gain = 1.5f;
+    std::shared_ptr<VMap> map;
+    Node() {
+        VRangeBuilder rb("node");
+        rb.add(VRegBuilder("speed").buildBinder(speed));
+        rb.add(VRegBuilder("position").buildBinder(position));
+        rb.add(VRegBuilder("pair").buildBinder(pair));
+        rb.add(VRegBuilder("gain").buildBinder(gain));
+        rb.add(VRegBuilder("id").buildConst(uint32_t(0xcafe)));
+        map = std::make_shared<VMap>(std::vector<VMap::pair>{{0x10, std::make_shared<VRange>(rb.build())}}, "map");
+    }
+};
+
+// the specialized path gives the bytes of the runtime argument path
+template <std::endian E, class T> void expectSame(VMountBase &mount, addr_t addr) {
+    std::array<std::byte, 8> runtime{}, fixed{};
+    ASSERT_EQ(mount.readAt(addr, runtime, E), sizeof(T));
+    ASSERT_EQ((readAs<E, T>(mount, addr, fixed)), sizeof(T));
+    EXPECT_EQ(runtime, fixed) << addr;
+}
+
+TEST(VEndpoint, readAs) {
+    Node node;
+    expectSame<std::endian::big, uint16_t>(*node.map, 0x10);
+    expectSame<std::endian::big, uint32_t>(*node.map, 0x11);
+    expectSame<std::endian::big, std::array<uint16_t, 2>>(*node.map, 0x12);
+    expectSame<std::endian::big, float>(*node.map, 0x13);
+    expectSame<std::endian::big, uint32_t>(*node.map, 0x14);
+    expectSame<std::endian::little, uint16_t>(*node.map, 0x10);
+    expectSame<std::endian::little, uint32_t>(*node.map, 0x11);
+    expectSame<std::endian::little, std::array<uint16_t, 2>>(*node.map, 0x12);
+
+    VEndpoint<std::endian::big> link(*node.map);
+    std::array<std::byte, 4> bytes;
+    ASSERT_EQ(link.readAs<uint16_t>(0x10, bytes), 2);
+    EXPECT_EQ(bytes[0], std::byte(0x12));
+    EXPECT_EQ(bytes[1], std::byte(0x34));
+    EXPECT_EQ(link.readAs<uint32_t>(0x10, bytes), std::nullopt); // another size
+    EXPECT_EQ(link.readAs<uint32_t>(0x40, bytes), std::nullopt); // unmapped
+    EXPECT_EQ(link.readAs<uint32_t>(0x11, std::span(bytes).first(2)), std::nullopt);
+    EXPECT_EQ(link.readAt(0x11, bytes), 4);
+    EXPECT_EQ(bytes[0], std::byte(0x01));
+}
+
+TEST(VEndpoint, writeAs) {
+    Node node;
+    VEndpoint<std::endian::big> big(*node.map);
+    VEndpoint<std::endian::little> little(*node.map);
+    const std::array<std::byte, 4> bytes = {std::byte(1), std::byte(2), std::byte(3), std::byte(4)};
+
+    EXPECT_EQ(big.writeAs<uint32_t>(0x11, bytes), 4);
+    EXPECT_EQ(node.position, 0x01020304);
+    EXPECT_EQ(little.writeAs<uint32_t>(0x11, bytes), 4);
+    EXPECT_EQ(node.position, 0x04030201);
+    EXPECT_EQ((big.writeAs<std::array<uint16_t, 2>>(0x12, bytes)), 4);
+    EXPECT_EQ(node.pair, (std::array<uint16_t, 2>{0x0102, 0x0304}));
+    EXPECT_EQ(big.writeAs<uint16_t>(0x10, bytes), 2);
+    EXPECT_EQ(node.speed, 0x0102);
+
+    EXPECT_EQ(big.writeAs<uint16_t>(0x11, bytes), std::nullopt); // another size
+    EXPECT_EQ(big.writeAs<uint32_t>(0x14, bytes), std::nullopt); // constant
+    EXPECT_EQ(big.writeAs<uint32_t>(0x11, std::span(bytes).first(3)), std::nullopt);
+    EXPECT_EQ(big.writeAt(0x11, bytes), 4);
+    EXPECT_EQ(node.position, 0x01020304);
+}
+
+} // namespace endpoint_test
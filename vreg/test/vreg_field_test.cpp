@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace field_test {
+using Mode = VField<0, 3>;
+using Trim = VField<3, 5, true>;
+using Speed = VField<16, 16>;
+using Temp = VField<52, 12, true>;
+
+TEST(VField, extractInsert) {
+    static_assert(std::is_same_v<Mode::value_type, uint8_t>);
+    static_assert(std::is_same_v<Temp::value_type, int16_t>);
+    static_assert(std::is_same_v<VField<0, 64, true>::value_type, int64_t>);
+    static_assert(Trim::extract(uint8_t(0b11111'000)) == -1);
+    static_assert(Trim::extract(uint8_t(0b01111'000)) == 15);
+    static_assert(Trim::extract(uint8_t(0b10000'000)) == -16);
+
+    uint32_t raw = 0xffff0000;
+    raw = Mode::insert(raw, 5);
+    raw = Trim::insert(raw, -3);
+    EXPECT_EQ(Mode::extract(raw), 5);
+    EXPECT_EQ(Trim::extract(raw), -3);
+    EXPECT_EQ(Speed::extract(raw), 0xffff);
+    // out of range values are truncated, neighbours stay
+    raw = Mode::insert(raw, 0xff);
+    EXPECT_EQ(Mode::extract(raw), 7);
+    EXPECT_EQ(Trim::extract(raw), -3);
+    EXPECT_EQ((VField<0, 64>::insert(uint64_t(0), ~uint64_t(0))), ~uint64_t(0));
+}
+
+TEST(VFields, decode) {
+    using Frame = VFields<Mode, Trim, Speed, Temp>;
+    constexpr uint64_t raw = Frame::encode(uint64_t(0), 2, -4, 1000, -40);
+    static_assert(std::get<3>(Frame::decode(raw)) == -40);
+    const auto [mode, trim, speed, temp] = Frame::decode(raw);
+    EXPECT_EQ(mode, 2);
+    EXPECT_EQ(trim, -4);
+    EXPECT_EQ(speed, 1000);
+    EXPECT_EQ(temp, -40);
+
+    // a frame on the wire, big endian
+    const uint64_t wire = vregex::byteswap(raw);
+    const auto values = Frame::decode<uint64_t>(std::as_bytes(std::span(&wire, 1)), std::endian::big);
+    ASSERT_TRUE(values);
+    EXPECT_EQ(std::get<2>(*values), 1000);
+
+    const uint64_t raws[] = {raw, Frame::encode(raw, 1, 1, 1, 1)};
+    Frame::values out[2];
+    Frame::decode(std::span<const uint64_t>(raws), std::span(out));
+    EXPECT_EQ(std::get<2>(out[0]), 1000);
+    EXPECT_EQ(std::get<3>(out[1]), 1);
+}
+
+TEST(VRegField, builder) {
+    uint32_t status = 0;
+    VRangeBuilder rb("status");
+    rb.add(VRegBuilder("mode").buildField<Mode>(status));
+    rb.add(VRegBuilder("trim").buildField<Trim>(status));
+    rb.add(VRegBuilder("speed").buildFieldRO<Speed>(status));
+    VRange range = rb.build();
+
+    const int8_t trim = -5;
+    EXPECT_EQ(range.writeAt(1, std::as_bytes(std::span(&trim, 1))), 1);
+    const uint8_t mode = 6;
+    EXPECT_EQ(range.writeAt(0, std::as_bytes(std::span(&mode, 1))), 1);
+    EXPECT_EQ(Trim::extract(status), -5);
+    EXPECT_EQ(Mode::extract(status), 6);
+
+    status = Speed::insert(status, 0x1234);
+    uint16_t speed;
+    EXPECT_EQ(range.readAt(2, std::as_writable_bytes(std::span(&speed, 1)), std::endian::big), 2);
+    EXPECT_EQ(speed, vregex::byteswap(uint16_t(0x1234)));
+    EXPECT_FALSE(range.writeAt(2, std::as_bytes(std::span(&speed, 1))));
+}
+
+TEST(VRegField, static) {
+    uint16_t status = 0;
+    StaticVRange range("status", "", VRegField<uint16_t, Mode>(status, "mode"),
+                       VRegField<uint16_t, VField<8, 8, true>>(status, "level"));
+    const int8_t level = -2;
+    EXPECT_EQ(range.writeAt(1, std::as_bytes(std::span(&level, 1))), 1);
+    EXPECT_EQ(status, 0xfe00);
+    std::byte buf[1];
+    EXPECT_EQ(range.readAt<1>(buf), 1);
+    EXPECT_EQ(int8_t(buf[0]), -2);
+}
+} // namespace field_test
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace flat_test {
+// a mount without known structure
+struct Opaque : public VMountBase {
+    Opaque() : VMountBase("opaque", "") {}
+    virtual size_t size() const override { return 4; }
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes, std::endian endian) override {
+        (void)addr, (void)bytes, (void)endian;
+        return std::nullopt;
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes, std::endian endian) override {
+        (void)endian;
+        if (bytes.empty())
+            return std::nullopt;
+        bytes[0] = std::byte(0xa0 + addr);
+        return 1;
+    }
+};
+
+TEST(VFlatMap, VFlatMap) {
+    int a = 1, b = 2, c = 3;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("b").buildBinder(b));
+    rb.add(VRegBuilder("reserved").buildReserved());
+    rb.add(VRegBuilder("c").buildBinder(c));
+    auto inner = std::make_shared<VMap>(
+        std::vector<VMap::pair>{
+            {0x0, VRegBuilder("a").buildBinder(a)},
+            {0x8, std::make_shared<VRange>(rb.build())},
+        },
+        "inner");
+    auto root = std::make_shared<VMap>(
+        std::vector<VMap::pair>{
+            {0x100, inner},
+            {0x200, std::make_shared<Opaque>()},
+        },
+        "root", "desc");
+
+    VFlatMap flat(root);
+    EXPECT_EQ(flat.name_, "root");
+    EXPECT_EQ(flat.desc_, "desc");
+    EXPECT_EQ(flat.size(), root->size());
+    EXPECT_EQ(flat.leaves(), 5);
+    EXPECT_EQ(flat.depth(), 3);
+
+    // same results as the tree
+    for (addr_t addr = 0; addr < 0x210; addr++) {
+        std::byte x[sizeof(int)]{}, y[sizeof(int)]{};
+        EXPECT_EQ(flat.readAt(addr, x), root->readAt(addr, y)) << addr;
+        EXPECT_EQ(memcmp(x, y, sizeof(x)), 0) << addr;
+    }
+
+    // writes reach the bound variables
+    std::byte buf[sizeof(int)];
+    const int v = 7;
+    memcpy(buf, &v, sizeof(v));
+    EXPECT_EQ(flat.writeAt(0x10a, buf), sizeof(int));
+    EXPECT_EQ(c, 7);
+    EXPECT_EQ(flat.writeAt(0x109, buf), std::nullopt);
+    EXPECT_EQ(flat.readAt(0x203, buf), 1);
+    EXPECT_EQ(buf[0], std::byte(0xa3));
+}
+} // namespace flat_test
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace monitor_test {
+using P = VMonitorProtocol;
+
+struct Node {
+    uint16_t speed = 0x1234;
+    uint32_t position = 0x01020304;
+    const uint8_t version = 7;
+    std::shared_ptr<VMap> map;
+    VNameIndex names;
+    Node() {
+        VRangeBuilder motor("motor");
+        motor.add(VRegBuilder("speed").buildBinder(speed));
+        motor.add(VRegBuilder("position").buildBinder(position));
+        motor.add(VRegBuilder("version").buildBinderRO(version));
+        map = std::make_shared<VMap>(std::vector<VMap::pair>{{0x10, std::make_shared<VRange>(motor.build())}}, "map");
+        names = VNameIndex(*map);
+    }
+};
+
+struct Response {
+    uint8_t command;
+    std::vector<std::byte> payload;
+};
+std::vector<Response> parse(std::span<const std::byte> bytes) {
+    std::vector<Response> responses;
+    VMonitorParser parser;
+    parser.feed(bytes, [&](uint8_t command, std::span<const std::byte> payload) {
+        responses.push_back({command, {payload.begin(), payload.end()}});
+    });
+    return responses;
+}
+std::vector<std::byte> bytes(std::initializer_list<uint8_t> list) {
+    std::vector<std::byte> out;
+    for (const uint8_t b : list) {
+        out.push_back(std::byte(b));
+    }
+    return out;
+}
+
+TEST(VMonitorParser, fragments) {
+    std::array<std::byte, 64> buffer;
+    const size_t n = P::writeRequest(0x10, bytes({1, 2, 3}), buffer);
+    ASSERT_EQ(n, P::overhead + 7);
+    std::vector<std::byte> stream = bytes({0x00, 0x42}); // noise before the frame
+    stream.insert(stream.end(), buffer.begin(), buffer.begin() + n);
+    stream.insert(stream.end(), buffer.begin(), buffer.begin() + n);
+    stream[stream.size() - 1] ^= std::byte(1); // broken crc
+
+    // byte by byte and all at once give the same frames
+    for (const size_t chunk : {size_t(1), size_t(3), stream.size()}) {
+        VMonitorParser parser;
+        std::vector<Response> frames;
+        for (size_t i = 0; i < stream.size(); i += chunk) {
+            parser.feed(std::span(stream).subspan(i, std::min(chunk, stream.size() - i)),
+                        [&](uint8_t command, std::span<const std::byte> payload) {
+                            frames.push_back({command, {payload.begin(), payload.end()}});
+                        });
+        }
+        ASSERT_EQ(frames.size(), 1) << chunk;
+        EXPECT_EQ(frames[0].command, P::write);
+        EXPECT_EQ(frames[0].payload, bytes({0x10, 0, 0, 0, 1, 2, 3}));
+        EXPECT_EQ(parser.crcErrors(), 1);
+        EXPECT_GE(parser.dropped(), 2);
+    }
+}
+
+TEST(VMonitorParser, resyncInsideBadFrame) {
+    std::array<std::byte, 64> buffer;
+    const size_t n = P::writeRequest(0x10, bytes({1, 2, 3}), buffer);
+    std::vector<std::byte> stream(buffer.begin(), buffer.begin() + n);
+    stream[2] = std::byte(n + 1); // corrupted length, the frame swallows the ping behind it
+    const size_t ping = P::frame(P::ping, {}, buffer);
+    stream.insert(stream.end(), buffer.begin(), buffer.begin() + ping);
+    stream.resize(stream.size() + 8); // idle line
+
+    // whole, split and byte by byte find the same frames
+    for (const size_t chunk : {size_t(1), size_t(2), size_t(5), stream.size()}) {
+        VMonitorParser parser;
+        std::vector<Response> frames;
+        for (size_t i = 0; i < stream.size(); i += chunk) {
+            parser.feed(std::span(stream).subspan(i, std::min(chunk, stream.size() - i)),
+                        [&](uint8_t command, std::span<const std::byte> payload) {
+                            frames.push_back({command, {payload.begin(), payload.end()}});
+                        });
+        }
+        ASSERT_EQ(frames.size(), 1) << chunk;
+        EXPECT_EQ(frames[0].command, P::ping) << chunk;
+        EXPECT_EQ(parser.crcErrors(), 1) << chunk;
+    }
+}
+
+TEST(VMonitor, binary) {
+    Node node;
+    VMonitor monitor(*node.map, &node.names);
+    std::array<std::byte, 512> requests;
+    size_t n = 0;
+    n += P::readRequest(0x10, std::span(requests).subspan(n));
+    n += P::writeRequest(0x11, bytes({0x78, 0x56, 0x34, 0x12}), std::span(requests).subspan(n));
+    n += P::writeRequest(0x12, bytes({9}), std::span(requests).subspan(n)); // read only
+    n += P::dumpRequest(0x10, 4, std::span(requests).subspan(n));
+    n += P::findRequest("motor.version", std::span(requests).subspan(n));
+    n += P::findRequest("motor.speed", std::span(requests).subspan(n), P::read_name);
+    n += P::findRequest("motor.none", std::span(requests).subspan(n));
+    n += P::frame(0x33, {}, std::span(requests).subspan(n));
+    monitor.feed(std::span(requests).first(n));
+    EXPECT_EQ(monitor.counters().requests, 8);
+
+    // all responses batched in one buffer
+    const auto responses = parse(monitor.output());
+    ASSERT_EQ(responses.size(), 8);
+    EXPECT_EQ(responses[0].command, P::read | P::response);
+    EXPECT_EQ(responses[0].payload, bytes({P::ok, 0x34, 0x12}));
+    EXPECT_EQ(responses[1].payload, bytes({P::ok, 4}));
+    EXPECT_EQ(node.position, 0x12345678);
+    EXPECT_EQ(responses[2].payload, bytes({P::failed}));
+    EXPECT_EQ(responses[3].payload, bytes({P::ok, 0x07, 0, 0, 0, 0, 0, 0, 0, // 0x13 is unmapped
+                                           0x34, 0x12, 0x78, 0x56, 0x34, 0x12, 7}));
+    EXPECT_EQ(responses[4].payload, bytes({P::ok, 0x12, 0, 0, 0}));
+    EXPECT_EQ(responses[5].payload, bytes({P::ok, 0x10, 0, 0, 0, 0x34, 0x12}));
+    EXPECT_EQ(responses[6].payload, bytes({P::failed}));
+    EXPECT_EQ(responses[7].payload, bytes({P::unknown_command}));
+
+    monitor.consume(monitor.output().size());
+    EXPECT_TRUE(monitor.output().empty());
+}
+
+TEST(VMonitor, overflow) {
+    Node node;
+    VMonitor monitor(*node.map, nullptr, std::endian::little, false, 0); // the smallest output
+    std::array<std::byte, 16> request;
+    const size_t n = P::readRequest(0x10, request);
+    for (size_t i = 0; i < 50; i++) {
+        monitor.feed(std::span(request).first(n));
+    }
+    const size_t answered = parse(monitor.output()).size();
+    EXPECT_GT(monitor.counters().overflows, 0);
+    EXPECT_EQ(answered + monitor.counters().overflows, 50);
+
+    // served again once the output is sent
+    monitor.consume(monitor.output().size());
+    monitor.feed(std::span(request).first(n));
+    EXPECT_EQ(parse(monitor.output()).size(), 1);
+}
+
+TEST(VMonitor, text) {
+    Node node;
+    VMonitor monitor(*node.map, &node.names, std::endian::little, true);
+    const std::string_view input = "r 10\nw 0x11 0a0b0c0d\r\nd 10 3\nf motor.position\nn motor.spe";
+    monitor.feed(std::as_bytes(std::span(input)));
+    monitor.feed(std::as_bytes(std::span(std::string_view("ed\nr 40\nx\nw 11 123\np\nr 100000010\nw 11 0x01020304\n"))));
+    const std::string_view output(reinterpret_cast<const char *>(monitor.output().data()), monitor.output().size());
+    EXPECT_EQ(output, "ok 1234\n"
+                      "ok 04\n"
+                      "ok 7 12340a0b0c0d07\n"
+                      "ok 11\n"
+                      "ok 10 1234\n"
+                      "err 1\n"
+                      "err 3\n"
+                      "err 2\n"
+                      "ok\n"
+                      "err 2\n" // beyond 32 bit
+                      "ok 04\n");
+    EXPECT_EQ(node.position, 0x01020304);
+}
+
+// a client on the other end of a pipe, the server answering with serve()
+TEST(VMonitor, pipe) {
+    Node node;
+    int requests[2], responses[2];
+    ASSERT_EQ(pipe(requests), 0);
+    ASSERT_EQ(pipe(responses), 0);
+    std::thread server([&] {
+        VMonitor monitor(*node.map, &node.names);
+        while (monitor.serve(requests[0], responses[1])) {
+        }
+        close(responses[1]);
+    });
+
+    constexpr size_t count = 100;
+    std::thread client([&] {
+        std::array<std::byte, 16> frame;
+        for (size_t i = 0; i < count; i++) {
+            const size_t n = P::readRequest(0x10 + addr_t(i % 3), frame);
+            // split frames as a slow line would
+            ASSERT_EQ(write(requests[1], frame.data(), 3), 3);
+            ASSERT_EQ(write(requests[1], frame.data() + 3, n - 3), ssize_t(n - 3));
+        }
+        close(requests[1]);
+    });
+
+    VMonitorParser parser;
+    std::vector<Response> received;
+    std::array<std::byte, 256> buffer;
+    ssize_t n;
+    while ((n = read(responses[0], buffer.data(), buffer.size())) > 0) {
+        parser.feed(std::span(buffer).first(size_t(n)), [&](uint8_t command, std::span<const std::byte> payload) {
+            received.push_back({command, {payload.begin(), payload.end()}});
+        });
+    }
+    client.join();
+    server.join();
+    close(requests[0]), close(responses[0]);
+
+    ASSERT_EQ(received.size(), count);
+    EXPECT_EQ(received[0].payload, bytes({P::ok, 0x34, 0x12}));
+    EXPECT_EQ(received[1].payload, bytes({P::ok, 4, 3, 2, 1}));
+    EXPECT_EQ(received[2].payload, bytes({P::ok, 7}));
+    EXPECT_EQ(parser.crcErrors(), 0);
+}
+
+} // namespace monitor_test
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace names_test {
+TEST(VNameIndex, paths) {
+    uint32_t speed = 0, current = 0, temp = 0;
+    VRangeBuilder motor("motor");
+    motor.add(VRegBuilder("speed").buildBinder(speed));
+    motor.add(VRegBuilder("current").buildBinder(current));
+    VRangeBuilder board("board");
+    board.add(VRegBuilder("temp").buildBinder(temp));
+    board.add(VRegBuilder("temp").buildConst(uint8_t(1))); // duplicate, the lower address wins
+    VRangeBuilder loose("");
+    loose.add(VRegBuilder("version").buildConst(uint16_t(3)));
+    VMap inner({{0, std::make_shared<VRange>(board.build())}}, "sys");
+    VMap map({{0x10, std::make_shared<VRange>(motor.build())},
+              {0x20, std::make_shared<VMap>(std::move(inner))},
+              {0x30, std::make_shared<VRange>(loose.build())}},
+             "root");
+
+    VNameIndex index(map);
+    EXPECT_EQ(index.size(), 4);
+    EXPECT_EQ(index.find("motor.speed"), 0x10);
+    EXPECT_EQ(index.find("motor.current"), 0x11);
+    EXPECT_EQ(index.find("sys.board.temp"), 0x20);
+    EXPECT_EQ(index.find("version"), 0x30);
+    EXPECT_EQ(index.find("speed"), std::nullopt);
+    EXPECT_EQ(index.find("motor.speedx"), std::nullopt);
+    EXPECT_EQ(index.find(""), std::nullopt);
+    EXPECT_EQ(VNameIndex().find("motor.speed"), std::nullopt);
+
+    const vregex::varchar_middle name("motor.current");
+    uint32_t value = 5;
+    ASSERT_TRUE(index.find(name));
+    map.writeAt(*index.find(name), std::as_bytes(std::span(&value, 1)));
+    EXPECT_EQ(current, 5);
+}
+
+TEST(VNameIndex, perfect) {
+    constexpr size_t ranges = 40, regs = 50;
+    std::vector<std::string> names; // outlive the registers with static names
+    for (size_t i = 0; i < regs; i++) {
+        names.push_back("r" + std::to_string(i));
+    }
+    std::vector<std::string> range_names;
+    for (size_t r = 0; r < ranges; r++) {
+        range_names.push_back("range" + std::to_string(r));
+    }
+    std::vector<VMap::pair> entries;
+    for (size_t r = 0; r < ranges; r++) {
+        VRangeBuilder rb(range_names[r]);
+        for (size_t i = 0; i < regs; i++) {
+            rb.add(VRegBuilder(names[i]).buildConst(uint32_t(r * regs + i)));
+        }
+        entries.push_back({r * 0x100, std::make_shared<VRange>(rb.build())});
+    }
+    VMap map(std::move(entries), "map");
+    VNameIndex index(map);
+    ASSERT_EQ(index.size(), ranges * regs);
+    for (size_t r = 0; r < ranges; r++) {
+        for (size_t i = 0; i < regs; i++) {
+            const auto addr = index.find(range_names[r] + "." + names[i]);
+            ASSERT_TRUE(addr);
+            EXPECT_EQ(*addr, r * 0x100 + i);
+        }
+    }
+}
+
+TEST(VNameIndex, lengths) {
+    // every tail the word-at-a-time hash handles, each byte changed must miss
+    std::vector<std::string> names;
+    for (size_t length = 1; length <= 24; length++) {
+        std::string name;
+        for (size_t i = 0; i < length; i++) {
+            name.push_back(char('a' + (i * 7 + length) % 26));
+        }
+        names.push_back(name);
+    }
+    VRangeBuilder rb("");
+    for (const auto &name : names) {
+        rb.add(VRegBuilder(name).buildConst(uint8_t(0)));
+    }
+    VMap map({{0, std::make_shared<VRange>(rb.build())}}, "root");
+    VNameIndex index(map);
+    ASSERT_EQ(index.size(), names.size());
+    for (size_t n = 0; n < names.size(); n++) {
+        EXPECT_EQ(index.find(names[n]), n);
+        for (size_t i = 0; i < names[n].size(); i++) {
+            std::string changed = names[n];
+            changed[i] = '.';
+            EXPECT_EQ(index.find(changed), std::nullopt);
+        }
+    }
+}
+
+} // namespace names_test
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+#include <vregex_ring.hpp>
+using namespace vreg;
+
+namespace queue_test {
+TEST(spsc_ring, batch) {
+    vregex::spsc_ring<int, 4> ring;
+    const int in[] = {1, 2, 3, 4, 5};
+    EXPECT_EQ(ring.push(in), 4);
+    EXPECT_FALSE(ring.push(6));
+    int out[3];
+    EXPECT_EQ(ring.pop(out), 3);
+    EXPECT_EQ(out[2], 3);
+    EXPECT_TRUE(ring.push(6));
+    EXPECT_EQ(ring.pop(out), 2);
+    EXPECT_EQ(out[1], 6);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(mpsc_ring, producers) {
+    constexpr size_t producers = 4, count = 20000;
+    vregex::mpsc_ring<uint32_t, 64> ring;
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (uint32_t i = 0; i < count; i++) {
+                while (!ring.push(p << 24 | i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    // each producer's items arrive in order
+    std::vector<uint32_t> next(producers, 0);
+    size_t received = 0;
+    uint32_t buf[16];
+    while (received < producers * count) {
+        const size_t n = ring.pop(buf);
+        for (size_t i = 0; i < n; i++) {
+            const uint32_t p = buf[i] >> 24;
+            ASSERT_EQ(buf[i] & 0xffffff, next[p]++);
+        }
+        received += n;
+        if (n == 0)
+            std::this_thread::yield();
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+TEST(VRequestQueue, drain) {
+    uint32_t a = 0x11223344;
+    uint16_t b = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("a").buildBinder(a));
+    rb.add(VRegBuilder("b").buildBinder(b));
+    VRange range = rb.build();
+
+    VRequestQueue<8> queue;
+    const std::byte bytes[] = {std::byte{0x12}, std::byte{0x34}};
+    EXPECT_TRUE(queue.postRead(1, 0, 4, std::endian::big));
+    EXPECT_TRUE(queue.postWrite(2, 1, bytes, std::endian::big));
+    EXPECT_TRUE(queue.postRead(3, 2));
+    EXPECT_FALSE(queue.postRead(4, 0, 9));
+    EXPECT_EQ(queue.pending(), 3);
+
+    EXPECT_EQ(queue.drain(range), 3);
+    EXPECT_EQ(b, 0x1234);
+
+    VCompletion done[4];
+    ASSERT_EQ(queue.poll(done), 3);
+    EXPECT_EQ(done[0].tag, 1);
+    EXPECT_TRUE(done[0].ok);
+    EXPECT_EQ(done[0].size, 4);
+    EXPECT_EQ(done[0].payload[0], std::byte{0x11});
+    EXPECT_EQ(done[1].tag, 2);
+    EXPECT_TRUE(done[1].ok);
+    EXPECT_EQ(done[1].size, 2);
+    EXPECT_EQ(done[2].tag, 3);
+    EXPECT_FALSE(done[2].ok);
+}
+
+// counts the calls that reach the mount, visitors see through it
+struct CountingMount : public VMountBase {
+    VMountBase &target;
+    size_t singles = 0, ranges = 0;
+    explicit CountingMount(VMountBase &target) : VMountBase("counting", ""), target(target) {}
+    virtual size_t size() const override { return target.size(); }
+    virtual size_opt writeAt(addr_t addr, std::span<const std::byte> bytes, std::endian endian) override {
+        return singles++, target.writeAt(addr, bytes, endian);
+    }
+    virtual size_opt readAt(addr_t addr, std::span<std::byte> bytes, std::endian endian) override {
+        return singles++, target.readAt(addr, bytes, endian);
+    }
+    virtual range_result readRange(addr_t addr, size_t count, std::span<std::byte> bytes, VBitmap status,
+                                   std::endian endian) override {
+        return ranges++, target.readRange(addr, count, bytes, status, endian);
+    }
+    virtual range_result writeRange(addr_t addr, size_t count, std::span<const std::byte> bytes, VBitmap status,
+                                    std::endian endian) override {
+        return ranges++, target.writeRange(addr, count, bytes, status, endian);
+    }
+    virtual void accept(addr_t base, base::VMountVisitor &visitor) override { target.accept(base, visitor); }
+};
+
+TEST(VRequestQueue, runs) {
+    std::array<uint32_t, 8> regs{};
+    const uint32_t version = 7;
+    uint32_t fifo = 0x55;
+    VRangeBuilder rb("range");
+    for (auto &reg : regs) {
+        rb.add(VRegBuilder("reg").buildBinder(reg));
+    }
+    rb.add(VRegBuilder("version").buildBinderRO(version));
+    rb.add(VRegBuilder("fifo").buildRO([&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+        return VRegBinder(fifo, "").read(bytes, endian);
+    }));
+    VRange range = rb.build();
+    CountingMount mount(range);
+
+    VRequestQueue<64> queue;
+    queue.prepare(mount);
+    for (uint32_t i = 0; i < 9; i++) {
+        const uint32_t value = 100 + i;
+        queue.postWrite(i, i, std::as_bytes(std::span(&value, 1))); // the last one is read only
+    }
+    queue.postWrite(9, 2, std::as_bytes(std::span(&version, 1)));
+    for (uint32_t i = 0; i < 10; i++) {
+        queue.postRead(10 + i, 6 + i % 4, 4, std::endian::big);
+    }
+    queue.postRead(20, 0); // larger than the register
+    EXPECT_EQ(queue.drain(mount), 21);
+    EXPECT_EQ(regs[1], 101);
+    EXPECT_EQ(regs[2], 7); // writes stay in order
+    EXPECT_EQ(regs[7], 107);
+
+    VCompletion done[32];
+    ASSERT_EQ(queue.poll(done), 21);
+    for (uint32_t i = 0; i < 21; i++) {
+        EXPECT_EQ(done[i].tag, i);
+        EXPECT_EQ(done[i].ok, i != 8) << i;
+    }
+    EXPECT_EQ(done[10].payload[3], std::byte(106)); // big endian
+    EXPECT_EQ(done[12].payload[3], std::byte(7));
+    EXPECT_EQ(done[13].payload[3], std::byte(0x55));
+    EXPECT_EQ(done[14].payload[3], std::byte(106));
+    EXPECT_EQ(done[20].size, 4);
+    // ranges: writes 0..8 (stopping at the read only register), reads 6..8, 6..8 and 6..7.
+    // singles: the write to 2, both fifo reads and the oversized read
+    EXPECT_EQ(mount.ranges, 1 + 3);
+    EXPECT_EQ(mount.singles, 1 + 2 + 1);
+}
+
+TEST(VRequestQueue, invalidate) {
+    std::array<uint32_t, 4> words{};
+    std::array<uint16_t, 4> halves{};
+    VRangeBuilder wb("words"), hb("halves");
+    for (size_t i = 0; i < 4; i++) {
+        wb.add(VRegBuilder("word").buildBinder(words[i]));
+        hb.add(VRegBuilder("half").buildBinder(halves[i]));
+    }
+    VRange first = wb.build(), second = hb.build();
+    CountingMount a(first), b(second);
+    auto post = [](VRequestQueue<16> &queue) {
+        for (uint32_t i = 0; i < 4; i++) {
+            queue.postRead(i, i, 4);
+        }
+    };
+
+    VRequestQueue<16> queue;
+    VCompletion done[4];
+    post(queue);
+    EXPECT_EQ(queue.drain(a), 4); // not prepared, one at a time
+    EXPECT_EQ(a.singles, 4);
+    queue.prepare(a);
+    post(queue);
+    EXPECT_EQ(queue.drain(a), 4);
+    EXPECT_EQ(a.ranges, 1);
+    ASSERT_EQ(queue.poll(done), 4);
+    ASSERT_EQ(queue.poll(done), 4);
+
+    // the sizes of a are dropped, nothing of them is applied to b
+    queue.invalidate();
+    post(queue);
+    EXPECT_EQ(queue.drain(b), 4);
+    EXPECT_EQ(b.ranges, 0);
+    EXPECT_EQ(b.singles, 4);
+    ASSERT_EQ(queue.poll(done), 4);
+    for (const VCompletion &completion : done) {
+        EXPECT_TRUE(completion.ok);
+        EXPECT_EQ(completion.size, 2);
+    }
+}
+
+TEST(VRequestQueue, backpressure) {
+    uint8_t a = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("a").buildBinder(a));
+    VRange range = rb.build();
+
+    // completions are never dropped, requests wait for room
+    VRequestQueue<4> queue;
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.postRead(i, 0, 1));
+    }
+    EXPECT_EQ(queue.drain(range), 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.postRead(4 + i, 0, 1));
+    }
+    EXPECT_EQ(queue.drain(range), 0);
+    VCompletion done[2];
+    EXPECT_EQ(queue.poll(done), 2);
+    EXPECT_EQ(queue.drain(range), 2);
+    EXPECT_EQ(queue.pending(), 2);
+}
+} // namespace queue_test
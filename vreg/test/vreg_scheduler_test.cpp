@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace scheduler_test {
+struct Node {
+    std::array<uint16_t, 8> values{};
+    std::shared_ptr<VMap> map;
+    Node() {
+        VRangeBuilder rb("node");
+        for (auto &value : values) {
+            rb.add(VRegBuilder("value").buildBinder(value));
+        }
+        map = std::make_shared<VMap>(std::vector<VMap::pair>{{0x10, std::make_shared<VRange>(rb.build())}}, "map");
+    }
+};
+
+struct Log {
+    struct Entry {
+        uint32_t id;
+        uint64_t tick;
+        uint32_t failed;
+        std::vector<std::byte> bytes;
+    };
+    std::vector<Entry> entries;
+    size_t calls = 0;
+};
+
+TEST(VScheduler, periods) {
+    Node node;
+    Log log;
+    VScheduler scheduler(*node.map, [&](std::span<const VFrame> frames) {
+        log.calls++;
+        for (const auto &f : frames) {
+            log.entries.push_back({f.id, f.tick, f.failed, {f.bytes.begin(), f.bytes.end()}});
+        }
+    });
+    const addr_t fast[] = {0x10}, mid[] = {0x11, 0x12}, slow[] = {0x13};
+    const uint32_t a = scheduler.subscribe(fast, 1);
+    const uint32_t b = scheduler.subscribe(mid, 10, 3);
+    const uint32_t c = scheduler.subscribe(slow, 100, 50);
+    scheduler.advance(1000);
+
+    std::array<size_t, 3> counts{};
+    for (const auto &e : log.entries) {
+        counts[e.id]++;
+        const uint64_t period = e.id == a ? 1 : e.id == b ? 10 : 100;
+        const uint64_t phase = e.id == a ? 0 : e.id == b ? 3 : 50;
+        EXPECT_EQ(e.tick % period, phase) << e.id;
+    }
+    EXPECT_EQ(counts[a], 1000);
+    EXPECT_EQ(counts[b], 100);
+    EXPECT_EQ(counts[c], 10);
+    EXPECT_EQ(log.calls, 1000); // one batch per tick
+
+    scheduler.unsubscribe(a);
+    log.entries.clear();
+    scheduler.advance(10);
+    EXPECT_EQ(log.entries.size(), 1);
+}
+
+TEST(VScheduler, frames) {
+    Node node;
+    node.values = {1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<Log::Entry> entries;
+    VScheduler scheduler(
+        *node.map,
+        [&](std::span<const VFrame> frames) {
+            for (const auto &f : frames) {
+                entries.push_back({f.id, f.tick, f.failed, {f.bytes.begin(), f.bytes.end()}});
+            }
+        },
+        std::endian::big);
+    const addr_t group[] = {0x12, 0x13, 0x14, 0x17, 0x40, 0x10};
+    scheduler.subscribe(group, 5);
+    scheduler.advance(5);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].tick, 5);
+    EXPECT_EQ(entries[0].failed, 1); // 0x40 is unmapped
+    const std::vector<std::byte> expect = {std::byte(0), std::byte(3), std::byte(0), std::byte(4),
+                                           std::byte(0), std::byte(5), std::byte(0), std::byte(8),
+                                           std::byte(0), std::byte(1)};
+    EXPECT_EQ(entries[0].bytes, expect);
+
+    // values are read when due
+    node.values[0] = 0x0102;
+    scheduler.advance(5);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[1].bytes[8], std::byte(1));
+    EXPECT_EQ(entries[1].bytes[9], std::byte(2));
+}
+
+TEST(VScheduler, largeRegister) {
+    std::array<uint16_t, 64> samples{}; // 128 bytes
+    samples[63] = 0x0102;
+    uint16_t status = 0x0304;
+    VRangeBuilder rb("node");
+    rb.add(VRegBuilder("samples").buildBinder(samples));
+    rb.add(VRegBuilder("status").buildBinder(status));
+    VRange range = rb.build();
+    std::vector<Log::Entry> entries;
+    VScheduler scheduler(range, [&](std::span<const VFrame> frames) {
+        for (const auto &f : frames) {
+            entries.push_back({f.id, f.tick, f.failed, {f.bytes.begin(), f.bytes.end()}});
+        }
+    });
+    const addr_t group[] = {0, 1};
+    scheduler.subscribe(group, 1);
+    scheduler.advance(1);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].failed, 0);
+    ASSERT_EQ(entries[0].bytes.size(), sizeof(samples) + sizeof(status));
+    uint16_t last, tail;
+    memcpy(&last, entries[0].bytes.data() + sizeof(samples) - 2, 2);
+    memcpy(&tail, entries[0].bytes.data() + sizeof(samples), 2);
+    EXPECT_EQ(last, 0x0102);
+    EXPECT_EQ(tail, 0x0304);
+}
+
+TEST(VScheduler, subscribeReadsNothing) {
+    uint16_t status = 0x0304;
+    uint32_t counter = 0;
+    size_t reads = 0;
+    VRangeBuilder rb("node");
+    rb.add(VRegBuilder("status").buildBinder(status));
+    rb.add(VRegBuilder("counter").buildRO([&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+        reads++;
+        return VRegBinder(counter, "").read(bytes, endian);
+    }));
+    VRange range = rb.build();
+    std::vector<Log::Entry> entries;
+    VScheduler scheduler(range, [&](std::span<const VFrame> frames) {
+        for (const auto &f : frames) {
+            entries.push_back({f.id, f.tick, f.failed, {f.bytes.begin(), f.bytes.end()}});
+        }
+    });
+    const addr_t group[] = {0, 1};
+    scheduler.subscribe(group, 2);
+    EXPECT_EQ(reads, 0);
+    scheduler.advance(2);
+    EXPECT_EQ(reads, 1); // only when due
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].failed, 0); // the callback fits unsized_reserve
+    EXPECT_EQ(entries[0].bytes.size(), sizeof(status) + sizeof(counter));
+}
+
+TEST(VScheduler, longPeriods) {
+    Node node;
+    std::vector<uint64_t> ticks;
+    VScheduler scheduler(*node.map, [&](std::span<const VFrame> frames) {
+        for (const auto &f : frames) {
+            ticks.push_back(f.tick);
+        }
+    });
+    const addr_t addr[] = {0x10};
+    scheduler.advance(70); // not aligned to the wheel
+    scheduler.subscribe(addr, 300000, 7);                // upper levels
+    scheduler.subscribe(addr, (uint64_t(1) << 24) + 5); // beyond the wheel
+    scheduler.advance((uint64_t(1) << 24) + 100);
+    std::vector<uint64_t> expect;
+    for (uint64_t t = 300007; t <= scheduler.now(); t += 300000) {
+        expect.push_back(t);
+    }
+    expect.push_back((uint64_t(1) << 24) + 5);
+    std::ranges::sort(expect);
+    EXPECT_EQ(ticks, expect);
+}
+
+} // namespace scheduler_test
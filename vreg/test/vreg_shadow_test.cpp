@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace shadow_test {
+struct Pid {
+    float kp = 1, ki = 0, kd = 0;
+    uint32_t limit = 100;
+};
+
+TEST(VShadowBank, commit) {
+    VShadowBank<Pid> bank;
+    VRangeBuilder rb("pid");
+    rb.add(VRegBuilder("kp").buildBinder(bank.staging().kp));
+    rb.add(VRegBuilder("ki").buildBinder(bank.staging().ki));
+    rb.add(VRegBuilder("limit").buildBinder(bank.staging().limit));
+    rb.add(bank.commitReg());
+    VMap map({{0x10, std::make_shared<VRange>(rb.build())}}, "map");
+
+    const float kp = 2, ki = 0.5f;
+    const uint32_t limit = 50;
+    map.writeAt(0x10, std::as_bytes(std::span(&kp, 1)));
+    map.writeAt(0x11, std::as_bytes(std::span(&ki, 1)));
+    map.writeAt(0x12, std::as_bytes(std::span(&limit, 1)));
+    // staged only
+    EXPECT_EQ(bank.load().kp, 1);
+    EXPECT_EQ(bank.load().limit, 100);
+    EXPECT_EQ(bank.staging().limit, 50);
+
+    const std::byte go{1};
+    EXPECT_EQ(map.writeAt(0x13, std::span(&go, 1)), 1);
+    const Pid pid = bank.load();
+    EXPECT_EQ(pid.kp, 2);
+    EXPECT_EQ(pid.ki, 0.5f);
+    EXPECT_EQ(pid.limit, 50);
+    uint32_t commits = 0;
+    EXPECT_EQ(map.readAt(0x13, std::as_writable_bytes(std::span(&commits, 1))), 4);
+    EXPECT_EQ(commits, 1);
+
+    bank.staging().kp = 9;
+    bank.rollback();
+    EXPECT_EQ(bank.staging().kp, 2);
+}
+
+TEST(VShadowBank, concurrent) {
+    struct Set {
+        uint64_t a, b, c, d;
+    };
+    VShadowBank<Set> bank(Set{0, 0, 0, 0});
+    std::atomic<bool> done = false;
+    std::atomic<size_t> torn = 0, loads = 0;
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 2; t++) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                const Set s = bank.load();
+                torn += !(s.a == s.b && s.b == s.c && s.c == s.d);
+                loads++;
+            }
+        });
+    }
+    for (uint64_t i = 1; i <= 20000; i++) {
+        bank.staging() = {i, i, i, i};
+        bank.commit();
+        if (i % 256 == 0)
+            std::this_thread::yield();
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(torn, 0);
+    EXPECT_GT(loads, 0);
+    EXPECT_EQ(bank.load().d, 20000);
+    EXPECT_EQ(bank.commits(), 20000);
+}
+TEST(VShadowMount, commit) {
+    Pid pid;
+    VRangeBuilder rb("pid");
+    rb.add(VRegBuilder("kp").buildBinder(pid.kp));
+    rb.add(VRegBuilder("ki").buildBinder(pid.ki));
+    rb.add(VRegBuilder("limit").buildBinder(pid.limit));
+    rb.add(VRegBuilder("version").buildConst(uint16_t(3)));
+    VShadowMount shadow(std::make_shared<VMap>(std::vector<VMap::pair>{{0x10, std::make_shared<VRange>(rb.build())}},
+                                               "map"));
+    EXPECT_EQ(shadow.registers(), 4);
+
+    const float kp = 2;
+    const uint32_t limit = 50, limit_be = vregex::byteswap(limit);
+    EXPECT_EQ(shadow.writeAt(0x10, std::as_bytes(std::span(&kp, 1))), 4);
+    EXPECT_EQ(shadow.writeAt(0x12, std::as_bytes(std::span(&limit_be, 1)), std::endian::big), 4);
+    EXPECT_FALSE(shadow.writeAt(0x20, std::as_bytes(std::span(&limit, 1))));
+    EXPECT_TRUE(shadow.staged(0x12));
+    // staged only
+    EXPECT_EQ(pid.kp, 1);
+    uint32_t value = 0;
+    EXPECT_EQ(shadow.readAt(0x12, std::as_writable_bytes(std::span(&value, 1))), 4);
+    EXPECT_EQ(value, 100);
+
+    EXPECT_EQ(shadow.commit(), 0);
+    EXPECT_EQ(pid.kp, 2);
+    EXPECT_EQ(pid.limit, 50);
+    EXPECT_FALSE(shadow.staged(0x12));
+    EXPECT_EQ(shadow.readAt(0x12, std::as_writable_bytes(std::span(&value, 1)), std::endian::big), 4);
+    EXPECT_EQ(value, vregex::byteswap(uint32_t(50)));
+
+    // one readRange, one commit
+    std::array<std::byte, 4 + 4 + 4 + 2> group;
+    const range_result result = shadow.readRange(0x10, 4, group);
+    EXPECT_EQ(result.bytes, group.size());
+    float read_kp;
+    memcpy(&read_kp, group.data(), sizeof(read_kp));
+    EXPECT_EQ(read_kp, 2);
+
+    // a read-only register fails at commit
+    const uint16_t version = 4;
+    EXPECT_TRUE(shadow.writeAt(0x13, std::as_bytes(std::span(&version, 1))));
+    EXPECT_EQ(shadow.commit(), 1);
+    EXPECT_EQ(shadow.commits(), 2);
+
+    EXPECT_TRUE(shadow.writeAt(0x10, std::as_bytes(std::span(&read_kp, 1))));
+    shadow.rollback();
+    EXPECT_FALSE(shadow.staged(0x10));
+}
+
+TEST(VShadowMount, callbacksReadOnce) {
+    uint32_t bound = 1, value = 0x01020304;
+    size_t reads = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("bound").buildBinder(bound));
+    rb.add(VRegBuilder("fifo").buildRW(
+        [&](std::span<const std::byte> bytes, std::endian endian) -> size_opt {
+            return VRegBinder(value, "").write(bytes, endian);
+        },
+        [&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+            reads++;
+            return VRegBinder(value, "").read(bytes, endian);
+        }));
+    VShadowMount shadow(std::make_shared<VRange>(rb.build()));
+    EXPECT_EQ(reads, 1); // sized and captured by one read
+
+    const uint32_t two = 2;
+    EXPECT_EQ(shadow.writeAt(0, std::as_bytes(std::span(&two, 1))), 4);
+    EXPECT_EQ(shadow.writeAt(1, std::as_bytes(std::span(&two, 1))), 4);
+    EXPECT_EQ(shadow.commit(), 0);
+    EXPECT_EQ(reads, 2); // the binder is copied from memory
+
+    // served from the copy in the native endian, forwarded in the other
+    uint32_t out = 0;
+    EXPECT_EQ(shadow.readAt(1, std::as_writable_bytes(std::span(&out, 1))), 4);
+    EXPECT_EQ(out, 2);
+    EXPECT_EQ(reads, 2);
+    EXPECT_EQ(shadow.readAt(1, std::as_writable_bytes(std::span(&out, 1)), std::endian::big), 4);
+    EXPECT_EQ(out, vregex::byteswap(uint32_t(2)));
+    EXPECT_EQ(reads, 3);
+    std::array<uint32_t, 2> both{};
+    EXPECT_EQ(shadow.readRange(0, 2, std::as_writable_bytes(std::span(both)), {}, std::endian::big).bytes, 8);
+    EXPECT_EQ(both[0], vregex::byteswap(uint32_t(2)));
+    EXPECT_EQ(both[1], vregex::byteswap(uint32_t(2)));
+    EXPECT_EQ(reads, 4);
+}
+
+TEST(VShadowMount, commitReg) {
+    uint32_t a = 0, b = 0;
+    VRangeBuilder rb("set");
+    rb.add(VRegBuilder("a").buildBinder(a));
+    rb.add(VRegBuilder("b").buildBinder(b));
+    VShadowMount shadow(std::make_shared<VRange>(rb.build()));
+    auto commit = shadow.commitReg();
+    const uint32_t one = 1;
+    shadow.writeAt(0, std::as_bytes(std::span(&one, 1)));
+    const std::byte go{1};
+    EXPECT_EQ(commit->write(std::span(&go, 1)), 1);
+    EXPECT_EQ(a, 1);
+    uint32_t commits = 0;
+    EXPECT_EQ(commit->read(std::as_writable_bytes(std::span(&commits, 1))), 4);
+    EXPECT_EQ(commits, 1);
+}
+
+TEST(VShadowMount, concurrent) {
+    std::array<uint64_t, 4> set{};
+    VRangeBuilder rb("set");
+    for (auto &value : set) {
+        rb.add(VRegBuilder("value").buildBinder(value));
+    }
+    VShadowMount shadow(std::make_shared<VRange>(rb.build()));
+    std::atomic<bool> done = false;
+    std::atomic<size_t> torn = 0, loads = 0;
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 2; t++) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                std::array<uint64_t, 4> s;
+                shadow.readRange(0, 4, std::as_writable_bytes(std::span(s)));
+                torn += !(s[0] == s[1] && s[1] == s[2] && s[2] == s[3]);
+                loads++;
+            }
+        });
+    }
+    for (uint64_t i = 1; i <= 20000; i++) {
+        for (addr_t addr = 0; addr < 4; addr++) {
+            shadow.writeAt(addr, std::as_bytes(std::span(&i, 1)));
+        }
+        shadow.commit();
+        if (i % 256 == 0)
+            std::this_thread::yield();
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(torn, 0);
+    EXPECT_GT(loads, 0);
+    EXPECT_EQ(set[3], 20000);
+}
+} // namespace shadow_test
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace shard_test {
+constexpr size_t ranges = 4, regs = 8;
+
+struct Fixture {
+    std::array<std::array<uint32_t, regs>, ranges> values{};
+    std::shared_ptr<VMap> map;
+
+    Fixture() {
+        std::vector<VMap::pair> entries;
+        for (size_t r = 0; r < ranges; r++) {
+            VRangeBuilder rb("range");
+            for (auto &value : values[r]) {
+                rb.add(VRegBuilder("value").buildBinder(value));
+            }
+            entries.push_back({r * 0x100, std::make_shared<VRange>(rb.build())});
+        }
+        map = std::make_shared<VMap>(std::move(entries), "map");
+    }
+};
+
+TEST(VShardServer, routing) {
+    Fixture fixture;
+    VShardServer server(*fixture.map, 3);
+    EXPECT_EQ(server.shards(), 3);
+    EXPECT_EQ(server.shardOf(0x000), 0);
+    EXPECT_EQ(server.shardOf(0x107), 1);
+    EXPECT_EQ(server.shardOf(0x200), 2);
+    EXPECT_EQ(server.shardOf(0x305), 2);
+    EXPECT_EQ(server.shardOf(0x050), 0); // unmapped
+    EXPECT_FALSE(server.shard(2).find(0x100).has_value());
+
+    // more shards than mounts
+    EXPECT_EQ(VShardServer(*fixture.map, 16).shards(), ranges);
+
+    // single threaded
+    const uint32_t value = 42;
+    EXPECT_TRUE(server.postWrite(1, 0x203, std::as_bytes(std::span(&value, 1))));
+    EXPECT_TRUE(server.postRead(2, 0x050, 4));
+    EXPECT_EQ(server.drain(), 2);
+    std::array<VCompletion, 4> completions;
+    ASSERT_EQ(server.poll(completions), 2);
+    for (const auto &completion : std::span(completions).first(2)) {
+        EXPECT_EQ(completion.ok, completion.tag == 1);
+    }
+    EXPECT_EQ(fixture.values[2][3], 42);
+}
+
+TEST(VShardServer, workers) {
+    constexpr size_t producers = 2, count = 2000;
+    Fixture fixture;
+    VShardServer server(*fixture.map, 2);
+    server.start();
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (uint32_t i = 0; i < count; i++) {
+                // producer p owns registers p and p + 2 of every range
+                const addr_t addr = addr_t(i % ranges * 0x100 + p + i / ranges % 2 * 2);
+                const uint32_t value = p << 24 | i;
+                while (!server.postWrite(p << 24 | i, addr, std::as_bytes(std::span(&value, 1)))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    size_t received = 0, failed = 0;
+    std::array<VCompletion, 32> completions;
+    while (received < producers * count) {
+        const size_t n = server.poll(completions);
+        for (const auto &completion : std::span(completions).first(n)) {
+            failed += !completion.ok;
+        }
+        received += n;
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    server.stop();
+    EXPECT_EQ(failed, 0);
+    EXPECT_EQ(server.pending(), 0);
+    // the last write of each register
+    for (uint32_t p = 0; p < producers; p++) {
+        for (uint32_t i = count - 2 * ranges; i < count; i++) {
+            const size_t reg = p + i / ranges % 2 * 2;
+            EXPECT_EQ(fixture.values[i % ranges][reg], p << 24 | i);
+        }
+    }
+}
+
+TEST(VShardServer, idleWorkersPark) {
+    Fixture fixture;
+    VShardServer server(*fixture.map, ranges);
+    // polls until count workers are parked, gives up after about 10 s
+    auto parked = [&](size_t count) {
+        for (size_t i = 0; i < 10000 && server.parked() != count; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return server.parked();
+    };
+    EXPECT_EQ(server.parked(), 0);
+    server.start();
+    EXPECT_EQ(parked(ranges), ranges);
+
+    // a post wakes the owning worker, which parks again when its queue is empty
+    std::array<VCompletion, 1> completions;
+    for (uint32_t i = 0; i < ranges; i++) {
+        const uint32_t value = i + 1;
+        EXPECT_TRUE(server.postWrite(i, addr_t(i * 0x100), std::as_bytes(std::span(&value, 1))));
+        while (server.poll(completions) == 0) {
+            std::this_thread::yield();
+        }
+        EXPECT_TRUE(completions[0].ok);
+        EXPECT_EQ(fixture.values[i][0], i + 1);
+        EXPECT_EQ(parked(ranges), ranges);
+    }
+    server.stop();
+    EXPECT_EQ(server.parked(), 0);
+}
+
+} // namespace shard_test
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace snapshot_test {
+struct Params {
+    uint32_t gain = 100;
+    uint16_t limit = 200;
+    int64_t offset = -300;
+    uint8_t sink = 0;
+
+    VMap map() {
+        VRangeBuilder rb("range");
+        rb.add(VRegBuilder("limit").buildBinder(limit));
+        rb.add(VRegBuilder("version").buildConst(uint16_t(7)));
+        rb.add(VRegBuilder("sink").buildWO([this](std::span<const std::byte> bytes, std::endian) -> size_opt {
+            sink = uint8_t(bytes[0]);
+            return 1;
+        }));
+        return VMap(std::vector<VMap::pair>{
+                        {0x00, VRegBuilder("gain").buildBinder(gain)},
+                        {0x10, std::make_shared<VRange>(rb.build())},
+                        {0x1000, VRegBuilder("offset").buildBinder(offset)},
+                    },
+                    "params");
+    }
+};
+
+TEST(VSnapshot, captureRestore) {
+    Params params;
+    VMap map = params.map();
+    VSnapshot snapshot(map);
+    ASSERT_EQ(snapshot.layout().size(), 4); // sink is write only
+    EXPECT_EQ(snapshot.layout()[1].addr, 0x10);
+    EXPECT_EQ(snapshot.layout()[3].offset, 4 + 2 + 2);
+    EXPECT_EQ(snapshot.imageSize(), sizeof(VSnapshot::Header) + 4 + 2 + 2 + 8);
+
+    std::vector<std::byte> image(snapshot.imageSize());
+    EXPECT_EQ(snapshot.capture(image), image.size());
+    EXPECT_FALSE(snapshot.capture(std::span(image).first(10)));
+
+    params.gain = 1, params.limit = 2, params.offset = 3;
+    EXPECT_EQ(snapshot.restore(image), 3); // the const is skipped
+    EXPECT_EQ(params.gain, 100);
+    EXPECT_EQ(params.limit, 200);
+    EXPECT_EQ(params.offset, -300);
+}
+
+TEST(VSnapshot, largeRegister) {
+    std::array<uint8_t, 128> table;
+    uint32_t gain = 1;
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = uint8_t(i);
+    }
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("table").buildBinder(table));
+    rb.add(VRegBuilder("gain").buildBinder(gain));
+    VRange range = rb.build();
+    VSnapshot snapshot(range);
+    ASSERT_EQ(snapshot.layout().size(), 2);
+    EXPECT_EQ(snapshot.layout()[0].size, 128);
+    EXPECT_EQ(snapshot.layout()[1].offset, 128);
+
+    std::vector<std::byte> image(snapshot.imageSize());
+    EXPECT_EQ(snapshot.capture(image), image.size());
+    table.fill(0), gain = 0;
+    EXPECT_EQ(snapshot.restore(image), 2);
+    EXPECT_EQ(table[127], 127);
+    EXPECT_EQ(gain, 1);
+}
+
+TEST(VSnapshot, callbacksNotRead) {
+    uint32_t gain = 1;
+    size_t reads = 0;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("gain").buildBinder(gain));
+    rb.add(VRegBuilder("fifo").buildRO([&](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+        reads++;
+        return VRegBinder(gain, "").read(bytes, endian);
+    }));
+    VRange range = rb.build();
+    VSnapshot snapshot(range);
+    EXPECT_EQ(reads, 0);
+    ASSERT_EQ(snapshot.layout().size(), 1); // only registers with a known size
+    std::vector<std::byte> image(snapshot.imageSize());
+    EXPECT_EQ(snapshot.capture(image), image.size());
+    EXPECT_EQ(reads, 0);
+}
+
+TEST(VSnapshot, reject) {
+    Params params;
+    VMap map = params.map();
+    VSnapshot snapshot(map);
+    std::vector<std::byte> image(snapshot.imageSize());
+    snapshot.capture(image);
+
+    // another layout
+    uint32_t other = 0;
+    VRangeBuilder rb("other");
+    rb.add(VRegBuilder("other").buildBinder(other));
+    VRange range = rb.build();
+    EXPECT_FALSE(VSnapshot(range).restore(image));
+
+    EXPECT_FALSE(snapshot.restore(std::span(image).first(image.size() - 1)));
+    image[0] = std::byte('X');
+    EXPECT_FALSE(snapshot.restore(image));
+}
+
+TEST(VSnapshot, foreignEndian) {
+    Params params;
+    VMap map = params.map();
+    VSnapshot snapshot(map);
+    std::vector<std::byte> image(snapshot.imageSize());
+    snapshot.capture(image);
+
+    // the same image written by a host of the other endian
+    VSnapshot::Header header;
+    memcpy(&header, image.data(), sizeof(header));
+    header.big_endian = !header.big_endian;
+    header.count = vregex::byteswap(header.count);
+    header.data_size = vregex::byteswap(header.data_size);
+    header.layout = vregex::byteswap(header.layout);
+    memcpy(image.data(), &header, sizeof(header));
+    for (const auto &entry : snapshot.layout()) {
+        auto data = std::span(image).subspan(sizeof(header) + entry.offset, entry.size);
+        std::reverse(data.begin(), data.end());
+    }
+
+    params.gain = 1, params.offset = 3;
+    EXPECT_EQ(snapshot.restore(image), 3);
+    EXPECT_EQ(params.gain, 100);
+    EXPECT_EQ(params.offset, -300);
+}
+
+#ifdef VREGEX_HAS_MMAP
+TEST(VSnapshot, file) {
+    const std::string path = testing::TempDir() + "vreg_snapshot_test.bin";
+    Params params;
+    VMap map = params.map();
+    VSnapshot snapshot(map);
+    EXPECT_EQ(snapshot.save(path.c_str()), snapshot.imageSize());
+
+    params.gain = 1, params.limit = 2;
+    EXPECT_EQ(snapshot.load(path.c_str()), 3);
+    EXPECT_EQ(params.gain, 100);
+    EXPECT_EQ(params.limit, 200);
+    EXPECT_FALSE(snapshot.load((path + ".missing").c_str()));
+    std::remove(path.c_str());
+}
+#endif
+} // namespace snapshot_test
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace static_test {
+TEST(StaticVRange, StaticVRange) {
+    int a = 0;
+    uint16_t b = 0x1122;
+    bool r = false;
+    StaticVRange range("range", "desc", VRegBinder(a, "a"), VRegBinder(b, "b"), VRegConst(3, "c"),
+                       VRegRO(
+                           [&r](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+                               (void)bytes, (void)endian;
+                               r = true;
+                               return 0;
+                           },
+                           "ro"));
+    static_assert(decltype(range)::extent == 4);
+    EXPECT_EQ(range.name_, "range");
+    EXPECT_EQ(range.desc_, "desc");
+    EXPECT_EQ(range.size(), 4);
+
+    // runtime address
+    std::byte buf[sizeof(int)];
+    const int aa = 2;
+    memcpy(buf, &aa, sizeof(buf));
+    EXPECT_EQ(range.writeAt(0, buf), sizeof(int));
+    EXPECT_EQ(a, aa);
+    EXPECT_EQ(range.readAt(1, buf, std::endian::big), sizeof(uint16_t));
+    EXPECT_EQ(buf[0], std::byte{0x11});
+    EXPECT_EQ(buf[1], std::byte{0x22});
+    EXPECT_EQ(range.writeAt(2, buf), std::nullopt);
+    EXPECT_EQ(range.readAt(3, buf), 0);
+    EXPECT_TRUE(r);
+
+    // out of range
+    EXPECT_EQ(range.readAt(4, buf), std::nullopt);
+    EXPECT_EQ(range.writeAt(4, buf), std::nullopt);
+
+    // compile-time address
+    int c = 0;
+    EXPECT_EQ(range.readAt<2>(buf), sizeof(int));
+    memcpy(&c, buf, sizeof(c));
+    EXPECT_EQ(c, 3);
+    EXPECT_EQ(range.at<0>().name_, "a");
+}
+
+TEST(StaticVMap, StaticVMap) {
+    int a = 1, b = 2, c = 3;
+    StaticVMap inner("inner", "", mountAt<0>(VRegBinder(c, "c")));
+    StaticVMap map("map", "desc", mountAt<0x10>(StaticVRange("range", "", VRegBinder(a, "a"), VRegBinder(b, "b"))),
+                   mountAt<0x2>(VRegConst(4, "const")), mountAt<0x20>(std::move(inner)));
+    static_assert(decltype(map)::extent == 0x21);
+    EXPECT_EQ(map.name_, "map");
+    EXPECT_TRUE(map.has(0x10));
+    EXPECT_FALSE(map.has(0x12));
+
+    int v = 0;
+    std::byte buf[sizeof(int)];
+    EXPECT_EQ(map.readAt(0x11, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, 2);
+    EXPECT_EQ(map.readAt(0x2, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, 4);
+
+    v = 5;
+    memcpy(buf, &v, sizeof(v));
+    EXPECT_EQ(map.writeAt(0x20, buf), sizeof(int));
+    EXPECT_EQ(map.at<2>().at<0>().binder_, 5);
+    EXPECT_EQ(map.writeAt<0x10>(buf), sizeof(int));
+    EXPECT_EQ(a, 5);
+
+    // unmapped
+    EXPECT_EQ(map.readAt(0x0, buf), std::nullopt);
+    EXPECT_EQ(map.readAt(0x12, buf), std::nullopt);
+    EXPECT_EQ(map.writeAt(0x21, buf), std::nullopt);
+}
+TEST(StaticVMap, sparse) {
+    int a = 1, b = 2;
+    StaticVMap map("map", "", mountAt<0x1fffffff>(VRegBinder(a, "a")), mountAt<0x100>(VRegBinder(b, "b")));
+    static_assert(decltype(map)::extent == 0x20000000);
+
+    int v = 0;
+    std::byte buf[sizeof(int)];
+    EXPECT_EQ(map.readAt(0x1fffffff, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, 1);
+    EXPECT_EQ(map.readAt(0x100, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, 2);
+    EXPECT_EQ(map.readAt(0x101, buf), std::nullopt);
+    EXPECT_EQ(map.readAt(0xff, buf), std::nullopt);
+}
+} // namespace static_test
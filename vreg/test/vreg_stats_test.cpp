@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace stats_test {
+TEST(VStatsMount, counters) {
+    int a = 1, b = 2;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("a").buildBinder(a));
+    rb.add(VRegBuilder("ro").buildBinderRO(b));
+    VStatsMount<> stats(std::make_shared<VRange>(rb.build()));
+
+    std::byte buf[4]{};
+    EXPECT_TRUE(stats.readAt(0, buf));
+    EXPECT_TRUE(stats.readAt(0, buf));
+    EXPECT_TRUE(stats.writeAt(0, buf));
+    EXPECT_FALSE(stats.writeAt(1, buf));
+    EXPECT_FALSE(stats.readAt(5, buf));
+    EXPECT_EQ(a, 1);
+
+    const VAccessStats s0 = stats.table().stats(0), s1 = stats.table().stats(1);
+    EXPECT_EQ(s0.reads, 2);
+    EXPECT_EQ(s0.writes, 1);
+    EXPECT_EQ(s0.read_failures, 0);
+    EXPECT_EQ(s1.writes, 1);
+    EXPECT_EQ(s1.write_failures, 1);
+    EXPECT_EQ(stats.table().outside().read_failures, 1);
+
+    // the same counters over a register range
+    VRange range = stats.table().statsRange();
+    EXPECT_EQ(range.size(), 4 * 3);
+    uint64_t value;
+    EXPECT_TRUE(range.readAt(0, std::as_writable_bytes(std::span(&value, 1))));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(range.readAt(4 + 3, std::as_writable_bytes(std::span(&value, 1)), std::endian::big));
+    EXPECT_EQ(value, vregex::byteswap(uint64_t(1)));
+    EXPECT_FALSE(range.writeAt(0, std::as_bytes(std::span(&value, 1))));
+
+    stats.table().reset();
+    EXPECT_EQ(stats.table().stats(0).reads, 0);
+}
+
+TEST(VStatsMount, sparse) {
+    uint32_t a = 1, b = 2;
+    // 29-bit like CAN IDs, counters are kept per register
+    VStatsMount<true> stats(std::make_shared<VMap>(std::vector<VMap::pair>{
+        {0x100, VRegBuilder("a").buildBinder(a)},
+        {0x1fff0000, VRegBuilder("b").buildBinder(b)},
+    }, "map"));
+    EXPECT_EQ(stats.table().registers(), 2);
+    EXPECT_EQ(stats.table().addr(1), 0x1fff0000);
+
+    std::byte buf[4]{};
+    EXPECT_TRUE(stats.readAt(0x1fff0000, buf));
+    EXPECT_FALSE(stats.readAt(0x101, buf));
+    EXPECT_EQ(stats.table().stats(0x1fff0000).reads, 1);
+    EXPECT_EQ(stats.table().stats(0x100).reads, 0);
+    EXPECT_EQ(stats.table().outside().read_failures, 1);
+    EXPECT_EQ(stats.table().statsRange().size(), 4 * 3);
+    EXPECT_EQ(stats.table().histogramRange().size(), 2 * VLatencyHistogram::buckets * 3);
+}
+
+TEST(VStatsMount, latency) {
+    VStatsMount<true> stats(VRegBuilder("slow").buildRO([](std::span<std::byte> bytes, std::endian) -> size_opt {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return bytes.size();
+    }));
+    std::byte buf[1];
+    for (int i = 0; i < 4; i++) {
+        stats.readAt(0, buf);
+    }
+    const auto &histogram = stats.table().histogram(0);
+    uint64_t total = 0, slow = 0;
+    for (size_t b = 0; b < VLatencyHistogram::buckets; b++) {
+        total += histogram.reads[b];
+        slow += b > std::bit_width(uint64_t(100000)) - 1 ? histogram.reads[b].load() : 0;
+    }
+    EXPECT_EQ(total, 4);
+    EXPECT_EQ(slow, 4); // at least 100us each
+    EXPECT_EQ(stats.table().histogramRange().size(), 2 * VLatencyHistogram::buckets * 2);
+}
+
+TEST(VStatsMount, withStats) {
+    int a = 0;
+    auto reg = withStats(VRegBuilder("a").buildBinder(a));
+    static_assert(std::is_same_v<decltype(reg), std::shared_ptr<VRegBase>>);
+    VRangeBuilder rb("range");
+    rb.add(std::shared_ptr<VRegBase>(reg));
+    auto range = withStats(std::make_shared<VRange>(rb.build()));
+    std::byte buf[4]{};
+    range->readAt(0, buf);
+#ifdef VREG_NO_STATS
+    EXPECT_FALSE(std::dynamic_pointer_cast<VStatsMount<>>(range));
+#else
+    EXPECT_EQ(std::dynamic_pointer_cast<VStatsMount<>>(range)->table().stats(0).reads, 1);
+    EXPECT_EQ(std::dynamic_pointer_cast<VStatsReg<>>(reg)->table().stats(0).reads, 1);
+#endif
+}
+
+TEST(VStatsMount, concurrent) {
+    std::atomic<uint32_t> value{0};
+    VStatsMount<> stats(std::make_shared<VRegBinder<std::atomic<uint32_t>>>(value, "value"));
+    constexpr size_t threads = 4, count = 10000;
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            std::byte buf[4];
+            for (size_t i = 0; i < count; i++) {
+                stats.readAt(0, buf);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(stats.table().stats(0).reads, threads * count);
+}
+} // namespace stats_test
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace table_test {
+struct Fixture {
+    uint32_t value = 0x12345678;
+    uint16_t ro = 0xabcd;
+    std::array<uint16_t, 2> pair{1, 2};
+    uint8_t calls = 0;
+
+    VRangeBuilder builder() {
+        VRangeBuilder rb("range", "desc");
+        rb.add(VRegBuilder("value", "bound").buildBinder(value));
+        rb.add(VRegBuilder("ro").buildBinderRO(ro));
+        rb.add(VRegBuilder("const").buildConst(uint8_t(7)));
+        rb.add(VRegBuilder("pair").buildBinder(pair));
+        rb.add(VRegBuilder("reserved").buildReserved());
+        rb.add(VRegBuilder("calls").buildRO([this](std::span<std::byte> bytes, std::endian) -> size_opt {
+            if (bytes.empty())
+                return std::nullopt;
+            bytes[0] = std::byte(++calls);
+            return 1;
+        }));
+        return rb;
+    }
+};
+
+TEST(VTable, sameAsVRange) {
+    Fixture fixture;
+    VRange range = fixture.builder().build();
+    VTable table = fixture.builder().buildTable();
+    ASSERT_EQ(table.size(), range.size());
+    for (addr_t addr = 0; addr <= table.size(); addr++) {
+        for (const auto endian : {std::endian::little, std::endian::big}) {
+            std::array<std::byte, 8> a{}, b{};
+            const size_opt ra = range.readAt(addr, a, endian), rb = table.readAt(addr, b, endian);
+            EXPECT_EQ(ra, rb) << addr;
+            if (addr != 5) {
+                EXPECT_EQ(a, b) << addr;
+            }
+        }
+    }
+    EXPECT_EQ(fixture.calls, 4);
+
+    const uint32_t in = 0x11223344;
+    EXPECT_EQ(table.writeAt(0, std::as_bytes(std::span(&in, 1)), std::endian::big), 4);
+    EXPECT_EQ(fixture.value, 0x44332211);
+    const std::array<uint16_t, 2> pair{0x0102, 0x0304};
+    EXPECT_EQ(table.writeAt(3, std::as_bytes(std::span(pair)), std::endian::big), 4);
+    EXPECT_EQ(fixture.pair[1], 0x0403);
+    EXPECT_EQ(table.writeAt(1, std::as_bytes(std::span(&in, 1))), std::nullopt);
+    EXPECT_EQ(fixture.ro, 0xabcd);
+    EXPECT_EQ(table.writeAt(6, std::as_bytes(std::span(&in, 1))), std::nullopt);
+}
+
+TEST(VTable, layout) {
+    Fixture fixture;
+    VTable table = fixture.builder().buildTable();
+    EXPECT_EQ(table.flags(0), VTable::present | VTable::writable | VTable::storage);
+    EXPECT_EQ(table.flags(1), VTable::present | VTable::storage);
+    EXPECT_EQ(table.flags(5) & VTable::storage, 0);
+    EXPECT_EQ(table.flags(9), 0);
+    EXPECT_EQ(table.regSize(3), 4);
+    EXPECT_EQ(table.name(0), "value");
+    EXPECT_EQ(table.desc(0), "bound");
+    EXPECT_EQ(table.name_, "range");
+
+    // storage is viewed in place
+    const view_opt view = table.viewAt(0);
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view->data(), (const std::byte *)&fixture.value);
+    std::array<std::byte, 4> scratch;
+    EXPECT_EQ(table.viewAt(5, scratch)->size(), 1);
+
+    std::array<std::byte, 32> bytes;
+    std::array<uint64_t, 1> words{~uint64_t(0)};
+    const range_result result = table.readRange(0, 8, bytes, VBitmap(words));
+    EXPECT_EQ(result.count, 8);
+    EXPECT_EQ(result.bytes, 4 + 2 + 1 + 4 + 1);
+    EXPECT_EQ(words[0] & 0xff, 0b00101111); // reserved and unmapped fail
+
+    EXPECT_EQ(impl::leafAddrs(table), (std::vector<addr_t>{0, 1, 2, 3, 4, 5}));
+    VMap map({{0x100, std::make_shared<VTable>(fixture.builder().buildTable())}}, "map");
+    uint32_t out = 0;
+    EXPECT_EQ(map.readAt(0x100, std::as_writable_bytes(std::span(&out, 1))), 4);
+    EXPECT_EQ(out, fixture.value);
+}
+
+} // namespace table_test
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <memory_resource>
 #include <vector>
 #include <vreg.hpp>
 using namespace vreg;
@@ -122,6 +123,80 @@ TEST(VRegConst, ro) {
     EXPECT_EQ(v, 1);
 }
 
+TEST(VRegBinder, array) {
+    std::array<uint16_t, 40> samples;
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = uint16_t(0x0100 + i);
+    }
+    VRegBinder binder(samples, "samples");
+    constexpr auto other = std::endian::native == std::endian::little ? std::endian::big : std::endian::little;
+    std::array<uint16_t, 40> out;
+    EXPECT_EQ(binder.read(std::as_writable_bytes(std::span(out)), other), sizeof(out));
+    EXPECT_EQ(out[39], vregex::byteswap(samples[39]));
+    EXPECT_EQ(binder.write(std::as_bytes(std::span(out)), other), sizeof(out));
+    EXPECT_EQ(samples[39], 0x0100 + 39);
+    EXPECT_EQ(binder.view()->data(), (const std::byte *)samples.data());
+
+    const std::array<uint32_t, 2> table = {1, 2};
+    std::array<uint32_t, 2> t;
+    EXPECT_TRUE(VRegBinder(table, "table").read(std::as_writable_bytes(std::span(t)), other));
+    EXPECT_EQ(t[1], vregex::byteswap(uint32_t(2)));
+}
+
+struct Calib {
+    uint16_t gain;
+    int8_t trim;
+    std::array<uint32_t, 2> table;
+};
+} // namespace vreg_test
+template <> struct vregex::endian_fields<vreg_test::Calib> {
+    using C = vreg_test::Calib;
+    static constexpr auto fields = std::tuple{&C::gain, &C::trim, &C::table};
+};
+namespace vreg_test {
+
+TEST(VRegBinder, struct) {
+    Calib calib{0x1122, -1, {0x10, 0x20}};
+    VRegBinder binder(calib, "calib");
+    std::byte bytes[sizeof(Calib)];
+    EXPECT_EQ(binder.read(bytes, std::endian::big), sizeof(Calib));
+    Calib out;
+    memcpy(&out, bytes, sizeof(out));
+    const bool little = std::endian::native == std::endian::little;
+    EXPECT_EQ(out.gain, little ? 0x2211 : 0x1122);
+    EXPECT_EQ(out.trim, -1);
+    EXPECT_EQ(out.table[1], little ? 0x20000000u : 0x20u);
+    calib = {};
+    EXPECT_EQ(binder.write(bytes, std::endian::big), sizeof(Calib));
+    EXPECT_EQ(calib.gain, 0x1122);
+    EXPECT_EQ(calib.table[1], 0x20);
+}
+
+TEST(VRegBase, view) {
+    uint32_t value = 1;
+    VRegBinder binder(value, "binder");
+    const auto view = binder.view();
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view->data(), (const std::byte *)&value); // no copy
+    EXPECT_EQ(view->size(), sizeof(value));
+    EXPECT_EQ(VRegConst(uint16_t(2), "const").view()->size(), sizeof(uint16_t));
+
+    // no backing storage: copied into scratch, or nothing without one
+    auto ro = VRegRO(
+        [](std::span<std::byte> bytes, std::endian) -> size_opt {
+            if (bytes.empty())
+                return std::nullopt;
+            bytes[0] = std::byte(3);
+            return 1;
+        },
+        "ro");
+    std::byte scratch[4];
+    EXPECT_FALSE(ro.view());
+    EXPECT_EQ(ro.view(scratch)->data(), scratch);
+    EXPECT_EQ(ro.view(scratch)->size(), 1);
+    EXPECT_FALSE(binder.viewAt(1));
+}
+
 } // namespace vreg_test
 
 namespace vrange_test {
@@ -158,8 +233,267 @@ TEST(VRange, VRange) {
     EXPECT_EQ(r.readAt(4, buf), std::nullopt);
     EXPECT_EQ(r.writeAt(4, buf), std::nullopt);
 }
+TEST(VRange, arena) {
+    // no heap: running out of the buffer throws
+    alignas(std::max_align_t) std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    int a = 1;
+    VRangeBuilder rb(&arena, "range");
+    rb.reserve(3);
+    rb.add(VRegBuilder("a").setArena(&arena).buildBinder(a));
+    rb.add(VRegBuilder("c").setArena(&arena).buildConst(2));
+    rb.add(VRegBuilder("reserved").setArena(&arena).buildReserved());
+    VRange r = rb.build();
+
+    std::byte buf[sizeof(int)];
+    int v = 0;
+    EXPECT_EQ(r.readAt(1, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, 2);
+    EXPECT_EQ(r.at(0)->name_, "a");
+
+    const auto ro = VRegBuilder("ro").setArena(&arena).buildBinderRO(a);
+    EXPECT_EQ(ro->read(buf), sizeof(int));
+    EXPECT_EQ(ro->write(buf), std::nullopt);
+}
+
+TEST(VRange, readRange) {
+    VRangeBuilder rb("range");
+    uint8_t a = 1;
+    uint16_t b = 2;
+    uint32_t c = 3;
+    rb.add(VRegBuilder("a").buildBinder(a));
+    rb.add(VRegBuilder("reserved").buildReserved());
+    rb.add(VRegBuilder("b").buildBinder(b));
+    rb.add(VRegBuilder("c").buildBinder(c));
+    VRange r = rb.build();
+
+    std::byte buf[16]{};
+    uint64_t words[1]{};
+    const auto result = r.readRange(0, 5, buf, VBitmap(words));
+    EXPECT_EQ(result.count, 5);
+    EXPECT_EQ(result.bytes, 1 + 2 + 4);
+    EXPECT_EQ(words[0], 0b01101);
+    EXPECT_EQ(buf[0], std::byte{1});
+    EXPECT_EQ(buf[1], std::byte{2});
+    EXPECT_EQ(buf[3], std::byte{3});
+
+    // status is optional
+    EXPECT_EQ(r.readRange(2, 2, buf).bytes, 2 + 4);
+}
+
+TEST(VRange, writeRange) {
+    VRangeBuilder rb("range");
+    uint8_t a = 0;
+    uint16_t b = 0;
+    rb.add(VRegBuilder("a").buildBinder(a));
+    rb.add(VRegBuilder("b").buildBinder(b));
+    rb.add(VRegBuilder("reserved").buildReserved());
+    rb.add(VRegBuilder("a").buildBinder(a));
+    VRange r = rb.build();
+
+    const std::byte buf[]{std::byte{1}, std::byte{2}, std::byte{0}, std::byte{3}};
+    uint64_t words[1]{~uint64_t(0)};
+    const auto result = r.writeRange(0, 4, buf, VBitmap(words));
+    EXPECT_EQ(result.count, 2);
+    EXPECT_EQ(result.bytes, 3);
+    EXPECT_EQ(words[0], ~uint64_t(0) << 4 | 0b0011);
+    EXPECT_EQ(a, 1);
+    EXPECT_EQ(b, 2);
+}
 } // namespace vrange_test
 
-namespace VMap {
-    
-};
\ No newline at end of file
+namespace vmap_test {
+TEST(VMap, VMap) {
+    int a = 1, b = 2, c = 3;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("b").buildBinder(b));
+    rb.add(VRegBuilder("c").buildBinder(c));
+    VMap map(
+        {
+            {0x10, std::make_shared<VRange>(rb.build())},
+            {0x0, VRegBuilder("a").buildBinder(a)},
+        },
+        "map", "desc");
+
+    EXPECT_EQ(map.name_, "map");
+    EXPECT_EQ(map.size(), 0x12);
+    EXPECT_FALSE(map.overlapped());
+
+    // first mount
+    std::byte buf[sizeof(int)];
+    int v = 0;
+    EXPECT_EQ(map.readAt(0x0, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, a);
+
+    // nested
+    EXPECT_EQ(map.readAt(0x11, buf), sizeof(int));
+    memcpy(&v, buf, sizeof(v));
+    EXPECT_EQ(v, c);
+    v = 4;
+    memcpy(buf, &v, sizeof(v));
+    EXPECT_EQ(map.writeAt(0x10, buf), sizeof(int));
+    EXPECT_EQ(b, 4);
+
+    // find
+    ASSERT_TRUE(map.find(0x11));
+    EXPECT_EQ(map.find(0x11)->first, 0x10);
+
+    // unmapped
+    EXPECT_FALSE(map.find(0x1));
+    EXPECT_EQ(map.readAt(0x1, buf), std::nullopt);
+    EXPECT_EQ(map.readAt(0x12, buf), std::nullopt);
+}
+
+TEST(VMap, sparse) {
+    // 29-bit CAN IDs
+    std::vector<int> values(64);
+    std::vector<VMap::pair> pairs;
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = int(i);
+        pairs.emplace_back(i * 0x7654321 % 0x1fffffff, VRegBuilder("id").buildBinder(values[i]));
+    }
+    VMap map(std::move(pairs), "can", "");
+    EXPECT_FALSE(map.overlapped());
+
+    std::byte buf[sizeof(int)];
+    for (size_t i = 0; i < values.size(); i++) {
+        const addr_t addr = i * 0x7654321 % 0x1fffffff;
+        int v = -1;
+        ASSERT_EQ(map.readAt(addr, buf), sizeof(int));
+        memcpy(&v, buf, sizeof(v));
+        EXPECT_EQ(v, values[i]);
+        EXPECT_EQ(map.readAt(addr + 1, buf), std::nullopt);
+    }
+    EXPECT_EQ(map.readAt(0x1fffffff, buf), std::nullopt);
+}
+
+TEST(VMap, empty) {
+    VMap map({}, "empty");
+    std::byte buf[sizeof(int)];
+    EXPECT_EQ(map.size(), 0);
+    EXPECT_EQ(map.readAt(0, buf), std::nullopt);
+}
+
+TEST(VAddrIndex, dense_and_sparse) {
+    using impl::VAddrIndex;
+    for (const addr_t stride : {1u, 3u, 0x10000u, 0x7654321u}) {
+        std::vector<VAddrIndex::Span> spans;
+        for (addr_t i = 0; i < 100; i++) {
+            spans.push_back({i * stride + 5, i * stride + 5 + (i % 3 ? 1 : 0)});
+        }
+        std::erase_if(spans, [](const auto &span) { return span.begin == span.end; });
+        const VAddrIndex index(spans);
+        EXPECT_EQ(index.dense(), stride < 0x10000);
+        for (addr_t addr : {0u, 4u, 5u, 6u, 7u, 8u, 5 + stride, 6 + stride, 5 + 2 * stride, 5 + 99 * stride,
+                            6 + 99 * stride, 0xffffffffu}) {
+            uint32_t expect = VAddrIndex::npos;
+            for (uint32_t i = 0; i < spans.size(); i++) {
+                if (spans[i].begin <= addr && addr < spans[i].end)
+                    expect = i;
+            }
+            EXPECT_EQ(index.find(addr), expect) << "stride=" << stride << " addr=" << addr;
+        }
+    }
+    EXPECT_EQ(VAddrIndex().find(0), VAddrIndex::npos);
+}
+
+TEST(VMap, view) {
+    uint32_t a = 1;
+    uint16_t b = 2;
+    std::atomic<uint8_t> c = 3;
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("b").buildBinder(b));
+    rb.add(VRegBuilder("c").buildBinder(c));
+    VMap map(
+        {
+            {0x0, VRegBuilder("a").buildBinder(a)},
+            {0x10, std::make_shared<VRange>(rb.build())},
+        },
+        "map");
+    EXPECT_EQ(map.viewAt(0x0)->data(), (const std::byte *)&a);
+    EXPECT_EQ(map.viewAt(0x10)->data(), (const std::byte *)&b);
+    EXPECT_FALSE(map.viewAt(0x11)); // atomics are always copied
+    std::byte scratch[1];
+    EXPECT_EQ(map.viewAt(0x11, scratch)->front(), std::byte(3));
+    EXPECT_FALSE(map.viewAt(0x5, scratch));
+}
+
+TEST(VMap, readRange) {
+    uint8_t v[6] = {0, 1, 2, 3, 4, 5};
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("v1").buildBinder(v[1]));
+    rb.add(VRegBuilder("v2").buildBinder(v[2]));
+    auto inner = std::make_shared<VMap>(std::vector<VMap::pair>{{0x1, std::make_shared<VRange>(rb.build())}}, "inner");
+    VMap map(
+        {
+            {0x0, VRegBuilder("v0").buildBinder(v[0])},
+            {0x2, inner},
+            {0x6, VRegBuilder("v5").buildBinder(v[5])},
+        },
+        "map");
+
+    // 0:v0 1:- 2:- 3:v1 4:v2 5:- 6:v5 7:-
+    std::byte buf[8]{};
+    uint64_t words[1]{~uint64_t(0)};
+    const auto result = map.readRange(0, 8, buf, VBitmap(words));
+    EXPECT_EQ(result.count, 8);
+    EXPECT_EQ(result.bytes, 4);
+    EXPECT_EQ(words[0] & 0xff, 0b01011001);
+    EXPECT_EQ(buf[0], std::byte{0});
+    EXPECT_EQ(buf[1], std::byte{1});
+    EXPECT_EQ(buf[2], std::byte{2});
+    EXPECT_EQ(buf[3], std::byte{5});
+
+    // same as one readAt per address
+    for (addr_t first = 0; first < 8; first++) {
+        for (size_t count = 0; first + count <= 8; count++) {
+            uint64_t bits[1]{};
+            const auto r = map.readRange(first, count, buf, VBitmap(bits));
+            size_t bytes = 0;
+            for (size_t i = 0; i < count; i++) {
+                std::byte tmp[1];
+                const auto one = map.readAt(first + i, tmp);
+                EXPECT_EQ(bits[0] >> i & 1, one.has_value()) << first << "+" << i;
+                bytes += one.value_or(0);
+            }
+            EXPECT_EQ(r.bytes, bytes);
+        }
+    }
+}
+
+TEST(VMap, writeRange) {
+    uint8_t v[4] = {};
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("v1").buildBinder(v[1]));
+    rb.add(VRegBuilder("v2").buildBinder(v[2]));
+    VMap map(
+        {
+            {0x0, VRegBuilder("v0").buildBinder(v[0])},
+            {0x1, std::make_shared<VRange>(rb.build())},
+            {0x4, VRegBuilder("v3").buildBinder(v[3])},
+        },
+        "map");
+
+    const std::byte buf[]{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+    uint64_t words[1]{};
+    auto result = map.writeRange(0, 5, buf, VBitmap(words));
+    EXPECT_EQ(result.count, 3);
+    EXPECT_EQ(result.bytes, 3);
+    EXPECT_EQ(words[0], 0b00111);
+    EXPECT_EQ(v[0], 1);
+    EXPECT_EQ(v[2], 3);
+    EXPECT_EQ(v[3], 0);
+
+    result = map.writeRange(4, 1, buf, VBitmap(words));
+    EXPECT_EQ(result.count, 1);
+    EXPECT_EQ(v[3], 1);
+}
+
+TEST(VMapDeathTest, overlap) {
+    int a = 0, b = 0;
+    EXPECT_DEBUG_DEATH(VMap({{0x1, VRegBuilder("a").buildBinder(a)}, {0x1, VRegBuilder("b").buildBinder(b)}}, "map"),
+                       "overlap");
+}
+} // namespace vmap_test
\ No newline at end of file
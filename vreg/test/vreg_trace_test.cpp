@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vreg.hpp>
+using namespace vreg;
+
+namespace trace_test {
+struct Device {
+    uint32_t value = 0;
+    uint16_t status = 0x0102;
+    std::shared_ptr<VRange> range() {
+        VRangeBuilder rb("device");
+        rb.add(VRegBuilder("value").buildBinder(value));
+        rb.add(VRegBuilder("status").buildBinderRO(status));
+        return std::make_shared<VRange>(rb.build());
+    }
+};
+
+TEST(VTraceMount, recordReplay) {
+    const std::string path = testing::TempDir() + "vreg_trace_test.bin";
+    Device device;
+    {
+        VTraceMount<> trace(device.range(), path.c_str());
+        ASSERT_TRUE(trace.recording());
+        for (uint32_t i = 0; i < 100; i++) {
+            trace.writeAt(0, std::as_bytes(std::span(&i, 1)));
+            uint32_t out;
+            trace.readAt(0, std::as_writable_bytes(std::span(&out, 1)));
+        }
+        uint16_t status;
+        trace.readAt(1, std::as_writable_bytes(std::span(&status, 1)), std::endian::big);
+        trace.writeAt(1, std::as_bytes(std::span(&status, 1))); // fails, read only
+        trace.readAt(9, std::as_writable_bytes(std::span(&status, 1)));
+        trace.stop();
+        EXPECT_FALSE(trace.recording());
+        EXPECT_EQ(trace.written(), 203);
+        EXPECT_EQ(trace.dropped(), 0);
+    }
+
+    const std::vector<VTraceRecord> records = VTraceFile::load(path.c_str());
+    ASSERT_EQ(records.size(), 203);
+    EXPECT_EQ(records[2].op, VOp::write);
+    EXPECT_EQ(records[2].addr, 0);
+    EXPECT_EQ(records[2].request, 4);
+    EXPECT_EQ(records[3].op, VOp::read);
+    EXPECT_EQ(records[3].payload[0], std::byte(1));
+    EXPECT_EQ(records[200].payload[0], std::byte(0x01)); // big endian 0x0102
+    EXPECT_TRUE(records[200].big_endian);
+    EXPECT_FALSE(records[201].ok);
+    EXPECT_FALSE(records[202].ok);
+    EXPECT_TRUE(std::ranges::is_sorted(records, {}, &VTraceRecord::time));
+
+    // the same traffic against a fresh device
+    Device replica;
+    auto mount = replica.range();
+    const auto full = VTraceReplay::run(*mount, records);
+    EXPECT_EQ(full.count, 203);
+    EXPECT_EQ(full.mismatched, 0);
+    EXPECT_EQ(replica.value, 99);
+
+    // a device that answers differently
+    replica.status = 0;
+    const auto realtime = VTraceReplay::run(*mount, records, VTraceReplay::Pace::realtime);
+    EXPECT_EQ(realtime.mismatched, 1);
+    EXPECT_GE(realtime.elapsed.count(), int64_t(records.back().time - records.front().time));
+
+    EXPECT_TRUE(VTraceFile::load((path + ".missing").c_str()).empty());
+    std::remove(path.c_str());
+}
+
+TEST(VTraceMount, alternatingMounts) {
+    const std::string pa = testing::TempDir() + "vreg_trace_a.bin", pb = testing::TempDir() + "vreg_trace_b.bin";
+    Device a, b;
+    auto ta = std::make_shared<VTraceMount<>>(a.range(), pa.c_str());
+    auto tb = std::make_shared<VTraceMount<>>(b.range(), pb.c_str());
+    VMap map({{0x00, ta}, {0x10, tb}}, "map");
+    for (uint32_t i = 0; i < 100; i++) {
+        map.writeAt(0x00, std::as_bytes(std::span(&i, 1)));
+        map.writeAt(0x10, std::as_bytes(std::span(&i, 1)));
+    }
+    ta->stop(), tb->stop();
+    EXPECT_EQ(ta->written(), 100);
+    EXPECT_EQ(tb->written(), 100);
+    EXPECT_EQ(a.value, 99);
+    EXPECT_EQ(b.value, 99);
+    std::remove(pa.c_str());
+    std::remove(pb.c_str());
+}
+
+TEST(VTraceMount, threads) {
+    constexpr size_t threads = 4, count = 1000;
+    const std::string path = testing::TempDir() + "vreg_trace_threads.bin";
+    Device device;
+    {
+        VTraceMount<1024> trace(device.range(), path.c_str(), std::chrono::microseconds(100));
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&] {
+                for (size_t i = 0; i < count; i++) {
+                    uint16_t out;
+                    trace.readAt(1, std::as_writable_bytes(std::span(&out, 1)));
+                    if (i % 64 == 0) {
+                        std::this_thread::yield(); // let the writer catch up
+                    }
+                }
+            });
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+        trace.stop();
+        EXPECT_EQ(trace.written() + trace.dropped(), threads * count);
+    }
+    const auto records = VTraceFile::load(path.c_str());
+    EXPECT_GT(records.size(), 0);
+    EXPECT_TRUE(std::ranges::all_of(records, [](const VTraceRecord &r) { return r.ok && r.size == 2; }));
+    std::remove(path.c_str());
+}
+
+TEST(VTraceFile, otherEndian) {
+    const std::string path = testing::TempDir() + "vreg_trace_swapped.bin";
+    // as written on a host of the other byte order
+    VTraceFile::Header header{VTraceFile::magic, VTraceFile::version, std::endian::native == std::endian::little,
+                              vregex::byteswap(uint16_t(sizeof(VTraceRecord)))};
+    VTraceRecord records[2]{};
+    for (uint32_t i = 0; i < 2; i++) {
+        records[i].time = vregex::byteswap(uint64_t(200 - 100 * i));
+        records[i].latency = vregex::byteswap(uint32_t(10 + i));
+        records[i].addr = vregex::byteswap(addr_t(0x1000 + i));
+        records[i].op = VOp::write;
+        records[i].ok = true;
+    }
+    FILE *file = fopen(path.c_str(), "wb");
+    ASSERT_TRUE(file);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(records, sizeof(VTraceRecord), 2, file);
+    fclose(file);
+
+    const auto loaded = VTraceFile::load(path.c_str());
+    ASSERT_EQ(loaded.size(), 2);
+    EXPECT_EQ(loaded[0].time, 100);
+    EXPECT_EQ(loaded[0].latency, 11);
+    EXPECT_EQ(loaded[0].addr, 0x1001);
+    EXPECT_EQ(loaded[1].addr, 0x1000);
+    std::remove(path.c_str());
+}
+
+} // namespace trace_test
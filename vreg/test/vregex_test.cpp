@@ -1,6 +1,7 @@
 #include <cstdint>
 #include <gtest/gtest.h>
 #include <vregex.hpp>
+#include <vregex_bswap.hpp>
 using namespace vregex;
 
 TEST(byteswap, byteswap) {
@@ -9,6 +10,80 @@ TEST(byteswap, byteswap) {
     EXPECT_EQ(byteswap<uint16_t>(0x1122), 0x2211);
     EXPECT_EQ(byteswap<uint32_t>(0x11223344), 0x44332211);
     EXPECT_EQ(byteswap<uint64_t>(0x1122334455667788UL), 0x8877665544332211UL);
+    EXPECT_EQ(byteswap<int16_t>(int16_t(0x80ff)), int16_t(0xff80));
+    EXPECT_EQ(byteswap<int32_t>(-2), int32_t(0xfeffffff));
+    static_assert(byteswap<uint32_t>(0x11223344) == 0x44332211); // usable at compile time
+}
+
+// every length around the SIMD block sizes, unaligned
+template <class U, class F> static void checkKernel(F &&kernel) {
+    std::vector<std::byte> src(100 * sizeof(U) + 1), dst(src.size());
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = std::byte(i * 7 + 1);
+    }
+    for (size_t n = 0; n < 100; n++) {
+        std::ranges::fill(dst, std::byte(0));
+        kernel(dst.data() + 1, src.data() + 1, n);
+        for (size_t i = 0; i < n; i++) {
+            U x, y;
+            memcpy(&x, src.data() + 1 + i * sizeof(U), sizeof(U));
+            memcpy(&y, dst.data() + 1 + i * sizeof(U), sizeof(U));
+            ASSERT_EQ(y, byteswap(x)) << "n=" << n << " i=" << i;
+        }
+        ASSERT_EQ(dst[1 + n * sizeof(U)], std::byte(0)); // nothing past the end
+    }
+}
+
+template <class U> static void checkKernels() {
+    constexpr size_t width = sizeof(U);
+    checkKernel<U>(bswap::copy<width>);
+    checkKernel<U>(bswap::scalar<U>);
+#ifdef VREGEX_HAS_X86_BSWAP
+    // the SIMD parts alone, the scalar loop finishes the tail
+    if (bswap::detect() != bswap::isa::scalar) {
+        checkKernel<U>([](std::byte *dst, const std::byte *src, size_t n) {
+            const size_t done = bswap::ssse3<width>(dst, src, n * width);
+            bswap::scalar<U>(dst + done, src + done, n - done / width);
+        });
+    }
+    if (bswap::detect() == bswap::isa::avx2) {
+        checkKernel<U>([](std::byte *dst, const std::byte *src, size_t n) {
+            const size_t done = bswap::avx2<width>(dst, src, n * width);
+            bswap::scalar<U>(dst + done, src + done, n - done / width);
+        });
+    }
+#endif
+}
+
+TEST(byteswap, kernels) {
+    checkKernels<uint16_t>();
+    checkKernels<uint32_t>();
+    checkKernels<uint64_t>();
+}
+
+struct Calib {
+    uint16_t gain;
+    uint8_t flags;
+    float scale;
+    std::array<int32_t, 3> table;
+    char tag[2];
+};
+template <> struct vregex::endian_fields<Calib> {
+    static constexpr auto fields = std::tuple{&Calib::gain, &Calib::flags, &Calib::scale, &Calib::table};
+};
+
+TEST(byteswap, fields) {
+    static_assert(endian_swappable<Calib>);
+    static_assert(endian_swappable<std::array<Calib, 2>>);
+    static_assert(!endian_swappable<std::array<void *, 2>>);
+    Calib c{0x1122, 0x33, 1.0f, {1, 2, 3}, {'a', 'b'}};
+    byteswap_inplace(c);
+    EXPECT_EQ(c.gain, 0x2211);
+    EXPECT_EQ(c.flags, 0x33);
+    EXPECT_EQ(c.table[2], byteswap(int32_t(3)));
+    EXPECT_EQ(c.tag[0], 'a'); // not described
+    byteswap_inplace(c);
+    EXPECT_EQ(c.scale, 1.0f);
 }
 
 TEST(varchar, adjust_size) {
@@ -39,3 +114,43 @@ TEST(varchar, modify) {
     const varchar<7> y = "12";
     EXPECT_TRUE(x== y);
 }
+
+TEST(varchar, length) {
+    varchar<7> x;
+    EXPECT_TRUE(x.empty());
+    x = std::string_view("abc");
+    EXPECT_FALSE(x.empty());
+    EXPECT_EQ(x.size(), 3);
+    x += "defgh";
+    EXPECT_EQ(x.size(), 7);
+    EXPECT_EQ(std::string_view(x), "abcdefg");
+    EXPECT_EQ(x.c_str()[7], '\0');
+    EXPECT_EQ(varchar<7>(std::string_view("xy")).size(), 2);
+    // ordered like the strings, not by length
+    EXPECT_LT(varchar<7>("aa"), varchar<7>("b"));
+}
+
+TEST(varchar, hash) {
+    const varchar<15> a("motor.speed");
+    char buf[] = "motor.speed";
+    const varchar<15> b(buf);
+    EXPECT_EQ(std::hash<varchar<15>>()(a), std::hash<varchar<15>>()(b));
+    EXPECT_NE(std::hash<varchar<15>>()(a), std::hash<varchar<15>>()(varchar<15>("motor.speeD")));
+}
+
+TEST(intern_pool, intern) {
+    intern_pool<32, 8> pool;
+    const auto a = pool.intern("speed");
+    ASSERT_TRUE(a);
+    char name[] = "speed";
+    const auto b = pool.intern(std::string_view(name));
+    ASSERT_TRUE(b);
+    EXPECT_EQ(a->data(), b->data());
+    EXPECT_EQ(*b, "speed");
+    EXPECT_EQ(pool.size(), 1);
+    EXPECT_EQ(pool.used(), 5);
+
+    // capacity
+    EXPECT_TRUE(pool.intern("a"));
+    EXPECT_FALSE(pool.intern(std::string_view("0123456789012345678901234567890")));
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// NOTE: minimal micro benchmark harness (no external dependency)
+namespace vbench {
+
+// keep the compiler from discarding a computed value
+template <class T> inline void doNotOptimize(const T &value) { asm volatile("" : : "r,m"(value) : "memory"); }
+inline void clobber() { asm volatile("" : : : "memory"); }
+
+// a case runs its body `iterations` times
+using bench_fn = std::function<void(size_t iterations)>;
+
+struct Case {
+    std::string name;
+    bench_fn fn;
+};
+
+// case specific value besides the time per op (e.g. a latency percentile)
+struct Counter {
+    std::string name;
+    double value;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations;
+    double ns_per_op;
+    std::vector<Counter> counters;
+};
+
+inline std::vector<Case> &registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Register {
+    Register(std::string name, bench_fn fn) { registry().push_back({std::move(name), std::move(fn)}); }
+};
+
+inline std::vector<Counter> &counters() {
+    static std::vector<Counter> reported;
+    return reported;
+}
+// called from a case body, the values of the measured run end up in its Result
+inline void report(std::string_view name, double value) {
+    for (auto &counter : counters()) {
+        if (counter.name == name) {
+            counter.value = value;
+            return;
+        }
+    }
+    counters().push_back({std::string(name), value});
+}
+
+// grow the iteration count until one run takes at least min_time
+inline Result measure(const Case &c, std::chrono::nanoseconds min_time = std::chrono::milliseconds(50)) {
+    using clock = std::chrono::steady_clock;
+    size_t iterations = 1;
+    while (true) {
+        counters().clear();
+        const auto begin = clock::now();
+        c.fn(iterations);
+        const auto elapsed = clock::now() - begin;
+        if (elapsed >= min_time || iterations >= (size_t(1) << 40)) {
+            const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            return {c.name, iterations, ns / iterations, std::exchange(counters(), {})};
+        }
+        iterations *= 2;
+    }
+}
+
+// machine readable output, one record per case
+inline bool writeJson(const char *path, const std::vector<Result> &results) {
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        return false;
+    fprintf(fp, "[\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &r = results[i];
+        fprintf(fp, "  {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f",
+                r.name.c_str(), r.iterations, r.ns_per_op, 1e9 / r.ns_per_op);
+        if (!r.counters.empty()) {
+            fprintf(fp, ", \"counters\": {");
+            for (size_t k = 0; k < r.counters.size(); k++) {
+                fprintf(fp, "%s\"%s\": %.3f", k ? ", " : "", r.counters[k].name.c_str(), r.counters[k].value);
+            }
+            fprintf(fp, "}");
+        }
+        fprintf(fp, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "]\n");
+    return fclose(fp) == 0;
+}
+inline bool writeCsv(const char *path, const std::vector<Result> &results) {
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        return false;
+    // counters as name=value pairs separated by ';'
+    fprintf(fp, "name,iterations,ns_per_op,ops_per_sec,counters\n");
+    for (const auto &r : results) {
+        fprintf(fp, "%s,%zu,%.3f,%.1f,", r.name.c_str(), r.iterations, r.ns_per_op, 1e9 / r.ns_per_op);
+        for (size_t k = 0; k < r.counters.size(); k++) {
+            fprintf(fp, "%s%s=%.3f", k ? ";" : "", r.counters[k].name.c_str(), r.counters[k].value);
+        }
+        fprintf(fp, "\n");
+    }
+    return fclose(fp) == 0;
+}
+
+} // namespace vbench
+
+#define VBENCH_CAT_(a, b) a##b
+#define VBENCH_CAT(a, b) VBENCH_CAT_(a, b)
+#define VBENCH(group, name)                                                                                            \
+    static void group##_##name(size_t iterations);                                                                     \
+    static const vbench::Register VBENCH_CAT(group##_##name, _reg)(#group "/" #name, group##_##name);                  \
+    static void group##_##name(size_t iterations)
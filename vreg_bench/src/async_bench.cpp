@@ -0,0 +1,56 @@
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// 64 reads of a device with 50us latency, one at a time and all in flight
+namespace {
+using namespace std::chrono_literals;
+constexpr size_t count = 64;
+
+std::array<uint32_t, count> values{};
+VExecutor executor;
+
+VDelayMount makeDevice() {
+    VRangeBuilder rb("device");
+    for (auto &value : values) {
+        rb.add(VRegBuilder("value").buildBinder(value));
+    }
+    return VDelayMount(std::make_shared<VRange>(rb.build()), executor, 50us);
+}
+VDelayMount device = makeDevice();
+
+VTask<> readOne(addr_t addr, uint32_t &out) {
+    vbench::doNotOptimize(co_await device.readAtAsync(addr, std::as_writable_bytes(std::span(&out, 1))));
+}
+VTask<> readAll(std::array<uint32_t, count> &out) {
+    for (size_t i = 0; i < count; i++) {
+        co_await readOne(addr_t(i), out[i]);
+    }
+}
+} // namespace
+
+VBENCH(async, sync_x64) {
+    std::array<uint32_t, count> out;
+    for (size_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) {
+            vbench::doNotOptimize(device.readAt(addr_t(i), std::as_writable_bytes(std::span(&out[i], 1))));
+        }
+    }
+}
+
+VBENCH(async, sequential_x64) {
+    std::array<uint32_t, count> out;
+    for (size_t n = 0; n < iterations; n++) {
+        executor.block(readAll(out));
+    }
+}
+
+VBENCH(async, pipelined_x64) {
+    std::array<uint32_t, count> out;
+    for (size_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) {
+            executor.spawn(readOne(addr_t(i), out[i]));
+        }
+        executor.run();
+    }
+}
@@ -0,0 +1,131 @@
+#include <array>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// dumping 256 consecutive registers one by one and in one burst
+namespace {
+constexpr size_t count = 256;
+std::array<uint32_t, count> values{};
+
+VMap makeMap() {
+    std::vector<VMap::pair> pairs;
+    for (size_t block = 0; block < 4; block++) {
+        VRangeBuilder rb("block");
+        for (size_t i = 0; i < count / 4; i++) {
+            rb.add(VRegBuilder("v").buildBinder(values[block * count / 4 + i]));
+        }
+        pairs.emplace_back(block * count / 4, std::make_shared<VRange>(rb.build()));
+    }
+    return VMap(std::move(pairs), "map");
+}
+VMap map = makeMap();
+std::array<std::byte, count * sizeof(uint32_t)> buf;
+} // namespace
+
+VBENCH(bulk, readAt_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        size_t used = 0;
+        for (addr_t i = 0; i < count; i++) {
+            used += map.readAt(i, std::span(buf).subspan(used)).value_or(0);
+        }
+        vbench::doNotOptimize(used);
+    }
+}
+VBENCH(bulk, viewAt_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        size_t used = 0;
+        for (addr_t i = 0; i < count; i++) {
+            const auto view = map.viewAt(i);
+            used += view ? view->size() : 0;
+        }
+        vbench::doNotOptimize(used);
+    }
+}
+VBENCH(bulk, readRange_x256) {
+    std::array<uint64_t, VBitmap::words(count)> words;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(map.readRange(0, count, buf, VBitmap(words)));
+    }
+}
+VBENCH(bulk, writeRange_x256) {
+    std::array<uint64_t, VBitmap::words(count)> words;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(map.writeRange(0, count, buf, VBitmap(words)));
+    }
+}
+
+// the same registers as one VRange and as one VTable (structure of arrays)
+namespace {
+template <class M> M makeFlat(M (VRangeBuilder::*build)()) {
+    VRangeBuilder rb("flat");
+    for (auto &value : values) {
+        rb.add(VRegBuilder("v").buildBinder(value));
+    }
+    return (rb.*build)();
+}
+VRange range = makeFlat(&VRangeBuilder::build);
+VTable table = makeFlat(&VRangeBuilder::buildTable);
+
+template <class M> void readEach(M &mount, size_t iterations) {
+    for (size_t n = 0; n < iterations; n++) {
+        size_t used = 0;
+        for (addr_t i = 0; i < count; i++) {
+            used += mount.readAt(i, std::span(buf).subspan(used)).value_or(0);
+        }
+        vbench::doNotOptimize(used);
+    }
+}
+} // namespace
+
+VBENCH(bulk, vrange_readAt_x256) { readEach(range, iterations); }
+VBENCH(bulk, vtable_readAt_x256) { readEach(table, iterations); }
+VBENCH(bulk, vrange_readRange_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(range.readRange(0, count, buf));
+    }
+}
+VBENCH(bulk, vtable_readRange_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(table.readRange(0, count, buf));
+    }
+}
+
+// incremental sync of the same registers when 4 of 256 changed, against the full dump above
+namespace {
+VDirtyMount dirty(std::make_shared<VMap>(makeMap()));
+std::array<std::byte, count * (VDirtyMount::header_size + sizeof(uint32_t))> delta;
+} // namespace
+
+VBENCH(bulk, collectDirty_4_of_256) {
+    for (size_t n = 0; n < iterations; n++) {
+        for (addr_t i = 0; i < count; i += count / 4) {
+            dirty.markDirty(i);
+        }
+        vbench::doNotOptimize(dirty.collectDirty(delta));
+    }
+}
+VBENCH(bulk, poll_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        values[n % count]++;
+        vbench::doNotOptimize(dirty.poll());
+        dirty.clearDirty();
+    }
+}
+
+// the same registers captured into and restored from one packed image
+namespace {
+VSnapshot snapshot(map);
+std::vector<std::byte> image(snapshot.imageSize());
+} // namespace
+
+VBENCH(bulk, snapshotCapture_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(snapshot.capture(image));
+    }
+}
+VBENCH(bulk, snapshotRestore_x256) {
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(snapshot.restore(image));
+    }
+}
@@ -0,0 +1,82 @@
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// frames through decode -> writeAt, Mop/s is million frames per second
+namespace {
+constexpr size_t ids = 64;
+std::array<uint16_t, ids * 4> classic{};  // 4 signals per 8 byte frame
+std::array<uint32_t, ids * 16> fd{};      // 16 signals per 64 byte frame
+
+std::shared_ptr<VMap> makeMap() {
+    VRangeBuilder a("classic"), b("fd");
+    for (auto &value : classic) {
+        a.add(VRegBuilder("v").buildBinder(value));
+    }
+    for (auto &value : fd) {
+        b.add(VRegBuilder("v").buildBinder(value));
+    }
+    return std::make_shared<VMap>(std::vector<VMap::pair>{{0x0000, std::make_shared<VRange>(a.build())},
+                                                         {0x1000, std::make_shared<VRange>(b.build())}},
+                                  "map");
+}
+const std::shared_ptr<VMap> map = makeMap();
+
+// contiguous signals merge into one writeRange, scattered ones take a writeAt each
+std::vector<VCanRoute> makeRoutes(bool scattered) {
+    std::vector<VCanRoute> routes;
+    for (uint32_t id = 0; id < ids; id++) {
+        VCanRoute classic_route{0x100 + id, {}}, fd_route{VCanFrame::extended | (0x18ff0000 + id), {}};
+        for (uint16_t i = 0; i < 4; i++) {
+            const uint16_t k = scattered ? 3 - i : i;
+            classic_route.signals.push_back({addr_t(id * 4 + k), uint16_t(k * 2), 2});
+        }
+        for (uint16_t i = 0; i < 16; i++) {
+            const uint16_t k = scattered ? 15 - i : i;
+            fd_route.signals.push_back({addr_t(0x1000 + id * 16 + k), uint16_t(k * 4), 4});
+        }
+        routes.push_back(std::move(classic_route));
+        routes.push_back(std::move(fd_route));
+    }
+    return routes;
+}
+
+std::vector<VCanFrame> makeFrames(bool extended) {
+    std::vector<VCanFrame> frames(256);
+    for (size_t i = 0; i < frames.size(); i++) {
+        const uint32_t id = uint32_t(i * 7 % ids);
+        frames[i] = extended ? VCanFrame{VCanFrame::extended | (0x18ff0000 + id), 64, VCanFrame::fd, {}, {}}
+                             : VCanFrame{0x100 + id, 8, 0, {}, {}};
+        frames[i].data.fill(std::byte(i));
+    }
+    return frames;
+}
+
+void decode(bool extended, bool scattered, size_t iterations) {
+    const auto routes = makeRoutes(scattered);
+    VCanGateway gateway(*map, routes);
+    const auto frames = makeFrames(extended);
+    for (size_t n = 0; n < iterations; n += frames.size()) {
+        const size_t count = std::min(frames.size(), iterations - n);
+        vbench::doNotOptimize(gateway.decode(std::span(frames).first(count)));
+    }
+}
+} // namespace
+
+VBENCH(can, decode_classic8) { decode(false, false, iterations); }
+VBENCH(can, decode_classic8_scattered) { decode(false, true, iterations); }
+VBENCH(can, decode_fd64) { decode(true, false, iterations); }
+VBENCH(can, decode_fd64_scattered) { decode(true, true, iterations); }
+
+// send and receive through the in-process bus, one thread
+VBENCH(can, loopback_fd64) {
+    const auto routes = makeRoutes(false);
+    VCanGateway gateway(*map, routes);
+    static VCanLoopback<1024> bus;
+    const auto frames = makeFrames(true);
+    for (size_t n = 0; n < iterations; n += frames.size()) {
+        const size_t count = std::min(frames.size(), iterations - n);
+        bus.send(std::span(frames).first(count));
+        vbench::doNotOptimize(gateway.pump(bus));
+    }
+}
@@ -0,0 +1,117 @@
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// aggregate read throughput of concurrent binders while one writer keeps updating
+namespace {
+std::atomic<uint64_t> atomic_value;
+vregex::seqlock<std::array<uint32_t, 8>> seqlock_value;
+
+VRange makeRange() {
+    VRangeBuilder rb("range");
+    rb.add(VRegBuilder("atomic").buildBinder(atomic_value));
+    rb.add(VRegBuilder("seqlock").buildBinder(seqlock_value));
+    return rb.build();
+}
+VRange range = makeRange();
+
+// iterations are split over the readers
+void readers(addr_t addr, size_t count, size_t iterations) {
+    std::atomic<bool> stop = false;
+    std::thread writer([&] {
+        std::array<std::byte, 32> buf{};
+        for (size_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+            buf[0] = std::byte(i);
+            range.writeAt(addr, buf);
+        }
+    });
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < count; r++) {
+        threads.emplace_back([&] {
+            std::array<std::byte, 32> buf;
+            for (size_t i = 0; i < iterations / count; i++) {
+                vbench::doNotOptimize(range.readAt(addr, buf));
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    stop = true;
+    writer.join();
+}
+
+// a 32 byte parameter set committed as a whole
+VShadowBank<std::array<uint32_t, 8>> shadow_bank;
+
+void shadowReaders(size_t count, size_t iterations) {
+    std::atomic<bool> stop = false;
+    std::thread writer([&] {
+        for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+            shadow_bank.staging()[0] = i;
+            shadow_bank.commit();
+        }
+    });
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < count; r++) {
+        threads.emplace_back([&] {
+            for (size_t i = 0; i < iterations / count; i++) {
+                vbench::doNotOptimize(shadow_bank.load());
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    stop = true;
+    writer.join();
+}
+
+// the same set as 8 registers of a map in shadow mode, read as one readRange
+std::array<uint32_t, 8> shadow_set{};
+VShadowMount shadow_mount([] {
+    VRangeBuilder rb("set");
+    for (auto &value : shadow_set) {
+        rb.add(VRegBuilder("value").buildBinder(value));
+    }
+    return std::make_shared<VRange>(rb.build());
+}());
+
+void shadowMountReaders(size_t count, size_t iterations) {
+    std::atomic<bool> stop = false;
+    std::thread writer([&] {
+        for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+            shadow_mount.writeAt(0, std::as_bytes(std::span(&i, 1)));
+            shadow_mount.commit();
+        }
+    });
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < count; r++) {
+        threads.emplace_back([&] {
+            std::array<std::byte, sizeof(shadow_set)> buf;
+            for (size_t i = 0; i < iterations / count; i++) {
+                vbench::doNotOptimize(shadow_mount.readRange(0, shadow_set.size(), buf));
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    stop = true;
+    writer.join();
+}
+
+const bool registered = [] {
+    for (size_t count : {1, 2, 4, 8}) {
+        const auto n = std::to_string(count);
+        vbench::Register("concurrent/atomic_readers_" + n, [=](size_t it) { readers(0, count, it); });
+        vbench::Register("concurrent/seqlock_readers_" + n, [=](size_t it) { readers(1, count, it); });
+        vbench::Register("concurrent/shadow_readers_" + n, [=](size_t it) { shadowReaders(count, it); });
+        vbench::Register("concurrent/shadow_mount_readers_" + n, [=](size_t it) { shadowMountReaders(count, it); });
+    }
+    return true;
+}();
+} // namespace
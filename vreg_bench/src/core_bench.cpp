@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// hot paths of the dynamic maps, binders and vregex
+namespace {
+// VMap::find/readAt over maps of n binders, dense (consecutive) or sparse (scattered 29-bit IDs)
+struct MapFixture {
+    std::vector<uint32_t> values;
+    std::vector<addr_t> addrs; // shuffled lookup order
+    std::unique_ptr<VMap> map;
+
+    MapFixture(size_t n, bool sparse) : values(n) {
+        std::vector<VMap::pair> pairs;
+        for (size_t i = 0; i < n; i++) {
+            const addr_t addr = sparse ? addr_t(i * 0x9e3779b1ULL % 0x1fffffff) : addr_t(i);
+            pairs.emplace_back(addr, VRegBuilder("id").buildBinder(values[i]));
+            addrs.push_back(addr);
+        }
+        map = std::make_unique<VMap>(std::move(pairs), "map");
+        std::shuffle(addrs.begin(), addrs.end(), std::mt19937(1));
+        addrs.resize(std::bit_floor(addrs.size()));
+    }
+};
+
+const bool map_registered = [] {
+    for (const size_t n : {16, 256, 4096}) {
+        for (const bool sparse : {false, true}) {
+            auto fixture = std::make_shared<MapFixture>(n, sparse);
+            const std::string suffix = std::string(sparse ? "sparse_" : "dense_") + std::to_string(n);
+            vbench::Register("vmap/find_" + suffix, [fixture](size_t iterations) {
+                const size_t mask = fixture->addrs.size() - 1;
+                for (size_t i = 0; i < iterations; i++) {
+                    vbench::doNotOptimize(fixture->map->find(fixture->addrs[i & mask]));
+                }
+            });
+            vbench::Register("vmap/readAt_" + suffix, [fixture](size_t iterations) {
+                const size_t mask = fixture->addrs.size() - 1;
+                std::byte buf[4];
+                for (size_t i = 0; i < iterations; i++) {
+                    vbench::doNotOptimize(fixture->map->readAt(fixture->addrs[i & mask], buf));
+                }
+            });
+        }
+    }
+    return true;
+}();
+
+std::array<uint32_t, 16> range_values;
+VRange makeRange() {
+    VRangeBuilder rb("range");
+    for (auto &value : range_values) {
+        rb.add(VRegBuilder("v").buildBinder(value));
+    }
+    return rb.build();
+}
+VRange range = makeRange();
+
+uint32_t binder_value = 0x11223344;
+VRegBinder<uint32_t> binder(binder_value, "binder");
+VRegConst<uint32_t> constant(0x11223344, "const");
+
+std::array<uint16_t, 1024> u16s;
+std::array<uint32_t, 1024> u32s;
+std::array<uint64_t, 1024> u64s;
+} // namespace
+
+VBENCH(vrange, readAt) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(range.readAt(i & 0xf, buf));
+    }
+}
+VBENCH(vrange, writeAt) {
+    std::byte buf[4]{};
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(range.writeAt(i & 0xf, buf));
+    }
+}
+
+VBENCH(binder, read_native) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(binder.read(buf, std::endian::native));
+        vbench::clobber();
+    }
+}
+VBENCH(binder, read_swapped) {
+    constexpr auto swapped = std::endian::native == std::endian::little ? std::endian::big : std::endian::little;
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(binder.read(buf, swapped));
+        vbench::clobber();
+    }
+}
+VBENCH(binder, write_native) {
+    std::byte buf[4]{};
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(binder.write(buf, std::endian::native));
+        vbench::clobber();
+    }
+}
+VBENCH(binder, write_swapped) {
+    constexpr auto swapped = std::endian::native == std::endian::little ? std::endian::big : std::endian::little;
+    std::byte buf[4]{};
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(binder.write(buf, swapped));
+        vbench::clobber();
+    }
+}
+VBENCH(const, read) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(constant.read(buf));
+        vbench::clobber();
+    }
+}
+
+// per element of a 1024 element array
+VBENCH(byteswap, u16_x1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        for (auto &x : u16s) {
+            x = vregex::byteswap(x);
+        }
+        vbench::clobber();
+    }
+}
+VBENCH(byteswap, u32_x1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        for (auto &x : u32s) {
+            x = vregex::byteswap(x);
+        }
+        vbench::clobber();
+    }
+}
+VBENCH(byteswap, u64_x1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        for (auto &x : u64s) {
+            x = vregex::byteswap(x);
+        }
+        vbench::clobber();
+    }
+}
+
+// the bulk kernels (SIMD where available) on the same arrays
+VBENCH(byteswap, kernel_u16_x1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        std::byte *bytes = (std::byte *)u16s.data();
+        vregex::bswap::copy<2>(bytes, bytes, u16s.size());
+        vbench::clobber();
+    }
+}
+VBENCH(byteswap, kernel_u32_x1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        std::byte *bytes = (std::byte *)u32s.data();
+        vregex::bswap::copy<4>(bytes, bytes, u32s.size());
+        vbench::clobber();
+    }
+}
+VBENCH(byteswap, kernel_u64_x1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        std::byte *bytes = (std::byte *)u64s.data();
+        vregex::bswap::copy<8>(bytes, bytes, u64s.size());
+        vbench::clobber();
+    }
+}
+VBENCH(binder, read_swapped_u16_x1024) {
+    constexpr auto swapped = std::endian::native == std::endian::little ? std::endian::big : std::endian::little;
+    VRegBinder samples(u16s, "samples");
+    std::array<std::byte, sizeof(u16s)> out;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(samples.read(out, swapped));
+        vbench::clobber();
+    }
+}
+
+VBENCH(varchar, construct) {
+    const char *s = "motor_velocity";
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(s);
+        vregex::varchar_middle v(s);
+        vbench::doNotOptimize(v);
+    }
+}
+VBENCH(varchar, size) {
+    vregex::varchar_middle v("motor_velocity_target");
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(v.size());
+        vbench::clobber();
+    }
+}
+VBENCH(varchar, compare) {
+    vregex::varchar_middle a("motor_velocity_target"), b("motor_velocity_limit");
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(a == b);
+        vbench::clobber();
+    }
+}
+VBENCH(varchar, append) {
+    for (size_t i = 0; i < iterations; i++) {
+        vregex::varchar_middle v("motor");
+        v += "_velocity";
+        v += "_target";
+        vbench::doNotOptimize(v);
+    }
+}
+VBENCH(varchar, hash) {
+    vregex::varchar_middle v("motor_velocity_target");
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(std::hash<vregex::varchar_middle>()(v));
+        vbench::clobber();
+    }
+}
+
+// name to address over 1024 registers in 32 ranges
+namespace {
+constexpr size_t name_count = 32 * 32;
+struct Names {
+    std::vector<std::string> storage; // for static names
+    std::shared_ptr<VMap> map;
+    std::vector<std::string> paths;
+    std::vector<std::string_view> keys; // looked up, a constant count keeps a division out of the loops
+    Names() {
+        for (size_t i = 0; i < 32; i++) {
+            storage.push_back("sensor" + std::to_string(i));
+            storage.push_back("channel" + std::to_string(i));
+        }
+        std::vector<VMap::pair> entries;
+        for (size_t r = 0; r < 32; r++) {
+            VRangeBuilder rb(storage[2 * r]);
+            for (size_t i = 0; i < 32; i++) {
+                rb.add(VRegBuilder(storage[2 * i + 1]).buildConst(uint32_t(i)));
+                paths.push_back(storage[2 * r] + "." + storage[2 * i + 1]);
+            }
+            entries.push_back({r * 32, std::make_shared<VRange>(rb.build())});
+        }
+        map = std::make_shared<VMap>(std::move(entries), "map");
+        keys.assign(paths.begin(), paths.end());
+    }
+} names;
+const VNameIndex name_index(*names.map);
+const std::unordered_map<std::string_view, addr_t> name_map = [] {
+    std::unordered_map<std::string_view, addr_t> map;
+    for (const auto &path : names.paths) {
+        map.emplace(path, *name_index.find(path));
+    }
+    return map;
+}();
+} // namespace
+
+VBENCH(names, find_1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(name_index.find(names.keys[n % name_count]));
+    }
+}
+VBENCH(names, unordered_map_1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(name_map.find(names.keys[n % name_count]));
+    }
+}
+VBENCH(names, build_1024) {
+    for (size_t n = 0; n < iterations; n++) {
+        VNameIndex index(*names.map);
+        vbench::doNotOptimize(index);
+    }
+}
+
+// instrumentation and caching overhead over vrange/readAt
+namespace {
+VCacheMount<> cached(std::make_shared<VRange>(makeRange()), {std::chrono::hours(1)});
+VStatsMount<false> counted(std::make_shared<VRange>(makeRange()));
+VStatsMount<true> timed(std::make_shared<VRange>(makeRange()));
+} // namespace
+
+VBENCH(cache, readAt_hit) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(cached.readAt(i & 0xf, buf));
+    }
+}
+VBENCH(stats, readAt_counted) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(counted.readAt(i & 0xf, buf));
+    }
+}
+VBENCH(stats, readAt_latency) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(timed.readAt(i & 0xf, buf));
+    }
+}
+
+// bit fields of one status register
+namespace {
+using Mode = VField<0, 3>;
+using Trim = VField<3, 5, true>;
+using Speed = VField<16, 16>;
+using Temp = VField<52, 12, true>;
+uint64_t status = 0x0123456789abcdef;
+VRegField<uint64_t, Trim> trim(status, "trim");
+} // namespace
+
+VBENCH(field, read) {
+    std::byte buf[1];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(trim.read(buf));
+        vbench::clobber();
+    }
+}
+VBENCH(field, write) {
+    std::byte buf[1]{};
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(trim.write(buf));
+        vbench::clobber();
+    }
+}
+VBENCH(field, decode_4_fields) {
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(VFields<Mode, Trim, Speed, Temp>::decode(status + i));
+    }
+}
@@ -0,0 +1,94 @@
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// big endian link to little endian registers: runtime argument against the endian fixed at compile time.
+// results are consumed as size_t, spilling the optional costs a store forwarding stall that hides the difference.
+namespace {
+constexpr size_t count = 256;
+std::array<uint32_t, count> values{};
+
+std::shared_ptr<VMap> makeMap() {
+    std::vector<VMap::pair> pairs;
+    for (size_t block = 0; block < 4; block++) {
+        VRangeBuilder rb("block");
+        for (size_t i = 0; i < count / 4; i++) {
+            rb.add(VRegBuilder("v").buildBinder(values[block * count / 4 + i]));
+        }
+        pairs.emplace_back(block * 0x100, std::make_shared<VRange>(rb.build()));
+    }
+    return std::make_shared<VMap>(std::move(pairs), "map");
+}
+const std::shared_ptr<VMap> map = makeMap();
+addr_t addrOf(size_t i) { return addr_t(i % 4 * 0x100 + i / 4 % (count / 4)); }
+
+// what byteswap was before the builtins
+template <std::integral T> T byteLoop(T x) {
+    std::byte *const bytes = (std::byte *)(&x);
+    for (size_t i = 0; i < sizeof(T) / 2; i++) {
+        std::swap(bytes[i], bytes[sizeof(T) - i - 1]);
+    }
+    return x;
+}
+} // namespace
+
+VBENCH(endian, readAt_runtime_big) {
+    std::array<std::byte, 4> buf;
+    std::endian endian = std::endian::big;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(endian); // as if it came from the link configuration
+        vbench::doNotOptimize(map->readAt(addrOf(n), buf, endian).value_or(0));
+    }
+}
+VBENCH(endian, readAt_runtime_native) {
+    std::array<std::byte, 4> buf;
+    std::endian endian = std::endian::native;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(endian);
+        vbench::doNotOptimize(map->readAt(addrOf(n), buf, endian).value_or(0));
+    }
+}
+VBENCH(endian, readAs_big) {
+    VEndpoint<std::endian::big> link(*map);
+    std::array<std::byte, 4> buf;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(link.readAs<uint32_t>(addrOf(n), buf).value_or(0));
+    }
+}
+VBENCH(endian, writeAt_runtime_big) {
+    std::array<std::byte, 4> buf{std::byte(1)};
+    std::endian endian = std::endian::big;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(endian);
+        vbench::doNotOptimize(map->writeAt(addrOf(n), buf, endian).value_or(0));
+    }
+}
+VBENCH(endian, writeAs_big) {
+    VEndpoint<std::endian::big> link(*map);
+    std::array<std::byte, 4> buf{std::byte(1)};
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(link.writeAs<uint32_t>(addrOf(n), buf).value_or(0));
+    }
+}
+
+// 1024 words per op
+VBENCH(endian, byteswap_loop_x1024) {
+    std::array<uint32_t, 1024> words{};
+    for (size_t n = 0; n < iterations; n++) {
+        for (auto &w : words) {
+            w = byteLoop(w);
+        }
+        vbench::clobber();
+    }
+    vbench::doNotOptimize(words);
+}
+VBENCH(endian, byteswap_x1024) {
+    std::array<uint32_t, 1024> words{};
+    for (size_t n = 0; n < iterations; n++) {
+        for (auto &w : words) {
+            w = vregex::byteswap(w);
+        }
+        vbench::clobber();
+    }
+    vbench::doNotOptimize(words);
+}
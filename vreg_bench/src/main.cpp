@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vbench.hpp>
+
+// usage: vreg_bench [filter] [--json=path] [--csv=path] [--min-time=ms]
+int main(int argc, char **argv) {
+    std::string_view filter;
+    const char *json = nullptr, *csv = nullptr;
+    std::chrono::milliseconds min_time(50);
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg.starts_with("--json=")) {
+            json = argv[i] + strlen("--json=");
+        } else if (arg.starts_with("--csv=")) {
+            csv = argv[i] + strlen("--csv=");
+        } else if (arg.starts_with("--min-time=")) {
+            min_time = std::chrono::milliseconds(atoi(argv[i] + strlen("--min-time=")));
+        } else if (arg.starts_with("--")) {
+            fprintf(stderr, "usage: %s [filter] [--json=path] [--csv=path] [--min-time=ms]\n", argv[0]);
+            return 1;
+        } else {
+            filter = arg;
+        }
+    }
+
+    std::vector<vbench::Result> results;
+    printf("%-40s %14s %12s %12s\n", "name", "iterations", "ns/op", "Mop/s");
+    for (const auto &c : vbench::registry()) {
+        if (c.name.find(filter) == std::string::npos)
+            continue;
+        const auto result = vbench::measure(c, min_time);
+        printf("%-40s %14zu %12.2f %12.2f\n", result.name.c_str(), result.iterations, result.ns_per_op,
+               1e3 / result.ns_per_op);
+        for (const auto &counter : result.counters) {
+            printf("  %-38s %14.3f\n", counter.name.c_str(), counter.value);
+        }
+        fflush(stdout);
+        results.push_back(result);
+    }
+
+    if (json && !vbench::writeJson(json, results)) {
+        fprintf(stderr, "cannot write %s\n", json);
+        return 1;
+    }
+    if (csv && !vbench::writeCsv(csv, results)) {
+        fprintf(stderr, "cannot write %s\n", csv);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// monitor requests/s on the CPU, against what a UART can carry
+namespace {
+using P = VMonitorProtocol;
+constexpr size_t count = 64;
+std::array<uint32_t, count> values{};
+
+std::shared_ptr<VMap> makeMap() {
+    VRangeBuilder rb("node");
+    for (auto &value : values) {
+        rb.add(VRegBuilder("v" + std::to_string(&value - values.data())).buildBinder(value));
+    }
+    return std::make_shared<VMap>(std::vector<VMap::pair>{{0x100, std::make_shared<VRange>(rb.build())}}, "map");
+}
+const std::shared_ptr<VMap> map = makeMap();
+const VNameIndex names(*map);
+
+// one batch of 64 requests, as one read() from the line would deliver
+template <class Make> std::vector<std::byte> batch(Make make) {
+    std::vector<std::byte> stream(64 * 300);
+    size_t used = 0;
+    for (size_t i = 0; i < 64; i++) {
+        used += make(i, std::span(stream).subspan(used));
+    }
+    stream.resize(used);
+    return stream;
+}
+
+// NOTE: reports how many of these requests a full duplex line carries per second at common baud rates
+// (10 bits per byte) and the share of one core serving them takes.
+void serve(bool text, const std::vector<std::byte> &stream, size_t iterations) {
+    using clock = std::chrono::steady_clock;
+    VMonitor monitor(*map, &names, std::endian::little, text, 64 * 1024);
+    size_t request_bytes = 0, response_bytes = 0;
+    const clock::time_point begin = clock::now();
+    for (size_t n = 0; n < iterations; n += 64) {
+        monitor.feed(stream);
+        vbench::doNotOptimize(monitor.output().data());
+        response_bytes = monitor.output().size();
+        monitor.consume(response_bytes);
+    }
+    const double elapsed = std::chrono::duration<double>(clock::now() - begin).count();
+    request_bytes = stream.size();
+    const double ns_per_request = elapsed * 1e9 / double((iterations + 63) / 64 * 64);
+    const double bytes_per_request = double(std::max(request_bytes, response_bytes)) / 64;
+    for (const auto &[baud, label] : {std::pair(115200.0, "115200"), std::pair(1e6, "1M")}) {
+        const double rate = baud / 10 / bytes_per_request;
+        vbench::report(std::string("req_per_s_") + label, rate);
+        vbench::report(std::string("core_percent_") + label, rate * ns_per_request / 1e7);
+    }
+}
+} // namespace
+
+VBENCH(monitor, read_binary) {
+    static const auto stream = batch([](size_t i, std::span<std::byte> out) {
+        return P::readRequest(addr_t(0x100 + i % count), out);
+    });
+    serve(false, stream, iterations);
+}
+VBENCH(monitor, write_binary) {
+    static const auto stream = batch([](size_t i, std::span<std::byte> out) {
+        const uint32_t value = uint32_t(i);
+        return P::writeRequest(addr_t(0x100 + i % count), std::as_bytes(std::span(&value, 1)), out);
+    });
+    serve(false, stream, iterations);
+}
+VBENCH(monitor, dump16_binary) {
+    static const auto stream = batch([](size_t i, std::span<std::byte> out) {
+        return P::dumpRequest(addr_t(0x100 + i % 48), 16, out);
+    });
+    serve(false, stream, iterations);
+}
+VBENCH(monitor, read_name_binary) {
+    static const auto stream = batch([](size_t i, std::span<std::byte> out) {
+        return P::findRequest("v" + std::to_string(i % count), out, P::read_name);
+    });
+    serve(false, stream, iterations);
+}
+VBENCH(monitor, read_text) {
+    static const auto stream = batch([](size_t i, std::span<std::byte> out) {
+        std::array<char, 16> line;
+        const int n = snprintf(line.data(), line.size(), "r %zx\n", 0x100 + i % count);
+        std::ranges::copy(std::as_bytes(std::span(line).first(size_t(n))), out.begin());
+        return size_t(n);
+    });
+    serve(true, stream, iterations);
+}
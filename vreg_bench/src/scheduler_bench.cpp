@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// cost of a tick with many subscriptions, and how late frames arrive on the wall clock
+namespace {
+using namespace std::chrono_literals;
+constexpr size_t count = 256;
+std::array<uint32_t, count> values{};
+
+std::shared_ptr<VRange> makeRange() {
+    VRangeBuilder rb("range");
+    for (auto &value : values) {
+        rb.add(VRegBuilder("v").buildBinder(value));
+    }
+    return std::make_shared<VRange>(rb.build());
+}
+const std::shared_ptr<VRange> range = makeRange();
+
+// groups of 8 registers, a third each every 1, 10 and 100 ticks
+template <class Sink> void subscribeAll(VScheduler<Sink> &scheduler, size_t groups) {
+    constexpr uint64_t periods[] = {1, 10, 100};
+    std::array<addr_t, 8> addrs;
+    for (size_t g = 0; g < groups; g++) {
+        for (size_t i = 0; i < addrs.size(); i++) {
+            addrs[i] = addr_t((g * addrs.size() + i) % count);
+        }
+        scheduler.subscribe(addrs, periods[g % 3], g);
+    }
+}
+
+void ticks(size_t groups, size_t iterations) {
+    VScheduler scheduler(*range, [](std::span<const VFrame> frames) { vbench::doNotOptimize(frames.data()); });
+    subscribeAll(scheduler, groups);
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(scheduler.tick());
+    }
+}
+const bool registered = [] {
+    for (const size_t groups : {24, 96, 384}) {
+        vbench::Register("scheduler/tick_" + std::to_string(groups), [=](size_t it) { ticks(groups, it); });
+    }
+    return true;
+}();
+} // namespace
+
+// NOTE: ns/op is the tick period. lateness of each batch behind its deadline is reported as counters
+// of the calibrated run (at least 50ms, 256 ticks).
+VBENCH(scheduler, jitter_250us) {
+    using clock = std::chrono::steady_clock;
+    constexpr auto period = 250us;
+    std::vector<int64_t> lateness;
+    lateness.reserve(iterations);
+    std::atomic<bool> stop{false};
+    clock::time_point start;
+    VScheduler scheduler(*range, [&](std::span<const VFrame> frames) {
+        const clock::time_point deadline = start + period * frames.front().tick;
+        lateness.push_back((clock::now() - deadline).count());
+        if (lateness.size() == iterations) {
+            stop = true;
+        }
+    });
+    subscribeAll(scheduler, 96);
+    start = clock::now();
+    scheduler.run(period, stop);
+    std::ranges::sort(lateness);
+    vbench::report("lateness_p50_us", lateness[lateness.size() / 2] / 1e3);
+    vbench::report("lateness_p99_us", lateness[lateness.size() * 99 / 100] / 1e3);
+    vbench::report("lateness_max_us", lateness.back() / 1e3);
+}
@@ -0,0 +1,75 @@
+#include <ctime>
+#include <thread>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// request throughput of a sharded server over 16 ranges, one producer and one polling thread
+namespace {
+constexpr size_t ranges = 16, regs = 16;
+std::array<std::array<uint32_t, regs>, ranges> values{};
+
+std::shared_ptr<VMap> makeMap() {
+    std::vector<VMap::pair> entries;
+    for (size_t r = 0; r < ranges; r++) {
+        VRangeBuilder rb("range");
+        for (auto &value : values[r]) {
+            rb.add(VRegBuilder("value").buildBinder(value));
+        }
+        entries.push_back({r * 0x100, std::make_shared<VRange>(rb.build())});
+    }
+    return std::make_shared<VMap>(std::move(entries), "map");
+}
+const std::shared_ptr<VMap> map = makeMap();
+
+void serve(size_t shards, size_t iterations) {
+    VShardServer server(*map, shards);
+    server.start();
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < iterations; i++) {
+            while (!server.postRead(i, addr_t(i % ranges * 0x100 + i / ranges % regs), 4)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::array<VCompletion, 64> completions;
+    for (size_t received = 0; received < iterations;) {
+        const size_t n = server.poll(completions);
+        vbench::clobber();
+        received += n;
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
+
+// sparse traffic: one request every 100us, reports the CPU the whole process burns meanwhile.
+// idle workers park after spinning, so it stays near the polling thread's share whatever the shard count.
+void trickle(size_t shards, size_t iterations) {
+    VShardServer server(*map, shards);
+    server.start();
+    std::array<VCompletion, 1> completions;
+    const std::clock_t cpu = std::clock();
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        server.postRead(i, addr_t(i % ranges * 0x100), 4);
+        while (server.poll(completions) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    const double cpu_s = double(std::clock() - cpu) / CLOCKS_PER_SEC;
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    vbench::report("cpu_percent", 100 * cpu_s / wall_s);
+}
+
+const bool registered = [] {
+    const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t shards = 1; shards <= std::max<size_t>(cores, 4); shards *= 2) {
+        vbench::Register("shard/reads_" + std::to_string(shards), [=](size_t it) { serve(shards, it); });
+        vbench::Register("shard/idle_" + std::to_string(shards), [=](size_t it) { trickle(shards, it); });
+    }
+    return true;
+}();
+} // namespace
@@ -0,0 +1,109 @@
+#include <array>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// StaticVMap/StaticVRange and VFlatMap against the dynamic VMap/VRange with the same registers
+namespace {
+std::array<uint32_t, 8> values{};
+uint32_t counter = 0;
+
+auto makeStaticRange() {
+    auto &v = values;
+    return StaticVRange("range", "", VRegBinder(v[0], "v0"), VRegBinder(v[1], "v1"), VRegBinder(v[2], "v2"),
+                        VRegBinder(v[3], "v3"), VRegBinder(v[4], "v4"), VRegBinder(v[5], "v5"), VRegConst(6u, "c6"),
+                        VRegRO(
+                            [](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+                                (void)endian;
+                                if (bytes.size() < sizeof(counter))
+                                    return std::nullopt;
+                                memcpy(bytes.data(), &counter, sizeof(counter));
+                                return sizeof(counter);
+                            },
+                            "counter"));
+}
+
+VRange makeRange() {
+    auto &v = values;
+    VRangeBuilder rb("range");
+    for (size_t i = 0; i < 6; i++) {
+        rb.add(VRegBuilder("v").buildBinder(v[i]));
+    }
+    rb.add(VRegBuilder("c6").buildConst(6u));
+    rb.add(VRegBuilder("counter").buildRO([](std::span<std::byte> bytes, std::endian endian) -> size_opt {
+        (void)endian;
+        if (bytes.size() < sizeof(counter))
+            return std::nullopt;
+        memcpy(bytes.data(), &counter, sizeof(counter));
+        return sizeof(counter);
+    }));
+    return rb.build();
+}
+
+auto static_range = makeStaticRange();
+auto static_map = StaticVMap("map", "", mountAt<0x000>(makeStaticRange()), mountAt<0x100>(makeStaticRange()),
+                             mountAt<0x200>(makeStaticRange()), mountAt<0x300>(makeStaticRange()));
+
+auto range = makeRange();
+VMap map(
+    {
+        {0x000, std::make_shared<VRange>(makeRange())},
+        {0x100, std::make_shared<VRange>(makeRange())},
+        {0x200, std::make_shared<VRange>(makeRange())},
+        {0x300, std::make_shared<VRange>(makeRange())},
+    },
+    "map", "");
+VFlatMap flat_map(map);
+
+constexpr addr_t mapAddr(size_t i) { return addr_t((i & 0x3) << 8 | (i >> 2 & 0x7)); }
+} // namespace
+
+VBENCH(static_range, readAt) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(static_range.readAt(i & 0x7, buf));
+    }
+}
+VBENCH(static_range, readAt_const) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(static_range.readAt<3>(buf));
+        vbench::clobber();
+    }
+}
+VBENCH(dynamic_range, readAt) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(range.readAt(i & 0x7, buf));
+    }
+}
+VBENCH(static_range, writeAt) {
+    std::byte buf[4]{};
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(static_range.writeAt(i % 6, buf));
+    }
+}
+VBENCH(dynamic_range, writeAt) {
+    std::byte buf[4]{};
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(range.writeAt(i % 6, buf));
+    }
+}
+VBENCH(static_map, readAt) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(static_map.readAt(mapAddr(i), buf));
+    }
+}
+VBENCH(dynamic_map, readAt) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(map.readAt(mapAddr(i), buf));
+    }
+}
+VBENCH(flat_map, readAt) {
+    std::byte buf[4];
+    for (size_t i = 0; i < iterations; i++) {
+        vbench::doNotOptimize(flat_map.readAt(mapAddr(i), buf));
+    }
+}
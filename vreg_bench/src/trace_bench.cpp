@@ -0,0 +1,74 @@
+#include <filesystem>
+#include <vbench.hpp>
+#include <vreg.hpp>
+using namespace vreg;
+
+// recording overhead, and one recorded trace replayed against different lookup structures
+namespace {
+constexpr size_t count = 256;
+std::array<uint32_t, count> values{};
+
+std::shared_ptr<VMap> makeMap() {
+    std::vector<VMap::pair> pairs;
+    for (size_t block = 0; block < 16; block++) {
+        VRangeBuilder rb("block");
+        for (size_t i = 0; i < count / 16; i++) {
+            rb.add(VRegBuilder("v").buildBinder(values[block * count / 16 + i]));
+        }
+        pairs.emplace_back(block * 0x100, std::make_shared<VRange>(rb.build()));
+    }
+    return std::make_shared<VMap>(std::move(pairs), "map");
+}
+const std::shared_ptr<VMap> map = makeMap();
+const std::string path = (std::filesystem::temp_directory_path() / "vreg_bench_trace.bin").string();
+
+addr_t addrOf(size_t i) { return addr_t((i * 7 % 16) * 0x100 + i * 13 % (count / 16)); }
+
+// a read-mostly pattern over the whole map
+std::vector<VTraceRecord> recordTrace() {
+    {
+        VTraceMount<8192> trace(map, path.c_str());
+        std::array<std::byte, 4> buf{};
+        for (size_t i = 0; i < 4096; i++) {
+            if (i % 8 == 0) {
+                trace.writeAt(addrOf(i), buf);
+            } else {
+                trace.readAt(addrOf(i), buf);
+            }
+        }
+    }
+    auto records = VTraceFile::load(path.c_str());
+    std::filesystem::remove(path);
+    return records;
+}
+} // namespace
+
+VBENCH(trace, readAt_plain) {
+    std::array<std::byte, 4> buf;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(map->readAt(addrOf(n), buf));
+    }
+}
+VBENCH(trace, readAt_recorded) {
+    VTraceMount<65536> trace(map, path.c_str(), std::chrono::milliseconds(1));
+    std::array<std::byte, 4> buf;
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(trace.readAt(addrOf(n), buf));
+    }
+    trace.stop();
+    std::filesystem::remove(path);
+}
+
+VBENCH(trace, replay_vmap_x4096) {
+    static const auto records = recordTrace();
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(VTraceReplay::run(*map, records));
+    }
+}
+VBENCH(trace, replay_vflatmap_x4096) {
+    static const auto records = recordTrace();
+    static VFlatMap flat(map);
+    for (size_t n = 0; n < iterations; n++) {
+        vbench::doNotOptimize(VTraceReplay::run(flat, records));
+    }
+}
@@ -1,9 +1,76 @@
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
 #include <stdio.h>
 #include <vreg.hpp>
+
+// heap usage of this process
+static size_t heap_count = 0, heap_bytes = 0;
+void *operator new(size_t size) {
+    heap_count++, heap_bytes += size;
+    if (void *ptr = malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+// arena usage
+class CountingResource : public std::pmr::memory_resource {
+    std::pmr::memory_resource *upstream_;
+
+public:
+    size_t bytes = 0;
+    CountingResource(std::pmr::memory_resource *upstream) : upstream_(upstream) {}
+    void *do_allocate(size_t size, size_t align) override { return bytes += size, upstream_->allocate(size, align); }
+    void do_deallocate(void *ptr, size_t size, size_t align) override { upstream_->deallocate(ptr, size, align); }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+constexpr size_t count = 64;
+static int values[count];
+static const char *const names[] = {"motor_velocity_target", "motor_current_limit", "id", "status"};
+
+static void report(const char *title, size_t heap, size_t heap_n, size_t arena) {
+    printf("%-28s heap %6.1f bytes/reg (%4.2f allocs/reg), arena %6.1f bytes/reg\n", title, double(heap) / count,
+           double(heap_n) / count, double(arena) / count);
+}
+
 int main(int argc, char **argv) {
     (void)argc, (void)argv;
-    
+
     printf("size=%ld\n", sizeof(vreg::VRegConst<int*[1]>));
     printf("size=%ld\n", sizeof(vreg::VRegConst<int*[2]>));
+
+    // memory report
+#ifdef VREG_STATIC_NAMES
+    printf("names: std::string_view (%zu bytes)\n", sizeof(vreg::base::name_t));
+#else
+    printf("names: std::string (%zu bytes)\n", sizeof(vreg::base::name_t));
+#endif
+    printf("sizeof(VRegBinder<int>)=%zu\n", sizeof(vreg::VRegBinder<int>));
+    {
+        const size_t n = heap_count, bytes = heap_bytes;
+        vreg::VRangeBuilder rb("range");
+        rb.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            rb.add(vreg::VRegBuilder(names[i % 4]).buildBinder(values[i]));
+        }
+        auto range = rb.build();
+        report("make_shared", heap_bytes - bytes, heap_count - n, 0);
+    }
+    {
+        alignas(std::max_align_t) static std::byte buffer[count * 256];
+        std::pmr::monotonic_buffer_resource monotonic(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        CountingResource arena(&monotonic);
+        const size_t n = heap_count, bytes = heap_bytes;
+        vreg::VRangeBuilder rb(&arena, "range");
+        rb.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            rb.add(vreg::VRegBuilder(names[i % 4]).setArena(&arena).buildBinder(values[i]));
+        }
+        auto range = rb.build();
+        report("arena", heap_bytes - bytes, heap_count - n, arena.bytes);
+    }
     return 0;
-}
\ No newline at end of file
+}